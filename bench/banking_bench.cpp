@@ -0,0 +1,57 @@
+#include "banked_memory.h"
+#include "bench.h"
+#include "bus.h"
+#include "cpu.h"
+#include "memory.h"
+#include "op_codes.h"
+
+namespace bench {
+
+static constexpr u64 BANKING_CYCLES = 50'000'000;
+
+// INX ; STX <target> ; LDA $8000 ; JMP loop, with 4 KiB banks at $8000.
+// With `target` = $DF00 every iteration switches banks, through the
+// registers' own page or through a Bus when `on_bus` is set.
+static BenchResult run_banking_bench(const std::string& name, word target, bool on_bus) {
+    Cpu cpu;
+    static Mem mem;
+    cpu.reset(mem);
+    BankedMemory banked(mem, 4 * 1024 * 1024, BankedMemory::WINDOW_4K);
+    banked.add_window(0x8000);
+    Bus bus(cpu, mem);
+    if (on_bus) {
+        bus.map(banked, 0xDF00, banked.register_count());
+    } else {
+        banked.map_registers(0xDF00);
+    }
+
+    const byte lo = static_cast<byte>(target);
+    const byte hi = static_cast<byte>(target >> 8);
+    const byte program[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), lo,   hi,    // STX target
+        op(Op::LDA_AB),  0x00, 0x80,  // LDA $8000
+        op(Op::JMP),     0x00, 0x20,  // JMP $2000
+    };
+    for (size_t i = 0; i < sizeof(program); ++i) {
+        mem[0x2000 + i] = program[i];
+    }
+    cpu.PC = 0x2000;
+
+    double seconds = time_it([&]() {
+        StopReason reason;
+        bus.run(BANKING_CYCLES, reason);
+    });
+
+    return BenchResult{name, cpu.cycle_count, seconds};
+}
+
+void banking_bench_suite() {
+    print_header("Bank Switching");
+
+    print_result(run_banking_bench("store loop, RAM", 0x0200, false));
+    print_result(run_banking_bench("store loop, bank select", 0xDF00, false));
+    print_result(run_banking_bench("store loop, bank select on a bus", 0xDF00, true));
+}
+
+}  // namespace bench
@@ -0,0 +1,254 @@
+#include "bench.h"
+#include "block_cache.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "dispatch.h"
+#include "instructions.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+
+namespace bench {
+
+// Emulated cycles per run
+static constexpr u64 BENCH_CYCLES = 200'000'000;
+
+// Loop of loads, stores and stack operations that never terminates on its own
+static void load_workload(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+
+    const byte program[] = {
+        op(Op::LDA_IM),  0x42,        // LDA #$42
+        op(Op::STA_ABS), 0x00, 0x02,  // STA $0200
+        op(Op::LDX_AB),  0x00, 0x02,  // LDX $0200
+        op(Op::STX_ZP),  0x10,        // STX $10
+        op(Op::LDY_ZP),  0x10,        // LDY $10
+        op(Op::STY_ABS), 0x01, 0x02,  // STY $0201
+        op(Op::LDA_ZPX), 0x0F,        // LDA $0F,X
+        op(Op::PHA),                  // PHA
+        op(Op::PLA),                  // PLA
+        op(Op::TSX),                  // TSX
+        op(Op::TXS),                  // TXS
+        op(Op::NOP),                  // NOP
+        op(Op::JMP),     0x00, 0x80,  // JMP $8000
+    };
+    for (size_t i = 0; i < sizeof(program); ++i) {
+        mem[0x8000 + i] = program[i];
+    }
+    cpu.PC = 0x8000;
+}
+
+// The original `switch` decoder from Cpu::execute, kept here as the reference point
+static void run_switch(Cpu& cpu, u64 deadline, Mem& mem) {
+    while (cpu.cycle_count < deadline) {
+        byte ins = cpu.fetch_byte(mem);
+        cpu.cycle_count += dispatch::table[ins].cycles;
+        switch (ins) {
+            case op(Op::LDA_IM):
+                instructions::LDA_IM(cpu, mem);
+                break;
+            case op(Op::LDA_ZP):
+                instructions::LDA_ZP(cpu, mem);
+                break;
+            case op(Op::LDA_ZPX):
+                instructions::LDA_ZPX(cpu, mem);
+                break;
+            case op(Op::LDA_AB):
+                instructions::LDA_AB(cpu, mem);
+                break;
+            case op(Op::LDA_ABSX):
+                instructions::LDA_ABSX(cpu, mem);
+                break;
+            case op(Op::LDA_ABSY):
+                instructions::LDA_ABSY(cpu, mem);
+                break;
+            case op(Op::LDA_INX):
+                instructions::LDA_INX(cpu, mem);
+                break;
+            case op(Op::LDA_INY):
+                instructions::LDA_INY(cpu, mem);
+                break;
+            case op(Op::LDX_IM):
+                instructions::LDX_IM(cpu, mem);
+                break;
+            case op(Op::LDX_ZP):
+                instructions::LDX_ZP(cpu, mem);
+                break;
+            case op(Op::LDX_ZPY):
+                instructions::LDX_ZPY(cpu, mem);
+                break;
+            case op(Op::LDX_AB):
+                instructions::LDX_AB(cpu, mem);
+                break;
+            case op(Op::LDX_ABSY):
+                instructions::LDX_ABSY(cpu, mem);
+                break;
+            case op(Op::LDY_IM):
+                instructions::LDY_IM(cpu, mem);
+                break;
+            case op(Op::LDY_ZP):
+                instructions::LDY_ZP(cpu, mem);
+                break;
+            case op(Op::LDY_ZPX):
+                instructions::LDY_ZPX(cpu, mem);
+                break;
+            case op(Op::LDY_AB):
+                instructions::LDY_AB(cpu, mem);
+                break;
+            case op(Op::LDY_ABSX):
+                instructions::LDY_ABSX(cpu, mem);
+                break;
+            case op(Op::STA_ZP):
+                instructions::STA_ZP(cpu, mem);
+                break;
+            case op(Op::STA_ZPX):
+                instructions::STA_ZPX(cpu, mem);
+                break;
+            case op(Op::STA_ABS):
+                instructions::STA_ABS(cpu, mem);
+                break;
+            case op(Op::STA_ABSX):
+                instructions::STA_ABSX(cpu, mem);
+                break;
+            case op(Op::STA_ABSY):
+                instructions::STA_ABSY(cpu, mem);
+                break;
+            case op(Op::STA_INX):
+                instructions::STA_INX(cpu, mem);
+                break;
+            case op(Op::STA_INY):
+                instructions::STA_INY(cpu, mem);
+                break;
+            case op(Op::STX_ZP):
+                instructions::STX_ZP(cpu, mem);
+                break;
+            case op(Op::STX_ZPY):
+                instructions::STX_ZPY(cpu, mem);
+                break;
+            case op(Op::STX_ABS):
+                instructions::STX_ABS(cpu, mem);
+                break;
+            case op(Op::STY_ZP):
+                instructions::STY_ZP(cpu, mem);
+                break;
+            case op(Op::STY_ZPX):
+                instructions::STY_ZPX(cpu, mem);
+                break;
+            case op(Op::STY_ABS):
+                instructions::STY_ABS(cpu, mem);
+                break;
+            case op(Op::JSR):
+                instructions::JSR(cpu, mem);
+                break;
+            case op(Op::JMP):
+                instructions::JMP(cpu, mem);
+                break;
+            case op(Op::JMPI):
+                instructions::JMPI(cpu, mem);
+                break;
+            case op(Op::RTS):
+                instructions::RTS(cpu, mem);
+                break;
+            case op(Op::NOP):
+                instructions::NOP(cpu, mem);
+                break;
+            case op(Op::PHA):
+                instructions::PHA(cpu, mem);
+                break;
+            case op(Op::PHP):
+                instructions::PHP(cpu, mem);
+                break;
+            case op(Op::PLA):
+                instructions::PLA(cpu, mem);
+                break;
+            case op(Op::PLP):
+                instructions::PLP(cpu, mem);
+                break;
+            case op(Op::TSX):
+                instructions::TSX(cpu, mem);
+                break;
+            case op(Op::TXS):
+                instructions::TXS(cpu, mem);
+                break;
+            default:
+                instructions::TRAP(cpu, mem);
+                break;
+        }
+    }
+}
+
+// The table-driven decoder used by Cpu::execute
+static void run_table(Cpu& cpu, u64 deadline, Mem& mem) {
+    while (cpu.cycle_count < deadline) {
+        byte ins = cpu.fetch_byte(mem);
+        const dispatch::OpEntry& entry = dispatch::table[ins];
+        cpu.cycle_count += entry.cycles;
+        entry.handler(cpu, mem);
+    }
+}
+
+// The computed-goto engine (same as the table loop when it is not compiled in)
+static void run_threaded(Cpu& cpu, u64 deadline, Mem& mem) {
+    cpu.run_threaded(deadline, mem);
+}
+
+static void run_blocks(Cpu& cpu, u64 deadline, Mem& mem) {
+    cpu.run_blocks(deadline, mem);
+}
+
+// Block cache plus native code for hot blocks (block cache only when the recompiler is not built)
+static void run_jit(Cpu& cpu, u64 deadline, Mem& mem) {
+    cpu.run_jit(deadline, mem);
+}
+
+// Cycle-stepped engine that drives the pins, for comparison with the fast engines
+static void run_pins(Cpu& cpu, u64 deadline, Mem& mem) {
+    cpu.run_pins(deadline, mem);
+}
+
+template <typename Loop>
+static BenchResult run_bench(const std::string& name, Loop loop) {
+    Cpu cpu;
+    static Mem mem;
+    load_workload(cpu, mem);
+
+    double seconds = time_it([&]() { loop(cpu, BENCH_CYCLES, mem); });
+
+    return BenchResult{name, cpu.cycle_count, seconds};
+}
+
+// The INX ; STX ; JMP loop of programs/counter.asm on the block or JIT engine
+static BenchResult run_counter_bench(const std::string& name, bool fusion, bool jit = false) {
+    Cpu cpu;
+    static Mem mem;
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+    mem.blocks().fusion = fusion;
+
+    double seconds = time_it([&]() {
+        if (jit) {
+            cpu.run_jit(BENCH_CYCLES, mem);
+        } else {
+            cpu.run_blocks(BENCH_CYCLES, mem);
+        }
+    });
+    mem.blocks().fusion = true;
+
+    return BenchResult{name, cpu.cycle_count, seconds};
+}
+
+void dispatch_bench_suite() {
+    print_header("Opcode Dispatch");
+
+    print_result(run_bench("switch dispatch", run_switch));
+    print_result(run_bench("table dispatch", run_table));
+    print_result(run_bench("threaded dispatch", run_threaded));
+    print_result(run_bench("block cache", run_blocks));
+    print_result(run_bench("jit", run_jit));
+    print_result(run_bench("pin-level bus", run_pins));
+    print_result(run_counter_bench("counter loop, plain blocks", false));
+    print_result(run_counter_bench("counter loop, superinstructions", true));
+    print_result(run_counter_bench("counter loop, jit", true, true));
+}
+
+}  // namespace bench
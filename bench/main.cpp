@@ -0,0 +1,9 @@
+#include "bench.h"
+
+int main() {
+    bench::dispatch_bench_suite();
+    bench::reset_bench_suite();
+    bench::banking_bench_suite();
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <vector>
+
+#include "bench.h"
+#include "bundle.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "reader.h"
+
+namespace bench {
+
+// Short batch jobs, each followed by a reset
+static constexpr u64 RESET_JOBS = 200'000;
+static constexpr u64 JOB_CYCLES = 5'000;
+
+// Loads and runs programs/counter.asm for JOB_CYCLES cycles, then resets.
+// Returns the time spent in the resets, or in whole jobs with `whole_job`.
+static LatencyResult run_reset_bench(const std::string& name, Mem::ResetMode mode, bool whole_job) {
+    Cpu cpu;
+    static Mem mem;
+    mem.set_reset_mode(mode);
+    cpu.reset(mem);
+    auto program = demo_programs::get_counter_program();
+
+    double seconds = 0.0;
+    double total = time_it([&]() {
+        for (u64 job = 0; job < RESET_JOBS; ++job) {
+            binary_reader::read_from_array(cpu, mem, program);
+            cpu.PC = 0x8000;
+            StopReason reason;
+            cpu.run(JOB_CYCLES, mem, reason);
+            if (!whole_job) {
+                seconds += time_it([&]() { cpu.reset(mem); });
+            } else {
+                cpu.reset(mem);
+            }
+        }
+    });
+    mem.set_reset_mode(Mem::ResetMode::Incremental);
+
+    return LatencyResult{name, RESET_JOBS, whole_job ? total : seconds};
+}
+
+// Fetches the combined instruction demo and loads it, as a test harness does
+// before every case
+static LatencyResult run_demo_reload_bench(const std::string& name) {
+    Cpu cpu;
+    static Mem mem;
+    cpu.reset(mem);
+
+    double seconds = time_it([&]() {
+        for (u64 job = 0; job < RESET_JOBS; ++job) {
+            binary_reader::read_from_array(cpu, mem, demo_programs::get_instruction_demo());
+        }
+    });
+    return LatencyResult{name, RESET_JOBS, seconds};
+}
+
+// Batch jobs also load a fresh program image each time
+static constexpr u64 LOAD_JOBS = 20'000;
+static constexpr u32 IMAGE_SIZE = 16 * 1024;
+
+// How run_load_bench gets the image into memory
+enum class LoadPath {
+    ByteByByte,  // stdio and operator[], one byte at a time
+    Binary,      // read_from_binary_file
+    IntelHex,    // read_from_intel_hex, 16 data bytes per record
+    Bundle,      // Bundle::load, one segment
+};
+
+// Writes the image in the format `path` needs and returns the file name
+static const char* write_image(LoadPath load, const std::vector<byte>& image) {
+    if (load == LoadPath::Bundle) {
+        const ProgramImage::Segment segments[] = {{0x4000, image}};
+        return bundle::write("reset_bench_image.bundle", segments, 0x4000, {}) ? "reset_bench_image.bundle" : nullptr;
+    }
+
+    const char* path = load == LoadPath::IntelHex ? "reset_bench_image.hex" : "reset_bench_image.bin";
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+    if (load != LoadPath::IntelHex) {
+        std::fwrite(image.data(), 1, image.size(), file);
+    } else {
+        for (u32 offset = 0; offset < image.size(); offset += 16) {
+            u32 addr = 0x4000 + offset;
+            byte checksum = static_cast<byte>(16 + (addr >> 8) + addr);
+            std::fprintf(file, ":10%04X00", addr);
+            for (u32 i = 0; i < 16; ++i) {
+                std::fprintf(file, "%02X", image[offset + i]);
+                checksum += image[offset + i];
+            }
+            std::fprintf(file, "%02X\n", static_cast<byte>(-checksum));
+        }
+        std::fprintf(file, ":00000001FF\n");
+    }
+    std::fclose(file);
+    return path;
+}
+
+// Loads a 16 KiB image at $4000 from a file
+static LatencyResult run_load_bench(const std::string& name, LoadPath load) {
+    std::vector<byte> image(IMAGE_SIZE);
+    for (u32 i = 0; i < IMAGE_SIZE; ++i) {
+        image[i] = static_cast<byte>(i * 7);
+    }
+    const char* path = write_image(load, image);
+    if (path == nullptr) {
+        return LatencyResult{name, 0, 0.0};
+    }
+
+    Cpu cpu;
+    static Mem mem;
+    cpu.reset(mem);
+    double seconds = time_it([&]() {
+        for (u64 job = 0; job < LOAD_JOBS; ++job) {
+            if (load == LoadPath::Binary) {
+                binary_reader::read_from_binary_file(cpu, mem, path, 0x4000);
+            } else if (load == LoadPath::IntelHex) {
+                binary_reader::read_from_intel_hex(cpu, mem, path);
+            } else if (load == LoadPath::Bundle) {
+                Bundle(path).load(cpu, mem);
+            } else {
+                std::FILE* in = std::fopen(path, "rb");
+                u32 addr = 0x4000;
+                for (int c = std::fgetc(in); c != EOF; c = std::fgetc(in)) {
+                    mem[addr++] = static_cast<byte>(c);
+                }
+                std::fclose(in);
+            }
+        }
+    });
+    std::remove(path);
+
+    return LatencyResult{name, LOAD_JOBS, seconds};
+}
+
+void reset_bench_suite() {
+    print_header("Reset Latency");
+
+    print_latency(run_reset_bench("reset, full memset", Mem::ResetMode::Full, false));
+    print_latency(run_reset_bench("reset, incremental", Mem::ResetMode::Incremental, false));
+    print_latency(run_reset_bench("5000-cycle job, full memset", Mem::ResetMode::Full, true));
+    print_latency(run_reset_bench("5000-cycle job, incremental", Mem::ResetMode::Incremental, true));
+    print_latency(run_demo_reload_bench("reload instruction demo"));
+    print_latency(run_load_bench("load 16 KiB file, byte by byte", LoadPath::ByteByByte));
+    print_latency(run_load_bench("load 16 KiB file, mmap + bulk", LoadPath::Binary));
+    print_latency(run_load_bench("load 16 KiB file, Intel HEX", LoadPath::IntelHex));
+    print_latency(run_load_bench("load 16 KiB file, bundle", LoadPath::Bundle));
+}
+
+}  // namespace bench
@@ -0,0 +1,84 @@
+#ifndef ACCESS_COUNTERS_H
+#define ACCESS_COUNTERS_H
+
+#include <algorithm>
+#include <vector>
+
+#include "types.h"
+
+// Memory access counting policies for Mem. The policy is picked at compile time
+// with the CMake option ACCESS_COUNTERS (none, page or address). Mem calls
+// read(), write() and fetch() on every access through its handler paths; with
+// NoCounters those calls are empty and the build pays nothing for them. The
+// block engine decodes code once but calls fetch() each time an instruction
+// runs, so the counts do not depend on the engine.
+namespace access_counters {
+
+enum class Kind : byte {
+    Read,   // Data loads, including stack pulls and pointer reads
+    Write,  // Stores, including stack pushes
+    Fetch,  // Opcode and operand bytes
+};
+
+inline constexpr u32 KINDS = 3;
+
+// The default policy: counts nothing
+struct NoCounters {
+    static constexpr bool enabled = false;
+    static constexpr u32 SLOTS = 0;
+
+    void read(u32) {}
+    void write(u32) {}
+    void fetch(u32) {}
+    void clear() {}
+
+    u64 at(Kind, u32) const { return 0; }
+    u64 page(Kind, byte) const { return 0; }
+};
+
+// One counter per kind for every `1 << Shift` bytes of the address space
+template <u32 Shift>
+class Counters {
+   public:
+    static constexpr bool enabled = true;
+    static constexpr u32 SLOTS = 0x10000 >> Shift;
+
+    Counters() : counts(KINDS * SLOTS, 0) {}
+
+    void read(u32 addr) { counts[index(Kind::Read, addr)]++; }
+    void write(u32 addr) { counts[index(Kind::Write, addr)]++; }
+    void fetch(u32 addr) { counts[index(Kind::Fetch, addr)]++; }
+    void clear() { std::fill(counts.begin(), counts.end(), 0); }
+
+    // Counter of the slot that holds `addr`
+    u64 at(Kind kind, u32 addr) const { return counts[index(kind, addr)]; }
+
+    // Sum over the slots of one page
+    u64 page(Kind kind, byte page) const {
+        u64 sum = 0;
+        for (u32 addr = page << 8; addr < (page + 1u) << 8; addr += 1u << Shift) {
+            sum += at(kind, addr);
+        }
+        return sum;
+    }
+
+   private:
+    static u32 index(Kind kind, u32 addr) { return static_cast<u32>(kind) * SLOTS + (addr >> Shift); }
+
+    std::vector<u64> counts;
+};
+
+using PageCounters = Counters<8>;
+using AddressCounters = Counters<0>;
+
+#if defined(EMULATOR_ACCESS_COUNTERS_ADDRESS)
+using Policy = AddressCounters;
+#elif defined(EMULATOR_ACCESS_COUNTERS_PAGE)
+using Policy = PageCounters;
+#else
+using Policy = NoCounters;
+#endif
+
+}  // namespace access_counters
+
+#endif  // ACCESS_COUNTERS_H
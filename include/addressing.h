@@ -0,0 +1,122 @@
+#ifndef ADDRESSING_H
+#define ADDRESSING_H
+
+#include "cpu.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "types.h"
+
+// Addressing-mode policies for the templated handlers in operations.h.
+//
+// Every policy fetches its operand bytes at PC (`fetch`) and turns an operand
+// into an effective address (`resolve`). The two steps are separate so that
+// the block cache, which fetches operands at decode time, shares `resolve`
+// with the interpreters.
+namespace addressing {
+
+// Effective address of an operand, and the address it was indexed from
+struct Target {
+    word base;  // Address before X or Y was added; equal to `addr` for unindexed modes
+    word addr;  // Address that is read or written
+};
+
+// Immediate (#$nn): the operand is the value itself, there is no address
+struct IMM {
+    static constexpr AddrMode mode = AddrMode::IMM;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+};
+
+// Zero Page ($nn)
+struct ZP {
+    static constexpr AddrMode mode = AddrMode::ZP;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+    static Target resolve(Cpu&, const Mem&, word operand) { return {operand, operand}; }
+};
+
+// Zero Page,X ($nn,X), wrapping within the zero page
+struct ZPX {
+    static constexpr AddrMode mode = AddrMode::ZPX;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+    static Target resolve(Cpu& cpu, const Mem&, word operand) {
+        word addr = static_cast<byte>(operand + cpu.X);
+        return {addr, addr};
+    }
+};
+
+// Zero Page,Y ($nn,Y), wrapping within the zero page
+struct ZPY {
+    static constexpr AddrMode mode = AddrMode::ZPY;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+    static Target resolve(Cpu& cpu, const Mem&, word operand) {
+        word addr = static_cast<byte>(operand + cpu.Y);
+        return {addr, addr};
+    }
+};
+
+// Absolute ($nnnn)
+struct ABS {
+    static constexpr AddrMode mode = AddrMode::ABS;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_word(mem); }
+    static Target resolve(Cpu&, const Mem&, word operand) { return {operand, operand}; }
+};
+
+// Absolute,X ($nnnn,X); reads take a cycle more when X carries into the next page
+struct ABSX {
+    static constexpr AddrMode mode = AddrMode::ABSX;
+    static constexpr bool page_cross = true;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_word(mem); }
+    static Target resolve(Cpu& cpu, const Mem&, word operand) {
+        return {operand, static_cast<word>(operand + cpu.X)};
+    }
+};
+
+// Absolute,Y ($nnnn,Y); reads take a cycle more when Y carries into the next page
+struct ABSY {
+    static constexpr AddrMode mode = AddrMode::ABSY;
+    static constexpr bool page_cross = true;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_word(mem); }
+    static Target resolve(Cpu& cpu, const Mem&, word operand) {
+        return {operand, static_cast<word>(operand + cpu.Y)};
+    }
+};
+
+// (Indirect,X) (($nn,X)): pointer at zero page $nn + X
+struct INDX {
+    static constexpr AddrMode mode = AddrMode::INDX;
+    static constexpr bool page_cross = false;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+    static Target resolve(Cpu& cpu, const Mem& mem, word operand) {
+        word addr = Cpu::zp16(mem, static_cast<byte>(operand + cpu.X));
+        return {addr, addr};
+    }
+};
+
+// (Indirect),Y (($nn),Y): pointer at zero page $nn, plus Y; reads take a cycle
+// more when Y carries into the next page
+struct INDY {
+    static constexpr AddrMode mode = AddrMode::INDY;
+    static constexpr bool page_cross = true;
+
+    static word fetch(Cpu& cpu, Mem& mem) { return cpu.fetch_byte(mem); }
+    static Target resolve(Cpu& cpu, const Mem& mem, word operand) {
+        word base = Cpu::zp16(mem, static_cast<byte>(operand));
+        return {base, static_cast<word>(base + cpu.Y)};
+    }
+};
+
+}  // namespace addressing
+
+#endif  // ADDRESSING_H
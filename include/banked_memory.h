@@ -0,0 +1,104 @@
+#ifndef BANKED_MEMORY_H
+#define BANKED_MEMORY_H
+
+#include <vector>
+
+#include "bus.h"
+#include "memory.h"
+#include "types.h"
+
+// Cartridge-style banking: windows of the 16-bit address space that each show
+// one bank of a backing store larger than 64 KiB. Selecting a bank only
+// repoints the window's entries in the page table (Mem::repoint); no data is
+// copied, and only code cached from the window is dropped.
+//
+// The bank-select registers come two per window: offset 2*w+1 latches the
+// high byte of the bank number and a write to offset 2*w selects bank
+// (high << 8) | value for window w. map_registers() puts them straight on an
+// I/O page, so a bank switch is one slow-path store; as a Device they can
+// also share a Bus with other peripherals, at the cost of a device sync per
+// switch.
+//
+// Native JIT code keeps running while windows are attached; it leaves for the
+// interpreter only on accesses to a window. Snapshots do not capture windows.
+class BankedMemory : public Device {
+   public:
+    static constexpr u32 WINDOW_4K = 4 * 1024;
+    static constexpr u32 WINDOW_8K = 8 * 1024;
+
+    // Returned by add_window() for a window that cannot be attached
+    static constexpr byte NO_WINDOW = 0xFF;
+
+    // `backing_size` is rounded up to whole banks of `window_size` bytes.
+    // `window_size` must be a non-zero multiple of Mem::PAGE_SIZE no larger
+    // than Mem::MAX_MEM; otherwise ok() is false and no window can be added.
+    BankedMemory(Mem& mem, u32 backing_size, u32 window_size);
+    ~BankedMemory() override;
+
+    BankedMemory(const BankedMemory&) = delete;
+    BankedMemory& operator=(const BankedMemory&) = delete;
+
+    bool ok() const { return banks != 0; }
+
+    // Attaches a window at `base` showing bank 0. Writes to read-only windows
+    // are dropped. Returns the window's index, or NO_WINDOW when `base` is not
+    // a multiple of the window size, the window would run past the end of
+    // memory or it overlaps a window already attached.
+    byte add_window(word base, bool read_only = false);
+
+    // Shows `bank` in window `window`; out-of-range banks wrap around
+    void select(byte window, u32 bank);
+    u32 selected(byte window) const { return windows[window].bank; }
+
+    u32 window_size() const { return window_bytes; }
+    u32 bank_count() const { return banks; }
+
+    // Host view of a bank; only when ok(). Stores through it are not seen by
+    // windows showing the bank, so use load() to change a selected bank.
+    byte* bank(u32 index) { return backing.data() + static_cast<size_t>(index % banks) * window_bytes; }
+
+    // Copies `size` bytes, at most one bank, to the start of bank `index`.
+    // Windows showing the bank drop the code cached from it and record the
+    // store like Mem::load.
+    void load(u32 index, const byte* bytes, u32 size);
+
+    // Bank-select registers; map `register_count()` bytes of them on a Bus
+    u32 register_count() const { return static_cast<u32>(2 * windows.size()); }
+    byte read(word offset) override;
+    void write(word offset, byte value) override;
+
+    // Maps the registers at `base` without a Bus, taking over the whole I/O
+    // page; other addresses on it read and write the RAM underneath. The
+    // page is mapped back to RAM when the BankedMemory is destroyed.
+    void map_registers(word base);
+
+   private:
+    // The registers as the handler of their own I/O page
+    class Registers : public IoHandler {
+       public:
+        explicit Registers(BankedMemory& owner) : owner(owner) {}
+        byte read(word addr) override;
+        void write(word addr, byte value) override;
+        word base = 0;
+        bool mapped = false;
+
+       private:
+        BankedMemory& owner;
+    };
+
+    struct Window {
+        byte first_page;
+        bool read_only;
+        u32 bank;
+        byte high_latch;
+    };
+
+    Mem& mem;
+    u32 window_bytes;
+    u32 banks;
+    std::vector<byte> backing;
+    std::vector<Window> windows;
+    Registers registers{*this};
+};
+
+#endif  // BANKED_MEMORY_H
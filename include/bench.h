@@ -0,0 +1,65 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "colors.h"
+#include "types.h"
+
+namespace bench {
+
+// Result of a single benchmark run
+struct BenchResult {
+    std::string name;
+    u64 cycles;      // Emulated cycles executed
+    double seconds;  // Host wall time
+
+    // Emulated clock rate in MHz
+    double mhz() const { return seconds > 0.0 ? static_cast<double>(cycles) / seconds / 1e6 : 0.0; }
+};
+
+// Result of a benchmark that measures the latency of an operation
+struct LatencyResult {
+    std::string name;
+    u64 operations;  // Operations timed
+    double seconds;  // Host wall time spent in them
+
+    double nanoseconds() const {
+        return operations > 0 ? seconds * 1e9 / static_cast<double>(operations) : 0.0;
+    }
+};
+
+// Times `body` and returns the elapsed wall time in seconds
+template <typename Func>
+double time_it(Func body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+inline void print_header(const std::string& suite_name) {
+    std::printf("\n%s%s===== %s Benchmarks =====%s\n\n", colors::YELLOW, colors::BOLD, suite_name.c_str(),
+                colors::RESET);
+}
+
+inline void print_result(const BenchResult& r) {
+    std::printf("%s%-32s%s %12llu cycles  %8.3f s  %s%8.2f MHz%s\n", colors::CYAN, r.name.c_str(), colors::RESET,
+                static_cast<unsigned long long>(r.cycles), r.seconds, colors::GREEN, r.mhz(), colors::RESET);
+}
+
+inline void print_latency(const LatencyResult& r) {
+    std::printf("%s%-32s%s %12llu ops     %8.3f s  %s%8.1f ns/op%s\n", colors::CYAN, r.name.c_str(), colors::RESET,
+                static_cast<unsigned long long>(r.operations), r.seconds, colors::GREEN, r.nanoseconds(), colors::RESET);
+}
+
+// Benchmark suites
+void dispatch_bench_suite();
+void reset_bench_suite();
+void banking_bench_suite();
+
+}  // namespace bench
+
+#endif  // BENCH_H
@@ -0,0 +1,155 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <bitset>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "cpu.h"
+#include "jit.h"
+#include "memory.h"
+#include "program_image.h"
+#include "types.h"
+
+struct MicroOp;
+
+// Executes one predecoded instruction. The run loop has already charged the
+// base cycles and moved PC past the instruction when this is called.
+using MicroHandler = void (*)(Cpu& cpu, Mem& mem, const MicroOp& op);
+
+// One predecoded instruction, or a superinstruction covering several
+struct MicroOp {
+    MicroHandler handler;            // Operation with the operand already resolved
+    const MicroOp* parts = nullptr;  // Constituent instructions of a superinstruction
+    word operand;                    // Immediate value, zero-page/absolute address or pointer
+    word next_pc;                    // Address of the following instruction
+    byte opcode;                     // Original opcode byte (first one for a superinstruction)
+    byte cycles;                     // Base cycles, same as the opcode table (summed when fused)
+    byte length = 1;                 // Number of instructions covered
+};
+
+// A straight-line run of instructions ending at the first control transfer
+struct Block {
+    word start;                // Address of the first instruction
+    u32 cycles = 0;            // Sum of the base cycles of all ops
+    u32 penalties = 0;         // Most cycles the ops can add on top, from page crossings
+    bool valid = true;         // Cleared when a store hits the block's code
+    bool returns = false;      // Block ends with RTS
+    std::vector<MicroOp> ops;  // Predecoded instructions, one per opcode
+
+    // The same code with superinstructions, empty when nothing was fused.
+    // Only run when `fused_cycles` fit into the budget, so a budget that ends
+    // in the middle of a superinstruction still stops on the exact instruction.
+    std::vector<MicroOp> fused;
+    u32 fused_cycles = 0;
+    u32 fused_penalties = 0;     // Includes the body of an inlined leaf subroutine
+    bool fused_returns = false;  // The fused code executes an RTS, which ends the run
+
+    // JSR plus the body of a short leaf subroutine, inlined by a superinstruction
+    std::vector<MicroOp> leaf;
+
+    // Native code from the recompiler, and how often the block ran before it
+    NativeCode native = nullptr;
+    u32 executions = 0;
+
+    // Cached successor, only trusted while `next_epoch` matches the cache epoch
+    Block* next = nullptr;
+    u32 next_epoch = 0;
+};
+
+// Translation cache of predecoded basic blocks for one `Mem`.
+// Pages holding cached code are flagged in `Mem::code_pages`, so stores
+// through `Mem::write` or `Mem::operator[]` drop the affected blocks and
+// self-modifying code keeps working.
+class BlockCache {
+   public:
+    // Longest block that is decoded in one go
+    static constexpr u32 MAX_BLOCK_OPS = 32;
+
+    // Longest subroutine, including its RTS, that a JSR superinstruction inlines
+    static constexpr u32 MAX_LEAF_OPS = 8;
+
+    // True when the opcode pair starts a superinstruction.
+    // The set was picked from the output of tools/opcode_pairs.cpp.
+    static bool fuses(byte first, byte second);
+
+    explicit BlockCache(Mem& mem);
+
+    // Returns the block starting at `pc`, decoding it on a miss
+    Block* lookup(word pc);
+
+    // Adds the block at `start` from predecoded instructions, e.g. the records
+    // of a Bundle, without reading memory. Only opcode, operand, next_pc and
+    // cycles of `ops` and `leaf` (the JSR and the leaf subroutine it inlines,
+    // see Block::leaf) are used; handlers come from the opcodes and the
+    // superinstructions are built as on a decode. Nothing happens when the
+    // block is cached already.
+    void restore(word start, Span<const MicroOp> ops, Span<const MicroOp> leaf);
+
+    // Calls `visit(const Block&)` for every cached block, in no particular order
+    template <typename Visit>
+    void for_each(Visit visit) const {
+        for (const auto& entry : blocks) {
+            visit(*entry.second);
+        }
+    }
+
+    // Drops every block with code on `page`
+    void invalidate_page(byte page);
+
+    // Drops all blocks
+    void clear();
+
+    // Translates `block` with the recompiler. When the arena is full, all
+    // native code is dropped and `block` is translated into the empty arena;
+    // the other blocks go back to counting executions and are translated
+    // again once they are hot, so code patched over and over cannot use the
+    // arena up for good. Returns false if `block` stays interpreted.
+    bool translate(Block& block);
+
+    // Bumped on every invalidation; used to validate cached successor links
+    u32 epoch() const { return current_epoch; }
+
+    size_t size() const { return blocks.size(); }
+
+    // Builds superinstructions for newly decoded blocks; off only for comparisons
+    bool fusion = true;
+
+    // Recompiler for hot blocks, used by Engine::Jit
+    Jit& jit() { return native_code; }
+
+   private:
+    using PageSet = std::bitset<Mem::NUM_PAGES>;
+
+    Block* decode(word pc);
+
+    // Decodes the subroutine at `target` into `block.leaf` if it is a short leaf
+    bool decode_leaf(Block& block, const MicroOp& call, PageSet& pages);
+
+    // Flags the code of `block.leaf` as code of `block`
+    void mark_leaf(Block& block, PageSet& pages);
+
+    // Builds the superinstructions of a new block and caches it
+    Block* insert(std::unique_ptr<Block> block, const PageSet& pages);
+
+    // Builds `block.fused` from `block.ops`
+    void fuse(Block& block, const PageSet& pages);
+
+    // Flags the bytes of one instruction as code of the block starting at `pc`
+    void mark_code(word pc, word addr, byte length, PageSet& pages);
+
+    Mem& mem;
+    Jit native_code;
+    u32 current_epoch = 1;
+    std::unordered_map<word, std::unique_ptr<Block>> blocks;
+
+    // Start addresses of the blocks that have code on each page
+    std::vector<word> page_blocks[Mem::NUM_PAGES];
+
+    // Invalidated blocks are kept alive until the next lookup,
+    // because a store may invalidate the block that is currently running
+    std::vector<std::unique_ptr<Block>> retired;
+};
+
+#endif  // BLOCK_CACHE_H
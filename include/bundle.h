@@ -0,0 +1,160 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cpu.h"
+#include "memory.h"
+#include "program_image.h"
+#include "reader.h"
+#include "rom_image.h"
+#include "types.h"
+
+class BlockCache;
+
+// Prebuilt program bundle for fast cold starts. One file holds a program's
+// memory segments, its entry point, its symbol table and, optionally, the
+// blocks that a training run decoded, as records of their instructions.
+// Warming a cache from the records neither decodes nor reads guest memory.
+//
+// The file is a fixed header followed by tables at 8-byte aligned offsets, in
+// the host's (little-endian) byte order. Opening one maps it with
+// RomImage::from_file and checks the header and the table bounds; the tables
+// are then read in place, with nothing parsed or copied. The header carries a
+// 64-bit FNV-1a hash of the whole file, header included, so a worker can tell
+// whether a cached bundle still matches the program it was built from.
+namespace bundle {
+
+inline constexpr char MAGIC[8] = {'6', '5', '0', '2', 'B', 'N', 'D', 'L'};
+inline constexpr u32 VERSION = 2;
+inline constexpr u32 BYTE_ORDER_MARK = 0x01020304;  // Reads differently on a host with the other byte order
+
+// Offsets are from the start of the file; 0 marks an absent table
+struct Header {
+    char magic[8];
+    u32 version;
+    u32 byte_order;
+    u64 hash;  // FNV-1a over the whole file, with this field read as zero
+    u64 file_size;
+    u32 entry;  // Initial PC
+    u32 segment_count;
+    u32 segments;  // Segment[segment_count]
+    u32 symbol_count;
+    u32 symbols;  // Symbol[symbol_count]
+    u32 strings;  // NUL-terminated symbol names
+    u32 strings_size;
+    u32 block_count;
+    u32 blocks;  // BlockRecord[block_count], ascending start addresses
+    u32 op_count;
+    u32 ops;  // OpRecord[op_count], the instructions of every block
+};
+
+struct Segment {
+    u32 address;
+    u32 size;
+    u32 offset;  // Of the bytes
+    u32 reserved;
+};
+
+struct Symbol {
+    u32 address;
+    u32 name;  // Offset into the string table
+};
+
+// A decoded block: `op_count` ops, then `leaf_count` ops of the JSR and the
+// leaf subroutine it inlines (Block::leaf), from op record `first_op` on
+struct BlockRecord {
+    u32 start;
+    u32 first_op;
+    word op_count;
+    word leaf_count;
+    u32 reserved;
+};
+
+// One decoded instruction (MicroOp without its handler)
+struct OpRecord {
+    word operand;
+    word next_pc;
+    byte opcode;
+    byte cycles;
+    word reserved;
+};
+
+static_assert(sizeof(Header) == 80 && sizeof(Segment) == 16 && sizeof(Symbol) == 8 && sizeof(BlockRecord) == 16 &&
+                  sizeof(OpRecord) == 8,
+              "Bundle layout is fixed");
+
+// 64-bit FNV-1a; pass the previous result as `h` to hash data in pieces
+inline constexpr u64 HASH_SEED = 0xCBF29CE484222325ull;
+u64 hash(const byte* bytes, size_t size, u64 h = HASH_SEED);
+
+// Serializes `image`, `entry` and `symbols`. With `cache`, every valid
+// cached block is recorded too, so run the program on Engine::Block first
+// to collect them. The records describe `image`, so the cache must have
+// been trained on it.
+std::vector<byte> build(const ProgramImage& image, word entry, const binary_reader::Symbols& symbols,
+                        const BlockCache* cache = nullptr);
+
+// build() straight to a file; false if it cannot be written
+bool write(const std::string& path, const ProgramImage& image, word entry, const binary_reader::Symbols& symbols,
+           const BlockCache* cache = nullptr);
+
+}  // namespace bundle
+
+// A mapped bundle, read in place
+class Bundle {
+   public:
+    // Maps the file at `path`; ok() is false if it is missing or malformed
+    explicit Bundle(const std::string& path);
+
+    // Reads a bundle already in memory, e.g. from RomImage::from_bytes
+    explicit Bundle(std::shared_ptr<const RomImage> file);
+
+    // False when the file could not be mapped or failed the header and bounds checks
+    bool ok() const { return header != nullptr; }
+
+    word entry() const { return static_cast<word>(header->entry); }
+    u64 hash() const { return header->hash; }
+
+    // Recomputes the hash over the whole file. Opening only checks the header
+    // and table bounds, so a damaged entry point or offset that still points
+    // inside the file is caught here. A full pass, so only worth it when the
+    // file may have been damaged rather than replaced.
+    bool verify() const;
+
+    // Views of the segments' bytes, valid while the bundle lives
+    const std::vector<ProgramImage::Segment>& segments() const { return views; }
+    ProgramImage image() const { return ProgramImage(Span<const ProgramImage::Segment>(views)); }
+
+    u32 symbol_count() const { return header->symbol_count; }
+    const char* symbol_name(u32 i) const;
+    u32 symbol_address(u32 i) const { return symbol_table[i].address; }
+
+    // Address of the symbol called `name`; false if there is none
+    bool find_symbol(const char* name, u32& address) const;
+
+    // Number of recorded blocks; 0 when the bundle has no predecode metadata
+    u32 block_count() const { return static_cast<u32>(blocks.size()); }
+
+    // Stores every segment with Mem::load and sets the PC to the entry point
+    void load(Cpu& cpu, Mem& mem) const;
+
+    // Rebuilds the recorded blocks in `mem.blocks()` from their records, so
+    // the block and JIT engines start with a warm cache. The records are only
+    // right while memory holds the segments, so call it right after load();
+    // hash() tells whether the bundle still belongs to the program.
+    void warm(Mem& mem) const;
+
+   private:
+    std::shared_ptr<const RomImage> file;
+    const bundle::Header* header = nullptr;
+    const bundle::Symbol* symbol_table = nullptr;
+    const char* strings = nullptr;
+    Span<const bundle::BlockRecord> blocks;
+    Span<const bundle::OpRecord> ops;
+    std::vector<ProgramImage::Segment> views;
+};
+
+#endif  // BUNDLE_H
@@ -0,0 +1,107 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <vector>
+
+#include "cpu.h"
+#include "memory.h"
+#include "types.h"
+
+// One cycle of bus activity as the NMOS 6502 performs it
+struct BusCycle {
+    word addr;   // Address on A0..A15
+    byte data;   // Byte read or written on D0..D7
+    bool write;  // RWB low
+    bool sync;   // Opcode fetch
+};
+
+// The cycle-stepped engine (src/bus.cpp, Cpu::run_pins) expands each
+// instruction's addressing mode and `dispatch::Access` into the bus cycles the
+// real chip performs, including dummy reads, and runs them one at a time. Every
+// access goes through Mem (fetch, read or write) on its own cycle, with
+// `cycle_count` counting that cycle, so I/O handlers and devices on a Bus see
+// each access when it happens. Dummy reads only sample memory with Mem::peek; like
+// the other engines, they reach no I/O handler. The fast engines never touch
+// the pins.
+
+// Receives the pins of Engine::Pins after every half-cycle, e.g. to co-simulate
+// a peripheral. During phase 1 (PHI2O low) the address, RWB and SYNC are valid;
+// during phase 2 (PHI2O high) the data bus is valid too. The registers are those
+// of the moment: an instruction's results appear as its cycles produce them.
+//
+// On a read cycle the CPU latches data_bus.DATA at the end of phase 2, so an
+// observer may replace the byte that memory put there.
+class BusObserver {
+   public:
+    virtual ~BusObserver() = default;
+    virtual void half_cycle(Cpu& cpu) = 0;
+};
+
+// A memory-mapped peripheral. Registers are addressed by their offset from the
+// base the device was mapped at.
+class Device {
+   public:
+    virtual ~Device() = default;
+    virtual byte read(word offset) = 0;
+    virtual void write(word offset, byte value) = 0;
+
+    // Advances the device by `cycles` CPU cycles. Called in batches: before each
+    // access to any device on the bus and at the end of every Bus::run slice,
+    // never once per instruction.
+    virtual void tick(u64 cycles) { (void)cycles; }
+};
+
+// Connects devices to a CPU and its memory. Pages with a device on them are
+// mapped as I/O pages, so the rest of memory keeps the fast path; addresses on
+// those pages that no device claims still read and write the RAM under them.
+//
+// Device accesses happen inside an instruction handler, after the engine has
+// charged the instruction's base cycles; Engine::Pins makes them on their own
+// cycle instead.
+class Bus : private IoHandler {
+   public:
+    // Longest stretch of cycles Bus::run lets pass without ticking the devices
+    static constexpr u64 DEFAULT_QUANTUM = 1024;
+
+    Bus(Cpu& cpu, Mem& mem);
+    ~Bus() override;
+
+    Bus(const Bus&) = delete;
+    Bus& operator=(const Bus&) = delete;
+
+    // Maps `device` at `base`..`base + size - 1`. The device is not owned and
+    // must outlive the mapping. Later mappings take precedence where they overlap.
+    void map(Device& device, word base, u32 size);
+
+    // Removes every device and maps their pages back to RAM
+    void unmap_all();
+
+    // Like Cpu::run, but ticks the devices at least every `quantum` cycles
+    u64 run(u64 cycles, StopReason& reason);
+
+    // Ticks every device up to the CPU's current cycle count
+    void sync();
+
+    u64 quantum = DEFAULT_QUANTUM;
+
+   private:
+    struct Region {
+        Device* device;
+        word base;
+        u32 size;
+    };
+
+    byte read(word addr) override;
+    void write(word addr, byte value) override;
+
+    // The region that claims `addr`, or nullptr
+    const Region* find(word addr) const;
+
+    Cpu& cpu;
+    Mem& mem;
+    std::vector<Region> regions;  // Newest first
+    std::vector<Device*> devices;  // Each mapped device once, for ticking
+    u64 synced_cycles;
+};
+
+#endif  // BUS_H
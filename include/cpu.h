@@ -1,44 +1,83 @@
 #ifndef CPU_H
 #define CPU_H
 
-#include <iomanip>
-#include <iostream>
+#include <type_traits>
 
-#include "colors.h"
 #include "memory.h"
 #include "op_codes.h"
 #include "types.h"
 
-class Cpu {
-   private:
-    void LDA_SetFlags();
-    byte registers[3];          // Index registers
-    i32 ABORT_STATUS = -99999;  // Special status for aborting execution
+// Interpreter cores that can run a program
+enum class Engine : byte {
+    Table,     // Loop with one indirect call through the opcode table per instruction
+    Threaded,  // Computed-goto dispatch where every handler jumps straight to the next (GCC/Clang)
+    Block,     // Runs predecoded basic blocks from the block cache attached to the memory
+    Jit,       // Block cache plus native x86-64 code for hot blocks (falls back to Block elsewhere)
+    Pins,      // Cycle-stepped; drives the PINS union every half-cycle for bus co-simulation
+};
 
-   public:
+#ifdef EMULATOR_THREADED_DISPATCH
+inline constexpr Engine DEFAULT_ENGINE = Engine::Threaded;
+#else
+inline constexpr Engine DEFAULT_ENGINE = Engine::Table;
+#endif
+
+class BusObserver;
+
+// Why a headless run returned
+enum class StopReason : byte {
+    CyclesExhausted,  // The cycle budget ran out
+    Returned,         // An RTS was executed
+};
+
+// The programmer-visible registers in 8 bytes. Trivially copyable, so register
+// files can be saved, batched and compared with plain memcpy.
+struct CpuState {
     word PC;  // Program counter register
     byte SP;  // Stack pointer register (8-bit)
+    byte A;   // Accumulator
+    byte X;   // Index register X
+    byte Y;   // Index register Y
 
-    // Register references for easier access
-    byte& A = registers[static_cast<byte>(Register::A)];
-    byte& X = registers[static_cast<byte>(Register::X)];
-    byte& Y = registers[static_cast<byte>(Register::Y)];
-
+    // Status register. Bitfields are allocated from the least significant bit,
+    // so FLAGS is the status byte in 6502 order, as PHP pushes it.
+    // With lazy flags N and Z may be pending; see Cpu::sync_flags().
     union {
         byte FLAGS;  // Status flags byte
         struct {
-            byte FLAGS_N : 1;  // Negative Flag (bit 7)
-            byte FLAGS_V : 1;  // Overflow Flag (bit 6)
-            byte FLAGS_U : 1;  // Unused/expansion (bit 5)
-            byte FLAGS_B : 1;  // Break Flag (bit 4)
-            byte FLAGS_D : 1;  // Decimal Mode Flag (bit 3)
-            byte FLAGS_I : 1;  // Interrupt Disable Flag (bit 2)
-            byte FLAGS_Z : 1;  // Zero Flag (bit 1)
             byte FLAGS_C : 1;  // Carry Flag (bit 0)
+            byte FLAGS_Z : 1;  // Zero Flag (bit 1)
+            byte FLAGS_I : 1;  // Interrupt Disable Flag (bit 2)
+            byte FLAGS_D : 1;  // Decimal Mode Flag (bit 3)
+            byte FLAGS_B : 1;  // Break Flag (bit 4)
+            byte FLAGS_U : 1;  // Unused/expansion (bit 5)
+            byte FLAGS_V : 1;  // Overflow Flag (bit 6)
+            byte FLAGS_N : 1;  // Negative Flag (bit 7)
         };
     };
+};
+
+static_assert(sizeof(CpuState) == 8, "CpuState should pack into 8 bytes");
+static_assert(std::is_trivially_copyable<CpuState>::value, "CpuState must be memcpy-able");
+
+// The registers are inherited from CpuState as plain fields
+class Cpu : public CpuState {
+   public:
+    static constexpr byte STATUS_Z = 1 << 1;
+    static constexpr byte STATUS_N = 1 << 7;
+
+    // The stack is page $01; SP is the offset of the next free byte in it
+    static constexpr word STACK_BASE = 0x0100;
+
+#ifdef EMULATOR_LAZY_FLAGS
+    // Last result that sets N and Z, in the low byte; bit 8 is set while it
+    // has not been folded into FLAGS yet
+    word nz_result = 0;
+#endif
 
-    // Pin layout for MOS 6502 with address/data bus access
+    // Pin layout for MOS 6502 with address/data bus access. Only Engine::Pins drives
+    // the pins; the other engines leave them alone. The fields are grouped by bus
+    // rather than by pin number, so that ADDR and DATA are contiguous.
     union {
         pinl_t PINS;  // Raw access to all pins at once
 
@@ -53,7 +92,7 @@ class Cpu {
             pinl_t PIN_7 : 1;  // SYNC  - Indicates opcode fetch
             pinl_t PIN_8 : 1;  // VCC   - +5V power
 
-            // Address bus (low half)
+            // Address bus (pins 9-20 and 22-25)
             pinl_t A0 : 1;   // Address line bit 0
             pinl_t A1 : 1;   // Address line bit 1
             pinl_t A2 : 1;   // Address line bit 2
@@ -66,24 +105,20 @@ class Cpu {
             pinl_t A9 : 1;   // Address line bit 9
             pinl_t A10 : 1;  // Address line bit 10
             pinl_t A11 : 1;  // Address line bit 11
-
-            pinl_t VSS2 : 1;  // VSS   - Ground (second ground at pin 21)
-
-            // Address bus (high half)
             pinl_t A12 : 1;  // Address line bit 12
             pinl_t A13 : 1;  // Address line bit 13
             pinl_t A14 : 1;  // Address line bit 14
             pinl_t A15 : 1;  // Address line bit 15
 
-            // Data bus
-            pinl_t D7 : 1;  // Data line bit 7
-            pinl_t D6 : 1;  // Data line bit 6
-            pinl_t D5 : 1;  // Data line bit 5
-            pinl_t D4 : 1;  // Data line bit 4
-            pinl_t D3 : 1;  // Data line bit 3
-            pinl_t D2 : 1;  // Data line bit 2
-            pinl_t D1 : 1;  // Data line bit 1
+            // Data bus (pins 33 down to 26)
             pinl_t D0 : 1;  // Data line bit 0
+            pinl_t D1 : 1;  // Data line bit 1
+            pinl_t D2 : 1;  // Data line bit 2
+            pinl_t D3 : 1;  // Data line bit 3
+            pinl_t D4 : 1;  // Data line bit 4
+            pinl_t D5 : 1;  // Data line bit 5
+            pinl_t D6 : 1;  // Data line bit 6
+            pinl_t D7 : 1;  // Data line bit 7
 
             pinl_t RWB : 1;    // Read (high) / Write (low)
             pinl_t NC36 : 1;   // NC
@@ -92,6 +127,8 @@ class Cpu {
             pinl_t S0 : 1;     // S0
             pinl_t PHI2O : 1;  // PHI2O - Phase 2 clock output
             pinl_t RESB : 1;   // Reset (active low)
+
+            pinl_t VSS2 : 1;  // VSS   - Ground (second ground at pin 21)
         };
 
         // === Packed access to buses ===
@@ -101,141 +138,180 @@ class Cpu {
         } addr_bus;
 
         struct {
-            pinl_t _skipD0 : 24;  // Skip pins before D7
-            pinl_t DATA : 8;      // D7..D0
+            pinl_t _skipD0 : 24;  // Skip pins before D0
+            pinl_t DATA : 8;      // D0..D7 (low to high bit order)
         } data_bus;
     };
 
-    // Register access methods
-    byte& get(const Register r);
-    void set(Register r, byte val);
+    // Notified after every half-cycle of Engine::Pins; not owned
+    BusObserver* bus_observer = nullptr;
 
-    // CPU operations
-    void reset(Mem& mem);
-    byte fetch_byte(i32& cycles, Mem& mem);
-    word fetch_word(i32& cycles, Mem& mem);
-    byte read_byte(byte zp_addr, i32& cycles, Mem& mem);
-    // Execute CPU instructions for the given number of cycles
-    // Returns the number of cycles actually used
-    // Sets the completed flag to true if execution finished with RTS
-    i32 execute(i32 cycles, Mem& mem, bool* completed = nullptr, bool testing_env = false);
+    // Interpreter core used by run()
+    Engine engine = DEFAULT_ENGINE;
+
+    // Cycles executed since the last reset. Engines add each opcode's base cost from
+    // dispatch::table before running it; handlers only add penalties such as page crossings.
+    u64 cycle_count = 0;
+
+    // Unimplemented opcodes executed since the last reset, and the address of the last one
+    u32 invalid_opcodes = 0;
+    word last_invalid_pc = 0;
 
-    i32 cpu_mode_decider(bool manual_mode, i32& cycles, i32 starting_cycles, Mem& mem, bool* completed_out = nullptr) {
-        if (manual_mode) {
-            while (true) {
-                std::cout << colors::YELLOW << "[Step: Enter/s/q]: " << colors::RESET;
-                std::string input;
-                std::getline(std::cin, input);
-
-                // Convert input to lowercase for case-insensitive comparison
-                for (auto& c : input) {
-                    c = std::tolower(c);
-                }
-
-                if (input.empty() || input == "y" || input == "yes") {
-                    // Continue execution - just break from this loop
-                    break;
-                } else if (input == "s" || input == "state") {
-                    // Show CPU state without advancing
-                    print_state(starting_cycles - cycles, false);
-                    continue;
-                } else if (input == "q" || input == "quit") {
-                    // Quit execution
-                    std::cout << colors::BOLD << colors::BLUE << "Execution terminated by user.\n" << colors::RESET;
-
-                    // If caller wants to know completion status
-                    if (completed_out != nullptr) {
-                        *completed_out = false;
-                    }
-
-                    // Return the number of cycles actually used
-                    return ABORT_STATUS;
-                } else {
-                    std::cout << colors::RED << "Invalid input. Press Enter to continue, 's' for state, 'q' to quit.\n"
-                              << colors::RESET;
-                    continue;
-                }
-            }
+#ifdef EMULATOR_STACK_CHECKS
+    // A push with SP at $00 (overflow) or a pull with SP at $FF (underflow), which
+    // the 6502 silently wraps within page $01
+    struct StackFault {
+        u64 cycle;      // cycle_count when it happened
+        word pc;        // PC at the time, past the instruction's operands
+        bool overflow;  // False for an underflow
+    };
+
+    // Stack wraparounds since the last reset, and the last one. Only built with
+    // the CMake option ENABLE_STACK_CHECKS; reporting them is left to the front end.
+    u32 stack_overflows = 0;
+    u32 stack_underflows = 0;
+    StackFault last_stack_fault = {};
+#endif
+
+    // Register access by name; folds to a plain field access for a constant `r`
+    byte& get(const Register r) {
+        switch (r) {
+            case Register::A:
+                return A;
+            case Register::X:
+                return X;
+            default:
+                return Y;
         }
-        return starting_cycles - cycles;
+    }
+    void set(Register r, byte val) { get(r) = val; }
+
+    // Register file with pending N/Z folded into the flags, and its reverse
+    CpuState save() const {
+        CpuState state = *this;
+        state.FLAGS = status();
+        return state;
+    }
+    void load(const CpuState& state) {
+        static_cast<CpuState&>(*this) = state;
+        set_flags(state.FLAGS);
     }
 
-    void print_current_execution(word ins, Cpu& cpu, Mem& mem, bool testing_env = false) {
-        // Skip printing in testing mode
-        if (testing_env) {
-            return;
+    // Sets N and Z from a result. With lazy flags (CMake option ENABLE_LAZY_FLAGS)
+    // this only records the value, and FLAGS is updated by sync_flags().
+    void set_nz(byte value) {
+#ifdef EMULATOR_LAZY_FLAGS
+        nz_result = 0x100 | value;
+#else
+        FLAGS = (FLAGS & ~(STATUS_N | STATUS_Z)) | (value & STATUS_N) | (value == 0 ? STATUS_Z : 0);
+#endif
+    }
+
+    // Status byte with pending N/Z applied, without touching FLAGS
+    byte status() const {
+#ifdef EMULATOR_LAZY_FLAGS
+        if (nz_result & 0x100) {
+            byte value = static_cast<byte>(nz_result);
+            return (FLAGS & ~(STATUS_N | STATUS_Z)) | (value & STATUS_N) | (value == 0 ? STATUS_Z : 0);
         }
+#endif
+        return FLAGS;
+    }
+
+    // Folds pending N/Z into FLAGS. Must run before FLAGS or the flag bitfields
+    // are read; run() does it before returning.
+    void sync_flags() {
+#ifdef EMULATOR_LAZY_FLAGS
+        FLAGS = status();
+        nz_result = 0;
+#endif
+    }
+
+    // Replaces the whole status register, dropping pending N/Z
+    void set_flags(byte status) {
+        FLAGS = status;
+#ifdef EMULATOR_LAZY_FLAGS
+        nz_result = 0;
+#endif
+    }
+
+    // CPU operations
+    void reset(Mem& mem);
 
-        word operand_word = static_cast<word>(mem[PC]) | (static_cast<word>(mem[PC + 1]) << 8);
-
-        std::cout << colors::BOLD << colors::BLUE;
-        std::cout << "0x" << std::setfill('0') << std::setw(4) << std::hex << (PC) << ": ";
-        std::cout << colors::GREEN << "sp = 0x01" << std::setfill('0') << std::setw(2) << std::hex
-                  << static_cast<int>(SP) << "  ";
-        std::cout << "pc = 0x" << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(PC) << "  ";
-        std::cout << colors::RESET << colors::BLUE;
-        std::cout << "ins = 0x" << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(ins);
-        std::cout << " [" << std::setfill(' ') << std::setw(10) << opcodes::from_byte(ins) << "]";
-        std::cout << " [argument (next 2-bytes) = 0x" << std::setfill('0') << std::setw(4) << std::hex << operand_word
-                  << "]";
-        std::cout << colors::RESET << std::endl;
-        std::cout << std::dec;  // Ensure we print in decimal mode for the rest of the output
+    // Operand fetches at PC; inline so that templated handlers compile to straight-line code
+    byte fetch_byte(Mem& mem) { return mem.fetch(PC++); }
+    word fetch_word(Mem& mem) {
+        // little endian mode
+        word d = mem.fetch(PC++);     // LSB
+        d |= (mem.fetch(PC++) << 8);  // MSB
+        return d;
     }
 
-    void print_state(int cycles_used, bool program_completed, bool testing_env = false) const {
-        // Skip printing in testing mode
-        if (testing_env) {
-            return;
+    // Stack accessors used by every push and pull. SP wraps within page $01; with
+    // ENABLE_STACK_CHECKS the wraparound is recorded, otherwise the check is not built.
+    void push8(Mem& mem, byte value) {
+#ifdef EMULATOR_STACK_CHECKS
+        if (SP == 0x00) {
+            stack_fault(true);
+        }
+#endif
+        mem.write(STACK_BASE | SP, value);
+        SP--;
+    }
+    byte pull8(Mem& mem) {
+#ifdef EMULATOR_STACK_CHECKS
+        if (SP == 0xFF) {
+            stack_fault(false);
         }
-        // Save the current cout formatting state
-        auto flags = std::cout.flags();
-
-        // Create a nicer formatted output with borders and aligned values
-        std::cout << colors::GREEN << "\n";
-        std::cout << "┌───────────────── CPU STATE ─────────────────┐\n";
-        std::cout << "| " << colors::BOLD << "Execution " << (program_completed ? colors::GREEN : colors::RED)
-                  << (program_completed ? "COMPLETED" : "INCOMPLETE") << colors::RESET << colors::GREEN << colors::BOLD
-                  << " using " << cycles_used << " cycles" << std::setw(13) << std::setfill(' ') << " │\n";
-        std::cout << "├───────────────── REGISTERS ─────────────────┤\n";
-        // Register section
-        std::cout << "│ ";
-        std::cout << colors::BOLD << "PC" << colors::GREEN << " (16-bit): 0x" << std::setw(4) << std::setfill('0')
-                  << std::hex << PC << " -- ";
-        std::cout << colors::BOLD << "SP" << colors::GREEN << " (8-bit): 0x01" << std::setw(2) << std::setfill('0')
-                  << std::hex << static_cast<int>(SP) << "   │\n";
-
-        std::cout << "├─────────────────────────────────────────────┤\n";
-
-        // Display A, X, Y registers with both hex and decimal values
-        std::cout << "│ ";
-        std::cout << colors::BOLD << "A" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0') << std::hex
-                  << static_cast<int>(A) << " (" << std::setw(3) << std::setfill(' ') << std::dec << static_cast<int>(A)
-                  << ")";
-
-        std::cout << "  " << colors::BOLD << "X" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0')
-                  << std::hex << static_cast<int>(X) << " (" << std::setw(3) << std::setfill(' ') << std::dec
-                  << static_cast<int>(X) << ")";
-
-        std::cout << "  " << colors::BOLD << "Y" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0')
-                  << std::hex << static_cast<int>(Y) << " (" << std::setw(3) << std::setfill(' ') << std::dec
-                  << static_cast<int>(Y) << ")"
-                  << " │\n";
-
-        // Status flags section
-        std::cout << "├─────────────── STATUS FLAGS ────────────────┤\n";
-        std::cout << "│  ";
-        std::cout << colors::BOLD << "N   V   U   B   D   I   Z   C" << colors::GREEN << "              │\n";
-
-        std::cout << "│  " << static_cast<int>(FLAGS_N) << "   " << static_cast<int>(FLAGS_V) << "   "
-                  << static_cast<int>(FLAGS_U) << "   " << static_cast<int>(FLAGS_B) << "   "
-                  << static_cast<int>(FLAGS_D) << "   " << static_cast<int>(FLAGS_I) << "   "
-                  << static_cast<int>(FLAGS_Z) << "   " << static_cast<int>(FLAGS_C) << "              │\n";
-
-        std::cout << "└─────────────────────────────────────────────┘" << colors::RESET << "\n";
-
-        // Restore the original cout formatting state
-        std::cout.flags(flags);
+#endif
+        SP++;
+        return mem.read(STACK_BASE | SP);
+    }
+
+    // 16-bit values go high byte first, so they sit little-endian on the stack
+    void push16(Mem& mem, word value) {
+        push8(mem, value >> 8);
+        push8(mem, value & 0xFF);
+    }
+    word pull16(Mem& mem) {
+        word lo = pull8(mem);
+        return lo | (pull8(mem) << 8);
+    }
+
+    // Reads a little-endian pointer from the zero page; the high byte at $FF wraps to $00
+    static word zp16(const Mem& mem, byte ptr) {
+        return mem.read(ptr) | (mem.read(static_cast<byte>(ptr + 1)) << 8);
     }
+
+    // Headless execution: runs the selected engine for `cycles` cycles without any I/O.
+    // The instruction that reaches the deadline is finished, so a run can use a few
+    // cycles more than requested. Returns the number of cycles used and sets `reason`.
+    u64 run(u64 cycles, Mem& mem, StopReason& reason);
+
+    // Executes a single instruction and charges its cycles. Returns true if it was an RTS.
+    // N and Z may still be pending afterwards.
+    bool step(Mem& mem);
+
+    // Execute CPU instructions for the given number of cycles
+    // Returns the number of cycles actually used
+    // Sets the completed flag to true if execution finished with RTS
+    // In a testing environment this is run(); otherwise it goes through the interactive front end.
+    i32 execute(i32 cycles, Mem& mem, bool* completed = nullptr, bool testing_env = false);
+
+    // Engine loops: start instructions while `cycle_count` is below `deadline`,
+    // or until an RTS is executed. All return true if execution stopped on RTS.
+    bool run_table(u64 deadline, Mem& mem);
+    bool run_threaded(u64 deadline, Mem& mem);  // Falls back to the table loop without computed goto
+    bool run_blocks(u64 deadline, Mem& mem);
+    bool run_jit(u64 deadline, Mem& mem);   // Same as run_blocks without the recompiler
+    bool run_pins(u64 deadline, Mem& mem);  // Stops on instruction boundaries like the others
+
+   private:
+#ifdef EMULATOR_STACK_CHECKS
+    [[gnu::cold]] void stack_fault(bool overflow);
+#endif
 };
 
+static_assert(std::is_trivially_copyable<Cpu>::value, "Cpu must stay copyable with memcpy");
+
 #endif  // CPU_H
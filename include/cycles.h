@@ -0,0 +1,26 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include "types.h"
+
+// Extra cycles an instruction can take on top of its base cost in the opcode table
+enum class Penalty : byte {
+    None,
+    PageCross,    // Indexed read whose effective address is on another page than its base
+    BranchTaken,  // Taken branch, plus a page-crossing cycle when the target is on another page
+};
+
+inline constexpr byte PAGE_CROSS_CYCLES = 1;
+inline constexpr byte BRANCH_TAKEN_CYCLES = 1;
+
+// Cycles added when indexing `base` ends up at `addr` on a different page
+constexpr byte page_cross_cycles(word base, word addr) {
+    return (base ^ addr) & 0xFF00 ? PAGE_CROSS_CYCLES : 0;
+}
+
+// Cycles added by a taken branch from the instruction following it (`next_pc`) to `target`
+constexpr byte branch_taken_cycles(word next_pc, word target) {
+    return BRANCH_TAKEN_CYCLES + page_cross_cycles(next_pc, target);
+}
+
+#endif  // CYCLES_H
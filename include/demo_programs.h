@@ -1,25 +1,27 @@
 #ifndef DEMO_PROGRAMS_H
 #define DEMO_PROGRAMS_H
 
-#include <map>
-#include <vector>
-
-#include "types.h"
+#include "program_image.h"
 
+// The demos live in static arrays; every call returns a view of the same
+// constant image, so reloading one does not allocate.
 namespace demo_programs {
 
 // Demo program showcasing only LDA instructions with various addressing modes
-std::map<u32, std::vector<byte>> get_lda_demo();
+ProgramImage get_lda_demo();
 
 // Demo program showcasing only LDX instructions with various addressing modes
-std::map<u32, std::vector<byte>> get_ldx_demo();
+ProgramImage get_ldx_demo();
 
 // Demo program showcasing only LDY instructions with various addressing modes
-std::map<u32, std::vector<byte>> get_ldy_demo();
+ProgramImage get_ldy_demo();
 
 // A comprehensive demo program showcasing various instructions and addressing modes
 // including LDA, LDX, LDY, JSR, RTS with their different addressing variants
-std::map<u32, std::vector<byte>> get_instruction_demo();
+ProgramImage get_instruction_demo();
+
+// Endless loop that increments X and stores it to $0200 (programs/counter.asm)
+ProgramImage get_counter_program();
 
 }  // namespace demo_programs
 
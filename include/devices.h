@@ -0,0 +1,49 @@
+#ifndef DEVICES_H
+#define DEVICES_H
+
+#include <iostream>
+
+#include "bus.h"
+#include "types.h"
+
+// Built-in stand-ins for the peripherals test programs talk to
+namespace devices {
+
+// Write-only character output: every byte stored to offset 0 is written to the
+// stream. Reads return 0, i.e. the console is always ready.
+class ConsoleOutput : public Device {
+   public:
+    static constexpr u32 SIZE = 1;
+
+    explicit ConsoleOutput(std::ostream& out = std::cout) : out(out) {}
+
+    byte read(word offset) override;
+    void write(word offset, byte value) override;
+
+   private:
+    std::ostream& out;
+};
+
+// Free-running cycle counter. A store to any register latches the cycles
+// counted so far; offsets 0-3 read the latched value, least significant byte
+// first. programs/counter.asm expects it at $0200.
+class CycleCounter : public Device {
+   public:
+    static constexpr word DEFAULT_BASE = 0x0200;
+    static constexpr u32 SIZE = 4;
+
+    byte read(word offset) override;
+    void write(word offset, byte value) override;
+    void tick(u64 cycles) override { count += cycles; }
+
+    u64 cycles() const { return count; }
+    u32 latched() const { return latch; }
+
+   private:
+    u64 count = 0;
+    u32 latch = 0;
+};
+
+}  // namespace devices
+
+#endif  // DEVICES_H
@@ -0,0 +1,127 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <array>
+
+#include "cpu.h"
+#include "cycles.h"
+#include "instructions.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "types.h"
+
+namespace dispatch {
+
+// Signature shared by every handler in the `instructions` namespace
+using Handler = void (*)(Cpu& cpu, Mem& mem);
+
+// What an instruction does on the bus besides fetching its opcode and operand.
+// Together with the addressing mode this gives the per-cycle bus accesses that
+// Engine::Pins steps through.
+enum class Access : byte {
+    None,     // Nothing after the opcode fetch (trap for unimplemented opcodes)
+    Implied,  // Register-only operation
+    Read,     // Reads the effective address (or the immediate operand)
+    Write,    // Writes the effective address
+    Push,     // Writes one byte to the stack
+    Pull,     // Reads one byte from the stack
+    Call,     // JSR: pushes the return address
+    Return,   // RTS: pulls the return address
+    Jump,     // JMP, absolute or indirect
+};
+
+// One slot of the opcode table
+struct OpEntry {
+    Handler handler;                  // Instruction implementation
+    byte cycles;                      // Base cycles, including the opcode fetch; charged by the engine
+    AddrMode mode;                    // How the operand bytes following the opcode are decoded
+    Access access;                    // Bus activity after the operand fetch
+    Penalty penalty = Penalty::None;  // Extra cycles the handler may add at run time
+};
+
+// Number of operand bytes that follow the opcode for an addressing mode
+constexpr byte operand_bytes(AddrMode mode) {
+    switch (mode) {
+        case AddrMode::IMP:
+            return 0;
+        case AddrMode::ABS:
+        case AddrMode::ABSX:
+        case AddrMode::ABSY:
+        case AddrMode::IND:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+// Builds the 256-entry opcode table from the `Op` enum.
+// Every byte that is not an implemented opcode is routed to the cold trap handler.
+// Cycle counts are those of the NMOS 6502; indexed reads marked Penalty::PageCross
+// take one more cycle when the index carries into the next page.
+constexpr std::array<OpEntry, 256> build_table() {
+    std::array<OpEntry, 256> t{};
+    for (auto& e : t) {
+        e = {instructions::TRAP, 1, AddrMode::IMP, Access::None};
+    }
+
+    // LDA
+    t[op(Op::LDA_IM)] = {instructions::LDA_IM, 2, AddrMode::IMM, Access::Read};
+    t[op(Op::LDA_ZP)] = {instructions::LDA_ZP, 3, AddrMode::ZP, Access::Read};
+    t[op(Op::LDA_ZPX)] = {instructions::LDA_ZPX, 4, AddrMode::ZPX, Access::Read};
+    t[op(Op::LDA_AB)] = {instructions::LDA_AB, 4, AddrMode::ABS, Access::Read};
+    t[op(Op::LDA_ABSX)] = {instructions::LDA_ABSX, 4, AddrMode::ABSX, Access::Read, Penalty::PageCross};
+    t[op(Op::LDA_ABSY)] = {instructions::LDA_ABSY, 4, AddrMode::ABSY, Access::Read, Penalty::PageCross};
+    t[op(Op::LDA_INX)] = {instructions::LDA_INX, 6, AddrMode::INDX, Access::Read};
+    t[op(Op::LDA_INY)] = {instructions::LDA_INY, 5, AddrMode::INDY, Access::Read, Penalty::PageCross};
+    // LDX
+    t[op(Op::LDX_IM)] = {instructions::LDX_IM, 2, AddrMode::IMM, Access::Read};
+    t[op(Op::LDX_ZP)] = {instructions::LDX_ZP, 3, AddrMode::ZP, Access::Read};
+    t[op(Op::LDX_ZPY)] = {instructions::LDX_ZPY, 4, AddrMode::ZPY, Access::Read};
+    t[op(Op::LDX_AB)] = {instructions::LDX_AB, 4, AddrMode::ABS, Access::Read};
+    t[op(Op::LDX_ABSY)] = {instructions::LDX_ABSY, 4, AddrMode::ABSY, Access::Read, Penalty::PageCross};
+    // LDY
+    t[op(Op::LDY_IM)] = {instructions::LDY_IM, 2, AddrMode::IMM, Access::Read};
+    t[op(Op::LDY_ZP)] = {instructions::LDY_ZP, 3, AddrMode::ZP, Access::Read};
+    t[op(Op::LDY_ZPX)] = {instructions::LDY_ZPX, 4, AddrMode::ZPX, Access::Read};
+    t[op(Op::LDY_AB)] = {instructions::LDY_AB, 4, AddrMode::ABS, Access::Read};
+    t[op(Op::LDY_ABSX)] = {instructions::LDY_ABSX, 4, AddrMode::ABSX, Access::Read, Penalty::PageCross};
+    // STA
+    t[op(Op::STA_ZP)] = {instructions::STA_ZP, 3, AddrMode::ZP, Access::Write};
+    t[op(Op::STA_ZPX)] = {instructions::STA_ZPX, 4, AddrMode::ZPX, Access::Write};
+    t[op(Op::STA_ABS)] = {instructions::STA_ABS, 4, AddrMode::ABS, Access::Write};
+    t[op(Op::STA_ABSX)] = {instructions::STA_ABSX, 5, AddrMode::ABSX, Access::Write};
+    t[op(Op::STA_ABSY)] = {instructions::STA_ABSY, 5, AddrMode::ABSY, Access::Write};
+    t[op(Op::STA_INX)] = {instructions::STA_INX, 6, AddrMode::INDX, Access::Write};
+    t[op(Op::STA_INY)] = {instructions::STA_INY, 6, AddrMode::INDY, Access::Write};
+    // STX
+    t[op(Op::STX_ZP)] = {instructions::STX_ZP, 3, AddrMode::ZP, Access::Write};
+    t[op(Op::STX_ZPY)] = {instructions::STX_ZPY, 4, AddrMode::ZPY, Access::Write};
+    t[op(Op::STX_ABS)] = {instructions::STX_ABS, 4, AddrMode::ABS, Access::Write};
+    // STY
+    t[op(Op::STY_ZP)] = {instructions::STY_ZP, 3, AddrMode::ZP, Access::Write};
+    t[op(Op::STY_ZPX)] = {instructions::STY_ZPX, 4, AddrMode::ZPX, Access::Write};
+    t[op(Op::STY_ABS)] = {instructions::STY_ABS, 4, AddrMode::ABS, Access::Write};
+    // Control flow and miscellaneous
+    t[op(Op::JSR)] = {instructions::JSR, 6, AddrMode::ABS, Access::Call};
+    t[op(Op::RTS)] = {instructions::RTS, 6, AddrMode::IMP, Access::Return};
+    t[op(Op::JMP)] = {instructions::JMP, 3, AddrMode::ABS, Access::Jump};
+    t[op(Op::JMPI)] = {instructions::JMPI, 5, AddrMode::IND, Access::Jump};
+    t[op(Op::NOP)] = {instructions::NOP, 2, AddrMode::IMP, Access::Implied};
+    // Stack operations
+    t[op(Op::PHA)] = {instructions::PHA, 3, AddrMode::IMP, Access::Push};
+    t[op(Op::PHP)] = {instructions::PHP, 3, AddrMode::IMP, Access::Push};
+    t[op(Op::PLA)] = {instructions::PLA, 4, AddrMode::IMP, Access::Pull};
+    t[op(Op::PLP)] = {instructions::PLP, 4, AddrMode::IMP, Access::Pull};
+    t[op(Op::TSX)] = {instructions::TSX, 2, AddrMode::IMP, Access::Implied};
+    t[op(Op::TXS)] = {instructions::TXS, 2, AddrMode::IMP, Access::Implied};
+    // Increment operations
+    t[op(Op::INX)] = {instructions::INX, 2, AddrMode::IMP, Access::Implied};
+
+    return t;
+}
+
+inline constexpr std::array<OpEntry, 256> table = build_table();
+
+}  // namespace dispatch
+
+#endif  // DISPATCH_H
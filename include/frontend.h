@@ -0,0 +1,33 @@
+#ifndef FRONTEND_H
+#define FRONTEND_H
+
+#include "cpu.h"
+#include "memory.h"
+#include "types.h"
+
+// Interactive layer on top of the headless Cpu::run / Cpu::step API.
+// Everything that talks to stdin/stdout while a program runs lives here.
+namespace frontend {
+
+// Special status returned when the user aborts a manual run
+constexpr i32 ABORT_STATUS = -99999;
+
+// Runs a program with the execution mode prompt, a per-instruction trace
+// and optional manual stepping.
+// Returns the number of cycles actually used, or ABORT_STATUS if the user quit.
+i32 execute(Cpu& cpu, i32 cycles, Mem& mem, bool* completed_out = nullptr);
+
+// Waits for the user in manual stepping mode.
+// Returns ABORT_STATUS if the user chose to quit, otherwise the cycles used so far.
+i32 cpu_mode_decider(const Cpu& cpu, bool manual_mode, i32& cycles, i32 starting_cycles,
+                     bool* completed_out = nullptr);
+
+// Prints the instruction about to be executed
+void print_current_execution(const Cpu& cpu, word ins, Mem& mem);
+
+// Prints the registers and flags in a box
+void print_state(const Cpu& cpu, int cycles_used, bool program_completed);
+
+}  // namespace frontend
+
+#endif  // FRONTEND_H
@@ -3,74 +3,84 @@
 
 #include "cpu.h"
 #include "memory.h"
+#include "operations.h"
 #include "types.h"
 
 namespace instructions {
 
+// Loads and stores are instantiated from the templates in operations.h,
+// so calls through these names compile to inline code
+
 // LDA Instructions
-void LDA_IM(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_ZPX(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_AB(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_ABSX(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_ABSY(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_INX(Cpu& cpu, i32& cycles, Mem& mem);
-void LDA_INY(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& LDA_IM = Load<Register::A, addressing::IMM>::execute;
+inline constexpr auto& LDA_ZP = Load<Register::A, addressing::ZP>::execute;
+inline constexpr auto& LDA_ZPX = Load<Register::A, addressing::ZPX>::execute;
+inline constexpr auto& LDA_AB = Load<Register::A, addressing::ABS>::execute;
+inline constexpr auto& LDA_ABSX = Load<Register::A, addressing::ABSX>::execute;
+inline constexpr auto& LDA_ABSY = Load<Register::A, addressing::ABSY>::execute;
+inline constexpr auto& LDA_INX = Load<Register::A, addressing::INDX>::execute;
+inline constexpr auto& LDA_INY = Load<Register::A, addressing::INDY>::execute;
 
 // LDX Instructions
-void LDX_IM(Cpu& cpu, i32& cycles, Mem& mem);
-void LDX_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void LDX_ZPY(Cpu& cpu, i32& cycles, Mem& mem);
-void LDX_AB(Cpu& cpu, i32& cycles, Mem& mem);
-void LDX_ABSY(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& LDX_IM = Load<Register::X, addressing::IMM>::execute;
+inline constexpr auto& LDX_ZP = Load<Register::X, addressing::ZP>::execute;
+inline constexpr auto& LDX_ZPY = Load<Register::X, addressing::ZPY>::execute;
+inline constexpr auto& LDX_AB = Load<Register::X, addressing::ABS>::execute;
+inline constexpr auto& LDX_ABSY = Load<Register::X, addressing::ABSY>::execute;
 
 // LDY Instructions
-void LDY_IM(Cpu& cpu, i32& cycles, Mem& mem);
-void LDY_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void LDY_ZPX(Cpu& cpu, i32& cycles, Mem& mem);
-void LDY_AB(Cpu& cpu, i32& cycles, Mem& mem);
-void LDY_ABSX(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& LDY_IM = Load<Register::Y, addressing::IMM>::execute;
+inline constexpr auto& LDY_ZP = Load<Register::Y, addressing::ZP>::execute;
+inline constexpr auto& LDY_ZPX = Load<Register::Y, addressing::ZPX>::execute;
+inline constexpr auto& LDY_AB = Load<Register::Y, addressing::ABS>::execute;
+inline constexpr auto& LDY_ABSX = Load<Register::Y, addressing::ABSX>::execute;
 
 // STA Instructions
-void STA_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_ZPX(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_ABS(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_ABSX(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_ABSY(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_INX(Cpu& cpu, i32& cycles, Mem& mem);
-void STA_INY(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& STA_ZP = Store<Register::A, addressing::ZP>::execute;
+inline constexpr auto& STA_ZPX = Store<Register::A, addressing::ZPX>::execute;
+inline constexpr auto& STA_ABS = Store<Register::A, addressing::ABS>::execute;
+inline constexpr auto& STA_ABSX = Store<Register::A, addressing::ABSX>::execute;
+inline constexpr auto& STA_ABSY = Store<Register::A, addressing::ABSY>::execute;
+inline constexpr auto& STA_INX = Store<Register::A, addressing::INDX>::execute;
+inline constexpr auto& STA_INY = Store<Register::A, addressing::INDY>::execute;
 
 // STX Instructions
-void STX_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void STX_ZPY(Cpu& cpu, i32& cycles, Mem& mem);
-void STX_ABS(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& STX_ZP = Store<Register::X, addressing::ZP>::execute;
+inline constexpr auto& STX_ZPY = Store<Register::X, addressing::ZPY>::execute;
+inline constexpr auto& STX_ABS = Store<Register::X, addressing::ABS>::execute;
 
 // STY Instructions
-void STY_ZP(Cpu& cpu, i32& cycles, Mem& mem);
-void STY_ZPX(Cpu& cpu, i32& cycles, Mem& mem);
-void STY_ABS(Cpu& cpu, i32& cycles, Mem& mem);
+inline constexpr auto& STY_ZP = Store<Register::Y, addressing::ZP>::execute;
+inline constexpr auto& STY_ZPX = Store<Register::Y, addressing::ZPX>::execute;
+inline constexpr auto& STY_ABS = Store<Register::Y, addressing::ABS>::execute;
 
 // JSR Instruction
-void JSR(Cpu& cpu, i32& cycles, Mem& mem);
+void JSR(Cpu& cpu, Mem& mem);
 
 // JMP Instruction
-void JMP(Cpu& cpu, i32& cycles, Mem& mem);
+void JMP(Cpu& cpu, Mem& mem);
 // JMPI Instruction
-void JMPI(Cpu& cpu, i32& cycles, Mem& mem);
+void JMPI(Cpu& cpu, Mem& mem);
 
 // RTS Instruction
-void RTS(Cpu& cpu, i32& cycles, Mem& mem);
+void RTS(Cpu& cpu, Mem& mem);
 
 // NOP Instruction
-void NOP(Cpu& cpu, i32& cycles, Mem& mem);
+void NOP(Cpu& cpu, Mem& mem);
 
 // Stack Operations
-void PHA(Cpu& cpu, i32& cycles, Mem& mem);  // Push Accumulator on Stack
-void PHP(Cpu& cpu, i32& cycles, Mem& mem);  // Push Processor Status on Stack
-void PLA(Cpu& cpu, i32& cycles, Mem& mem);  // Pull Accumulator from Stack
-void PLP(Cpu& cpu, i32& cycles, Mem& mem);  // Pull Processor Status from Stack
-void TSX(Cpu& cpu, i32& cycles, Mem& mem);  // Transfer Stack Pointer to X
-void TXS(Cpu& cpu, i32& cycles, Mem& mem);  // Transfer X to Stack Pointer
+void PHA(Cpu& cpu, Mem& mem);  // Push Accumulator on Stack
+void PHP(Cpu& cpu, Mem& mem);  // Push Processor Status on Stack
+void PLA(Cpu& cpu, Mem& mem);  // Pull Accumulator from Stack
+void PLP(Cpu& cpu, Mem& mem);  // Pull Processor Status from Stack
+void TSX(Cpu& cpu, Mem& mem);  // Transfer Stack Pointer to X
+void TXS(Cpu& cpu, Mem& mem);  // Transfer X to Stack Pointer
+
+// Increment Operations
+void INX(Cpu& cpu, Mem& mem);  // Increment X Register
+
+// Trap for opcodes that are not implemented (cold path)
+[[gnu::cold]] void TRAP(Cpu& cpu, Mem& mem);
 
 }  // namespace instructions
 
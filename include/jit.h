@@ -0,0 +1,90 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstddef>
+
+#include "types.h"
+
+class Cpu;
+class Mem;
+struct Block;
+
+// Emulated state handed to translated code. The native code loads it into
+// host registers on entry and writes it back on every exit.
+struct JitContext {
+    byte* mem;                // Mem::data
+    const byte* slow_stores;  // Mem::slow_stores, checked before every store
+    const byte* slow_loads;   // Mem::slow_loads, checked before every load
+    i32 cycles;               // Remaining cycle budget
+    word pc;                  // Program counter on exit
+    byte a;
+    byte x;
+    byte y;
+    byte sp;
+    byte flags;
+};
+
+// Translated block: returns non-zero when it executed an RTS
+using NativeCode = int (*)(JitContext* ctx);
+
+// Dynamic recompiler from predecoded blocks to x86-64 code (Linux x86-64,
+// CMake option ENABLE_JIT). A/X/Y/SP and the flags stay in host registers
+// for the whole block. Its base cycle cost is charged once on entry and
+// page-crossing penalties as the reads happen.
+// A block ending in a JMP to itself becomes a native loop that only leaves
+// when the budget can no longer cover another iteration.
+//
+// Loads and stores use `Mem::data` directly. Every store checks
+// `Mem::slow_stores` first; a store into a page with cached code, one that
+// dirty tracking or an incremental reset has to see, or one into a page that is
+// not RAM in `data`, leaves the native code before it happens, so the
+// interpreter performs it through `Mem::write`. Every load checks
+// `Mem::slow_loads` the same way, so ROM, I/O, shared pages and bank windows
+// are read by the interpreter while the rest of the block stays native.
+//
+// The arena is mapped read-write and each block's pages are switched to
+// read-execute once its code is copied in, so no page is ever writable and
+// executable at the same time.
+class Jit {
+   public:
+    // Executions after which a block is translated
+    static constexpr u32 HOT_THRESHOLD = 16;
+
+    // Size of the executable code arena
+    static constexpr size_t ARENA_SIZE = 4 * 1024 * 1024;
+
+    Jit() = default;
+    ~Jit();
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    // True when the recompiler is built for this host
+    static bool supported();
+
+    // Outcome of compile()
+    enum class Status {
+        Compiled,
+        Unsupported,  // Instructions the translator does not handle, or no arena
+        Full,         // No room left in the arena; reset() and translate again
+    };
+
+    // Translates `block` and stores the entry point in `block.native`
+    Status compile(Block& block);
+
+    // Runs the native code of `block` and adds its cycles to `cpu.cycle_count`;
+    // the cycles left before `deadline` must cover the whole block and its penalties.
+    // Returns true when the block executed an RTS.
+    static bool run(const Block& block, Cpu& cpu, Mem& mem, u64 deadline);
+
+    // Drops all translated code; every `Block::native` pointing into the arena must be cleared too
+    void reset();
+
+    size_t code_size() const { return used; }
+
+   private:
+    byte* arena = nullptr;
+    size_t used = 0;
+    bool unavailable = false;  // Mapping the arena failed
+};
+
+#endif  // JIT_H
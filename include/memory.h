@@ -2,22 +2,278 @@
 #define MEMORY_H
 
 #include <cstring>
+#include <memory>
 
+#include "access_counters.h"
 #include "types.h"
 
+class BlockCache;
+
+// Receives the reads and writes of pages mapped with Mem::map_io
+class IoHandler {
+   public:
+    virtual ~IoHandler() = default;
+    virtual byte read(word addr) = 0;
+    virtual void write(word addr, byte value) = 0;
+};
+
 class Mem {
    public:
     static constexpr u32 MAX_MEM = 1024 * 64;
+    static constexpr u32 PAGE_SIZE = 256;
+    static constexpr u32 NUM_PAGES = MAX_MEM / PAGE_SIZE;
+
+    // What a page of the address space is mapped to
+    enum class PageType : byte {
+        Ram,     // Host memory, read and written directly
+        Rom,     // Host memory, read directly; writes are dropped
+        Io,      // Every access goes to an IoHandler
+        Shared,  // Read from a snapshot image; the first write copies the page into `data`
+    };
+
+    // The RAM behind every page that has not been mapped elsewhere
     byte data[MAX_MEM];
 
+    // What happens to stores into ROM pages
+    enum class RomWrites : byte {
+        Drop,  // Ignored, like on real hardware
+        Trap,  // Ignored, and counted in rom_write_traps / last_rom_write
+    };
+
+    // How init() clears `data`
+    enum class ResetMode : byte {
+        Full,         // memset of all 64 KiB
+        Incremental,  // Only the pages written since the last init()
+    };
+
+    // Non-zero for every page that holds predecoded code in the block cache
+    byte code_pages[NUM_PAGES] = {};
+
+    // Non-zero for every page whose stores must go through write(): ROM, I/O,
+    // shared and code pages, RAM mapped outside `data` (such as bank windows),
+    // and pages whose next store has to be recorded for dirty tracking or an
+    // incremental init(). Native code checks it before storing.
+    byte slow_stores[NUM_PAGES];
+
+    // Non-zero for every page that is not read from `data` at its own
+    // address: ROM, I/O, shared pages and RAM mapped elsewhere. Native code
+    // reads `data` directly, so it checks this before loading.
+    byte slow_loads[NUM_PAGES];
+
+    // Stores into ROM pages mapped with RomWrites::Trap since the last init(),
+    // and the address of the last one. Reporting them is left to the front end.
+    u32 rom_write_traps = 0;
+    word last_rom_write = 0;
+
+    Mem();
+    ~Mem();
+
+    // Clears `data`. Mappings stay in place, like the wiring of a real machine;
+    // shared pages go back to being RAM.
     void init();
 
+    // Incremental (the default) records the first store to each page after an
+    // init() on the write slow path, so that the next init() only clears those
+    // pages. It relies on every store going through write() or operator[];
+    // writing `data` directly is not seen.
+    void set_reset_mode(ResetMode mode);
+    ResetMode reset_mode() const { return reset; }
+
     // Write a 16-bit word to memory (little-endian)
-    void write_word(i32& cycles, word value, u32 address);
+    void write_word(word value, u32 address);
+
+    // Bulk store for loaders: copies `size` bytes to `addr` one page at a time,
+    // reaching RAM like the non-const operator[] does. Bytes past the end of the
+    // address space are dropped.
+    void load(u32 addr, const byte* bytes, u32 size);
+
+    // Access paths used by the instruction handlers: one page table lookup and a
+    // load or store. ROM, I/O and pages with cached code take the slow path.
+    byte read(u32 addr) const {
+        access_counts.read(addr);
+        return load(addr);
+    }
+    void write(u32 addr, byte value) {
+        access_counts.write(addr);
+        byte* page = pages[addr >> 8].write;
+        if (page) {
+            page[addr & 0xFF] = value;
+            return;
+        }
+        write_slow(addr, value);
+    }
+
+    // Reads an instruction byte; the same as `read` apart from how it is counted
+    byte fetch(u32 addr) const {
+        access_counts.fetch(addr);
+        return load(addr);
+    }
+
+    // Reads an instruction byte for a decoder that caches it. Not counted: the
+    // block engine counts the cached instruction's bytes each time it runs it.
+    byte fetch_uncounted(u32 addr) const { return load(addr); }
+
+    // Reads like `read`, but never calls an I/O handler: I/O pages show the RAM under them
+    byte peek(u32 addr) const {
+        const byte* page = pages[addr >> 8].read;
+        return page ? page[addr & 0xFF] : ram_page(addr >> 8)[addr & 0xFF];
+    }
+
+    // Page mapping. `first_page` and `count` are in 256-byte pages. Mapping drops
+    // any predecoded code on the affected pages. Host memory is not owned and must
+    // hold `count * PAGE_SIZE` bytes for as long as it is mapped; ROM can instead
+    // pass an `owner` that the pages keep alive (see RomImage).
+    void map_ram(byte first_page, u32 count, byte* host);
+    void map_rom(byte first_page, u32 count, const byte* host, RomWrites writes = RomWrites::Drop,
+                 std::shared_ptr<const void> owner = nullptr);
+    void map_io(byte first_page, u32 count, IoHandler& handler);
+
+    // Moves pages already mapped to host RAM or ROM onto another host buffer of
+    // `count * PAGE_SIZE` bytes, as a bank switch does. Only the page table
+    // pointers change; code cached from the pages is dropped. Returns false,
+    // changing nothing, if any page is not mapped to host RAM or ROM.
+    bool repoint(byte first_page, u32 count, byte* host);
+
+    // Maps the pages back onto `data` as RAM
+    void unmap(byte first_page, u32 count);
+    void unmap_all() { unmap(0, NUM_PAGES); }
+
+    // Copy-on-write: every page that is RAM in `data` (or already shared) reads
+    // from the matching page of the MAX_MEM-byte `image` instead, until its first
+    // write copies it into `data`. `owner` keeps the image alive while any page
+    // may still point into it.
+    void map_shared(const byte* image, std::shared_ptr<const void> owner);
+
+    PageType page_type(byte page) const { return mappings[page].type; }
+
+    // True while every page is the RAM in `data`
+    bool flat() const { return remapped_pages == 0; }
+
+    // Dirty-page tracking. While enabled, the first store to a clean page takes
+    // the slow path once, sets the page's bit and bumps its write generation;
+    // later stores to the page cost nothing extra until clear_dirty().
+    // Every store path (Mem::write, write_word and the non-const operator[])
+    // is covered. I/O pages and dropped writes to ROM never become dirty.
+    void track_writes(bool enable);
+    bool tracking_writes() const { return tracking; }
+
+    bool dirty(byte page) const { return (dirty_bits[page >> 6] >> (page & 63)) & 1; }
+    const u64* dirty_bitmap() const { return dirty_bits; }  // NUM_PAGES bits, page 0 in bit 0 of word 0
+    u32 dirty_count() const;
+
+    // Marks every page clean again, so the next store to each is noticed
+    void clear_dirty();
+
+    // Number of times the page went from clean to dirty, so a consumer that
+    // remembers it can tell whether the page changed since it last looked
+    u32 write_generation(byte page) const { return generations[page]; }
+
+    // Flags a page as holding predecoded code, so that stores to it take the
+    // slow path and invalidate the blocks
+    void mark_code_page(byte page) {
+        code_pages[page] = 1;
+        slow_stores[page] = 1;
+        pages[page].write = nullptr;
+    }
+
+    // Undoes mark_code_page once the block cache has no code on the page
+    void clear_code_page(byte page);
+
+    // Drops the predecoded blocks on the page holding `addr` (cold path)
+    void invalidate_code(u32 addr);
+
+    // Records that the host changed the bytes `page` shows without going
+    // through a store, e.g. a bank loaded behind a window: drops code cached
+    // from the page and marks it dirty and touched like a store would
+    void host_wrote(byte page) { prepare_write(page * PAGE_SIZE); }
+
+    // Predecoded basic blocks for this memory, created on first use
+    BlockCache& blocks();
+
+    // Reads, writes and fetches through the paths above, per page or per address
+    // as the CMake option ACCESS_COUNTERS selects (see access_counters.h). Not
+    // cleared by init(); peek, operator[] and native code are not counted.
+    // Every engine counts the same fetches for the same run.
+    mutable access_counters::Policy access_counts;
+
+    // Memory access operators, for loaders, debuggers and tests. They reach RAM
+    // pages wherever they are mapped, and the RAM in `data` underneath ROM and
+    // I/O pages, without calling any handler. The non-const operator hands out
+    // a writable reference, so it conservatively invalidates any predecoded code
+    // on the page.
+    byte operator[](u32 addr) const { return ram_page(addr >> 8)[addr & 0xFF]; }
+    byte& operator[](u32 addr) {
+        if (slow_stores[addr >> 8]) {
+            prepare_write(addr);
+        }
+        return ram_page(addr >> 8)[addr & 0xFF];
+    }
+
+    // The PAGE_SIZE bytes of RAM that operator[] reaches on `page`, for copying
+    // memory out a page at a time
+    const byte* ram_page_data(byte page) const { return ram_page(page); }
+
+   private:
+    // Hot part of the page table, looked up on every access
+    struct Page {
+        const byte* read;  // Host page for reads; nullptr for I/O
+        byte* write;       // Host page for writes; nullptr sends the store to write_slow
+    };
+
+    // Everything else about a page mapping
+    struct Mapping {
+        PageType type = PageType::Ram;
+        IoHandler* io = nullptr;                      // Handler for I/O pages
+        RomWrites rom_writes = RomWrites::Drop;       // Store policy of ROM pages
+        std::shared_ptr<const void> owner = nullptr;  // Keeps shared ROM images alive
+    };
+
+    byte load(u32 addr) const {
+        const byte* page = pages[addr >> 8].read;
+        if (page) {
+            return page[addr & 0xFF];
+        }
+        return read_io(addr);
+    }
+
+    [[gnu::cold]] byte read_io(u32 addr) const;
+    [[gnu::cold]] void write_slow(u32 addr, byte value);
+
+    // Drops code on the page, unshares it and records the store before its RAM changes
+    [[gnu::cold]] void prepare_write(u32 addr);
+
+    void mark_dirty(byte page);
+
+    bool touched(byte page) const { return (touched_bits[page >> 6] >> (page & 63)) & 1; }
+    void mark_touched(byte page);
+
+    // Copies a shared page into `data` and maps it as RAM
+    void unshare(byte page);
+
+    // Stores go straight to RAM pages without code once every store that has
+    // to be recorded has been
+    void update_write_pointer(byte page);
+
+
+    // Installs one page's mapping and drops code cached on it
+    void map(byte page, const Mapping& mapping, const byte* read, byte* ram);
+
+    // RAM seen by operator[]: the mapped host page, or `data` under ROM and I/O.
+    // For shared pages it is the snapshot image, which is never written through
+    // it because every write path unshares the page first.
+    byte* ram_page(u32 page) const { return ram_pages[page]; }
 
-    // Memory access operators
-    byte operator[](u32 addr) const;
-    byte& operator[](u32 addr);
+    Page pages[NUM_PAGES];
+    byte* ram_pages[NUM_PAGES];
+    Mapping mappings[NUM_PAGES];
+    u32 remapped_pages = 0;
+    bool tracking = false;
+    u64 dirty_bits[NUM_PAGES / 64] = {};
+    u32 generations[NUM_PAGES] = {};
+    ResetMode reset = ResetMode::Incremental;
+    u64 touched_bits[NUM_PAGES / 64];  // Pages written since the last init()
+    std::shared_ptr<const void> shared_image;  // Keeps the pages of map_shared alive
+    std::unique_ptr<BlockCache> code_cache;
 };
 
 #endif  // MEMORY_H
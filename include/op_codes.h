@@ -7,6 +7,22 @@
 
 enum class Register : byte { A = 0, X = 1, Y = 2 };
 
+// Addressing modes, used by the opcode table to describe how an
+// instruction decodes its operand bytes
+enum class AddrMode : byte {
+    IMP,   // Implied / accumulator (no operand)
+    IMM,   // Immediate (#$nn)
+    ZP,    // Zero Page ($nn)
+    ZPX,   // Zero Page,X ($nn,X)
+    ZPY,   // Zero Page,Y ($nn,Y)
+    ABS,   // Absolute ($nnnn)
+    ABSX,  // Absolute,X ($nnnn,X)
+    ABSY,  // Absolute,Y ($nnnn,Y)
+    IND,   // Indirect (($nnnn)), JMP only
+    INDX,  // (Indirect,X) (($nn,X))
+    INDY,  // (Indirect),Y (($nn),Y)
+};
+
 enum class Op : byte {
     BRK = 0x00,       // Force Interrupt (Break)
     NOP = 0xEA,       // No Operation
@@ -62,6 +78,9 @@ enum class Op : byte {
     TSX = 0xBA,  // Transfer Stack Pointer to X
     TXS = 0x9A,  // Transfer X to Stack Pointer
     // -----------------------------------------------
+    // Increment Operations
+    INX = 0xE8,  // Increment X Register
+    // -----------------------------------------------
 };
 
 // Helper function to convert from Op enum to byte
@@ -0,0 +1,53 @@
+#ifndef OPERATIONS_H
+#define OPERATIONS_H
+
+#include "addressing.h"
+#include "cpu.h"
+#include "cycles.h"
+#include "memory.h"
+#include "types.h"
+
+namespace instructions {
+
+// LDA, LDX and LDY for one addressing mode
+template <Register R, typename Mode>
+struct Load {
+    // Runs the instruction with its operand already fetched
+    static void apply(Cpu& cpu, Mem& mem, word operand) {
+        byte value;
+        if constexpr (Mode::mode == AddrMode::IMM) {
+            value = static_cast<byte>(operand);
+        } else {
+            addressing::Target target = Mode::resolve(cpu, mem, operand);
+            if constexpr (Mode::page_cross) {
+                cpu.cycle_count += page_cross_cycles(target.base, target.addr);
+            }
+            value = mem.read(target.addr);
+        }
+        cpu.set(R, value);
+        cpu.set_nz(value);  // Set the Zero and Negative flags
+    }
+
+    // Opcode handler: fetches the operand at PC, then runs the instruction
+    static void execute(Cpu& cpu, Mem& mem) { apply(cpu, mem, Mode::fetch(cpu, mem)); }
+};
+
+// STA, STX and STY for one addressing mode. Stores have no page-crossing
+// penalty; their indexed forms always take the extra cycle, which is part of
+// the base cycles in the opcode table.
+template <Register R, typename Mode>
+struct Store {
+    static_assert(Mode::mode != AddrMode::IMM, "Stores need an address");
+
+    // Runs the instruction with its operand already fetched
+    static void apply(Cpu& cpu, Mem& mem, word operand) {
+        mem.write(Mode::resolve(cpu, mem, operand).addr, cpu.get(R));
+    }
+
+    // Opcode handler: fetches the operand at PC, then runs the instruction
+    static void execute(Cpu& cpu, Mem& mem) { apply(cpu, mem, Mode::fetch(cpu, mem)); }
+};
+
+}  // namespace instructions
+
+#endif  // OPERATIONS_H
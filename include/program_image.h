@@ -0,0 +1,77 @@
+#ifndef PROGRAM_IMAGE_H
+#define PROGRAM_IMAGE_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "types.h"
+
+// Non-owning view of contiguous elements, a stand-in for C++20's std::span.
+// Built from a pointer and a count, a built-in array or any container with
+// data() and size(), such as std::vector and std::array.
+template <typename T>
+class Span {
+   public:
+    constexpr Span() = default;
+    constexpr Span(T* data, size_t size) : ptr(data), count(size) {}
+
+    template <size_t N>
+    constexpr Span(T (&array)[N]) : ptr(array), count(N) {}
+
+    template <typename Container,
+              typename = std::enable_if_t<!std::is_same_v<std::remove_const_t<Container>, Span> &&
+                                          std::is_convertible_v<decltype(std::declval<Container&>().data()), T*>>>
+    constexpr Span(Container& container) : ptr(container.data()), count(container.size()) {}
+
+    constexpr T* data() const { return ptr; }
+    constexpr size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr T* begin() const { return ptr; }
+    constexpr T* end() const { return ptr + count; }
+    constexpr T& operator[](size_t i) const { return ptr[i]; }
+
+   private:
+    T* ptr = nullptr;
+    size_t count = 0;
+};
+
+// A program as a list of (address, bytes) segments, loaded in order with one
+// Mem::load each. The image owns nothing: it views segment tables and bytes
+// that outlive it, usually static arrays, so building one is constexpr and
+// loading it never allocates.
+//
+//     constexpr byte CODE[] = {op(Op::LDA_IM), 0x42, op(Op::RTS)};
+//     constexpr ProgramImage::Segment SEGMENTS[] = {{0x2000, CODE}};
+//     constexpr ProgramImage PROGRAM(SEGMENTS);
+class ProgramImage {
+   public:
+    struct Segment {
+        u32 address;
+        Span<const byte> bytes;
+    };
+
+    constexpr ProgramImage() = default;
+    constexpr ProgramImage(Span<const Segment> segments) : list(segments) {}
+
+    template <size_t N>
+    constexpr ProgramImage(const Segment (&segments)[N]) : list(segments) {}
+
+    constexpr const Segment* begin() const { return list.begin(); }
+    constexpr const Segment* end() const { return list.end(); }
+    constexpr size_t size() const { return list.size(); }
+
+    // Total bytes over all segments
+    constexpr size_t byte_count() const {
+        size_t total = 0;
+        for (const Segment& segment : list) {
+            total += segment.bytes.size();
+        }
+        return total;
+    }
+
+   private:
+    Span<const Segment> list;
+};
+
+#endif  // PROGRAM_IMAGE_H
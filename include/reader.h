@@ -1,33 +1,137 @@
 #ifndef READER_H
 #define READER_H
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "cpu.h"
 #include "memory.h"
+#include "program_image.h"
 #include "types.h"
 
+class BankedMemory;
+
 namespace binary_reader {
+
+// Why a text-format or object load stopped
+enum class LoadError : byte {
+    None,
+    File,        // The file could not be read, or is empty
+    Syntax,      // Malformed or unsupported record
+    Checksum,    // The record's checksum does not match its bytes
+    Range,       // Data or entry point outside the address space
+    Unresolved,  // An o65 object imports a symbol that was not provided
+};
+
+struct LoadResult {
+    LoadError error = LoadError::None;
+    u32 line = 0;  // 1-based line of the record that failed
+
+    bool ok() const { return error == LoadError::None; }
+};
+
+// Global symbols by name, as exported by one o65 module and imported by the next
+using Symbols = std::map<std::string, u32>;
+
+// Where the segments of an o65 object go. Only the text base is required;
+// by default data follows text, bss follows data and the zero page segment
+// stays where it was assembled.
+struct O65Placement {
+    static constexpr u32 NEXT = 0xFFFFFFFF;       // Right after the previous segment
+    static constexpr u32 ASSEMBLED = 0xFFFFFFFE;  // The base in the object header
+
+    u32 text = 0;
+    u32 data = NEXT;
+    u32 bss = NEXT;
+    u32 zero = ASSEMBLED;
+};
+
+// One o65 object after relocation
+struct O65Module {
+    LoadError error = LoadError::None;
+    u32 text = 0;  // Final segment bases and sizes
+    u32 text_size = 0;
+    u32 data = 0;
+    u32 data_size = 0;
+    u32 bss = 0;
+    u32 bss_size = 0;
+    u32 zero = 0;
+    u32 zero_size = 0;
+    Symbols exports;  // Relocated global symbols
+
+    bool ok() const { return error == LoadError::None; }
+    // First byte past the module's text, data and bss
+    u32 end() const { return std::max({text + text_size, data + data_size, bss + bss_size}); }
+};
+
 // This function reads the binary
 // translated version of the C-64 assembly
 // into the CPU memory
 //
+// Every segment of `image` is stored with one Mem::load, in order; nothing
+// is allocated or copied besides the bytes themselves, so reloading the
+// same image is cheap. The map overload suits programs built at run time.
+//
 // Parameters:
-// - `const std::vector<byte> data` - The byte array for the hex encoded binary
-// - `const u32 m_offset` - The starting address from where this method would start
-//                           writing the data into the memory
-void read_from_array(Cpu& cpu, Mem& mem, const std::map<u32, std::vector<byte>> data);
+// - `const ProgramImage& image` - The segments and the addresses they load at
+void read_from_array(Cpu& cpu, Mem& mem, const ProgramImage& image);
+void read_from_array(Cpu& cpu, Mem& mem, const std::map<u32, std::vector<byte>>& data);
 
 // This function reaad the binary from
 // pre compiled file which was translated from the C-64 assembly
 //
+// The file is mmap'd and copied into memory with one bulk store per page
+// (Mem::load). Images that should stay read-only and be shared between
+// instances are better mapped in place with RomImage::from_file.
+//
 // Parameters:
 // - `const std::string& file_path` - The file path for the binary
 // - `const u32 m_offset` - The starting address from where this method would start
 //                           writing the data into the memory
-void read_from_binary_file(Cpu& cpu, Mem& mem, const std::string& file_path, const u32 m_offset);
+//
+// Returns false, leaving memory untouched, if the file cannot be read, is
+// empty, or does not fit between `m_offset` and Mem::MAX_MEM.
+bool read_from_binary_file(Cpu& cpu, Mem& mem, const std::string& file_path, const u32 m_offset);
+
+// Same for images larger than the address space: copies the file into the
+// backing store of `banked`, starting at bank `first_bank` and filling
+// consecutive banks. Returns false if the file cannot be read, is empty, or
+// runs past the last bank.
+bool read_from_binary_file(BankedMemory& banked, const std::string& file_path, const u32 first_bank = 0);
+
+// Intel HEX (data, EOF, extended segment/linear address and start address
+// records) and Motorola S-records (S0-S3, S5-S9). The text is decoded in one
+// pass and each data record is stored with Mem::load as soon as its checksum
+// has been verified, so records before a bad one stay loaded. A start address
+// record sets `cpu.PC`. Line endings may be LF or CRLF; blank lines are skipped.
+LoadResult read_from_intel_hex(Cpu& cpu, Mem& mem, const std::string& file_path);
+LoadResult read_from_intel_hex(Cpu& cpu, Mem& mem, const char* text, size_t size);
+LoadResult read_from_srec(Cpu& cpu, Mem& mem, const std::string& file_path);
+LoadResult read_from_srec(Cpu& cpu, Mem& mem, const char* text, size_t size);
+
+// Commodore PRG: a little-endian load address followed by the image, copied
+// with Mem::load. The PC is left alone; C-64 programs usually start through a
+// BASIC stub. Returns false, leaving memory untouched, if the file is shorter
+// than three bytes or does not fit below Mem::MAX_MEM. `load_address`, when
+// given, receives the address from the header.
+bool read_from_prg(Cpu& cpu, Mem& mem, const std::string& file_path, word* load_address = nullptr);
+bool read_from_prg(Cpu& cpu, Mem& mem, const byte* data, size_t size, word* load_address = nullptr);
+
+// Relocatable o65 object (6502 mode, 16- or 32-bit header fields, byte- or
+// page-wise relocation). Text and data are copied into one scratch image,
+// relocated there table by table with one offset per segment, and stored
+// with a single Mem::load per segment, so memory is untouched if a
+// relocation entry is bad. Undefined references are resolved from `imports`;
+// the module's own globals come back relocated in O65Module::exports and can
+// be passed on as the imports of the next module. Bss is cleared when the
+// object asks for it. Chained objects and 65816 relocation types are
+// rejected as Syntax.
+O65Module read_from_o65(Cpu& cpu, Mem& mem, const std::string& file_path, const O65Placement& placement,
+                        const Symbols& imports = {});
+O65Module read_from_o65(Cpu& cpu, Mem& mem, const byte* data, size_t size, const O65Placement& placement,
+                        const Symbols& imports = {});
 }  // namespace binary_reader
 
 #endif  // READER_H
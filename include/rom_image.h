@@ -0,0 +1,46 @@
+#ifndef ROM_IMAGE_H
+#define ROM_IMAGE_H
+
+#include <memory>
+#include <string>
+
+#include "memory.h"
+#include "types.h"
+
+// Read-only bytes shared by any number of Mem instances, e.g. a system ROM or
+// a program that hundreds of emulator instances run. Files are mmap'd where the
+// platform allows it, so instances in different processes share the page cache
+// too. Mapped pages read the image in place and keep it alive; nothing is
+// copied per instance.
+class RomImage : public std::enable_shared_from_this<RomImage> {
+   public:
+    ~RomImage();
+
+    RomImage(const RomImage&) = delete;
+    RomImage& operator=(const RomImage&) = delete;
+
+    // Returns nullptr if the file cannot be opened or read, or is empty
+    static std::shared_ptr<const RomImage> from_file(const std::string& path);
+
+    // Copies `bytes` once into a new image
+    static std::shared_ptr<const RomImage> from_bytes(const byte* bytes, size_t size);
+
+    const byte* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Whole 256-byte pages covered by the image; a partial last page reads as zero
+    u32 pages() const { return static_cast<u32>((length + Mem::PAGE_SIZE - 1) / Mem::PAGE_SIZE); }
+
+    // Maps the image read-only at the page-aligned `base`, cut off at the end of
+    // the address space. The pages keep the image alive until they are remapped.
+    void map(Mem& mem, word base, Mem::RomWrites writes = Mem::RomWrites::Drop) const;
+
+   private:
+    RomImage() = default;
+
+    const byte* bytes = nullptr;
+    size_t length = 0;
+    size_t mapped_length = 0;  // Non-zero when `bytes` is an mmap of that many bytes
+};
+
+#endif  // ROM_IMAGE_H
@@ -0,0 +1,77 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <memory>
+#include <vector>
+
+#include "cpu.h"
+#include "memory.h"
+#include "types.h"
+
+// A CPU with its own memory, e.g. one child forked from a snapshot
+struct Machine {
+    // User-provided so that `new Machine()` does not zero the 64 KiB of memory
+    Machine() {}
+
+    Cpu cpu;
+    Mem mem;
+    StopReason reason = StopReason::CyclesExhausted;
+
+    u64 run(u64 cycles) { return cpu.run(cycles, mem, reason); }
+};
+
+// Immutable copy of the CPU registers and the RAM of a machine. Restoring or
+// forking does not copy memory: the target's RAM pages are mapped
+// copy-on-write onto the snapshot (Mem::map_shared), and each page is copied
+// only when it is first written.
+//
+// The image is the machine's own RAM, `Mem::data`, read through any pages
+// still shared with an earlier snapshot. Pages mapped elsewhere (host RAM
+// such as bank windows, ROM, I/O) belong to the machine's wiring: the image
+// holds the RAM underneath them, not what they show, and restoring leaves
+// such pages of the target mapped as they are.
+//
+// Taking a snapshot copies 64 KiB once; any number of machines can then share it.
+class Snapshot {
+   public:
+    Snapshot(const Cpu& cpu, const Mem& mem);
+
+    // Puts `cpu` and `mem` back into the captured state
+    void restore(Cpu& cpu, Mem& mem) const;
+
+    // New machines in the captured state, sharing its memory
+    std::vector<std::unique_ptr<Machine>> fork(u32 count) const;
+
+    // Forks `count` children, lets `setup(i, machine)` vary each one, e.g. by
+    // poking a few input bytes, then runs every child for `cycles` cycles
+    template <typename Setup>
+    std::vector<std::unique_ptr<Machine>> run_forks(u32 count, u64 cycles, Setup setup) const {
+        std::vector<std::unique_ptr<Machine>> children = fork(count);
+        for (u32 i = 0; i < count; ++i) {
+            setup(i, *children[i]);
+            children[i]->run(cycles);
+        }
+        return children;
+    }
+
+    word pc() const { return regs.state.PC; }
+    u64 cycles() const { return regs.cycle_count; }
+
+   private:
+    struct Registers {
+        CpuState state;
+        Engine engine;
+        u64 cycle_count;
+        u32 invalid_opcodes;
+        word last_invalid_pc;
+    };
+
+    struct Image {
+        byte memory[Mem::MAX_MEM];
+    };
+
+    Registers regs;
+    std::shared_ptr<const Image> image;
+};
+
+#endif  // SNAPSHOT_H
@@ -69,6 +69,11 @@ void inline_pla_test(Cpu& cpu, Mem& mem);
 void inline_plp_test(Cpu& cpu, Mem& mem);
 void inline_tsx_test(Cpu& cpu, Mem& mem);
 void inline_txs_test(Cpu& cpu, Mem& mem);
+void inline_stack_wrap_test(Cpu& cpu, Mem& mem);
+
+// INX Tests
+void inline_inx_test(Cpu& cpu, Mem& mem);
+void inline_inx_wrap_test(Cpu& cpu, Mem& mem);
 
 // Invalid Opcode Test
 void inline_invalid_opcode_test(Cpu& cpu, Mem& mem);
@@ -80,6 +85,102 @@ void sty_test_suite(Cpu& cpu, Mem& mem);
 
 bool run_all_tests(Cpu& cpu, Mem& mem);
 
+// Execution Engine Tests
+void inline_threaded_engine_test(Cpu& cpu, Mem& mem);
+void inline_threaded_engine_budget_test(Cpu& cpu, Mem& mem);
+void inline_block_engine_test(Cpu& cpu, Mem& mem);
+void inline_block_engine_budget_test(Cpu& cpu, Mem& mem);
+void inline_pins_engine_test(Cpu& cpu, Mem& mem);
+void inline_headless_run_test(Cpu& cpu, Mem& mem);
+void inline_headless_invalid_opcode_test(Cpu& cpu, Mem& mem);
+int engine_test_suite(Cpu& cpu, Mem& mem);
+
+// Block Cache Tests
+void inline_block_cache_self_modifying_test(Cpu& cpu, Mem& mem);
+void inline_block_cache_external_write_test(Cpu& cpu, Mem& mem);
+void inline_block_cache_reset_test(Cpu& cpu, Mem& mem);
+void inline_block_cache_fused_loop_test(Cpu& cpu, Mem& mem);
+void inline_block_cache_fused_pairs_test(Cpu& cpu, Mem& mem);
+void inline_block_cache_leaf_call_test(Cpu& cpu, Mem& mem);
+int block_cache_test_suite(Cpu& cpu, Mem& mem);
+
+// JIT Tests
+void inline_jit_counter_loop_test(Cpu& cpu, Mem& mem);
+void inline_jit_addressing_modes_test(Cpu& cpu, Mem& mem);
+void inline_jit_code_page_store_test(Cpu& cpu, Mem& mem);
+void inline_jit_subroutine_test(Cpu& cpu, Mem& mem);
+void inline_jit_page_cross_test(Cpu& cpu, Mem& mem);
+void inline_jit_arena_refill_test(Cpu& cpu, Mem& mem);
+int jit_test_suite(Cpu& cpu, Mem& mem);
+
+// Cycle Accounting Tests
+void inline_base_cycles_test(Cpu& cpu, Mem& mem);
+void inline_page_cross_penalty_test(Cpu& cpu, Mem& mem);
+void inline_64bit_cycle_counter_test(Cpu& cpu, Mem& mem);
+int cycles_test_suite(Cpu& cpu, Mem& mem);
+
+// Pin-Level Bus Engine Tests
+void inline_bus_cycle_count_test(Cpu& cpu, Mem& mem);
+void inline_bus_indexed_read_test(Cpu& cpu, Mem& mem);
+void inline_bus_write_test(Cpu& cpu, Mem& mem);
+void inline_bus_stepped_access_test(Cpu& cpu, Mem& mem);
+void inline_fast_engine_pins_test(Cpu& cpu, Mem& mem);
+int bus_test_suite(Cpu& cpu, Mem& mem);
+
+// Memory Map Tests
+void inline_memory_map_rom_test(Cpu& cpu, Mem& mem);
+void inline_memory_map_io_test(Cpu& cpu, Mem& mem);
+void inline_memory_map_ram_test(Cpu& cpu, Mem& mem);
+void inline_memory_map_code_page_test(Cpu& cpu, Mem& mem);
+void inline_dirty_page_test(Cpu& cpu, Mem& mem);
+void inline_dirty_code_page_test(Cpu& cpu, Mem& mem);
+void inline_incremental_reset_test(Cpu& cpu, Mem& mem);
+void inline_access_counters_test(Cpu& cpu, Mem& mem);
+void inline_access_counters_engines_test(Cpu& cpu, Mem& mem);
+int memory_map_test_suite(Cpu& cpu, Mem& mem);
+
+// MMIO Device Tests
+void inline_console_output_test(Cpu& cpu, Mem& mem);
+void inline_cycle_counter_test(Cpu& cpu, Mem& mem);
+void inline_batched_tick_test(Cpu& cpu, Mem& mem);
+void inline_device_unmap_test(Cpu& cpu, Mem& mem);
+int device_test_suite(Cpu& cpu, Mem& mem);
+
+// Snapshot Tests
+void inline_snapshot_restore_test(Cpu& cpu, Mem& mem);
+void inline_snapshot_fork_test(Cpu& cpu, Mem& mem);
+void inline_snapshot_code_page_test(Cpu& cpu, Mem& mem);
+void inline_snapshot_bank_window_test(Cpu& cpu, Mem& mem);
+void inline_cpu_state_test(Cpu& cpu, Mem& mem);
+int snapshot_test_suite(Cpu& cpu, Mem& mem);
+
+// Bank Switching Tests
+void inline_bank_select_test(Cpu& cpu, Mem& mem);
+void inline_bank_register_test(Cpu& cpu, Mem& mem);
+void inline_bank_code_test(Cpu& cpu, Mem& mem);
+void inline_bank_direct_registers_test(Cpu& cpu, Mem& mem);
+void inline_bank_window_checks_test(Cpu& cpu, Mem& mem);
+int banking_test_suite(Cpu& cpu, Mem& mem);
+
+// Shared ROM Image Tests
+void inline_rom_image_shared_test(Cpu& cpu, Mem& mem);
+void inline_rom_image_file_test(Cpu& cpu, Mem& mem);
+void inline_rom_image_trap_test(Cpu& cpu, Mem& mem);
+int rom_image_test_suite(Cpu& cpu, Mem& mem);
+
+// Program Loader Tests
+void inline_binary_file_test(Cpu& cpu, Mem& mem);
+void inline_banked_file_test(Cpu& cpu, Mem& mem);
+void inline_banked_file_selected_test(Cpu& cpu, Mem& mem);
+void inline_intel_hex_test(Cpu& cpu, Mem& mem);
+void inline_srec_test(Cpu& cpu, Mem& mem);
+void inline_prg_test(Cpu& cpu, Mem& mem);
+void inline_o65_test(Cpu& cpu, Mem& mem);
+void inline_program_image_test(Cpu& cpu, Mem& mem);
+void inline_bundle_test(Cpu& cpu, Mem& mem);
+void inline_bundle_records_test(Cpu& cpu, Mem& mem);
+int loader_test_suite(Cpu& cpu, Mem& mem);
+
 // Test suite functions
 void jmp_test_suite(Cpu& cpu, Mem& mem);
 void stack_operations_test_suite(Cpu& cpu, Mem& mem);
@@ -8,11 +8,15 @@
 #include <string>
 #include <vector>
 
+#include "colors.h"
 #include "cpu.h"
 #include "types.h"
 
 namespace testing {
 
+// Every execution engine, for tests that check all of them behave the same
+inline constexpr Engine ENGINES[] = {Engine::Table, Engine::Threaded, Engine::Block, Engine::Jit, Engine::Pins};
+
 // Custom exception for test failures
 class TestFailedException : public std::exception {
    private:
@@ -124,6 +128,8 @@ class TestSuite {
 
 // Utility function to print colorful CPU register state
 inline void print_cpu_state(Cpu& cpu) {
+    cpu.sync_flags();
+
     std::cout << colors::CYAN << colors::BOLD << "CPU STATE:" << colors::RESET << std::endl;
 
     // Print registers
@@ -1,292 +1,308 @@
-#include <map>
-#include <vector>
+#include "demo_programs.h"
 
 #include "op_codes.h"
 #include "types.h"
 
 namespace demo_programs {
 
-// This function returns a demo program that showcases LDA instructions
-// with various addressing modes
-std::map<u32, std::vector<byte>> get_lda_demo() {
-    std::map<u32, std::vector<byte>> demo = {
-        // Program entry point (JSR to main routine)
-        {0xFFFC, {op(Op::JSR), 0x00, 0x20}},
-
-        // Main routine at 0x2000
-        // Test LDA instructions with various addressing modes
-        {0x2000,
-         {// LDA Immediate
-          op(Op::LDA_IM), 0x42,
-
-          // LDA Zero Page
-          op(Op::LDA_ZP), 0x80,
-
-          // LDA Zero Page,X
-          op(Op::LDA_ZPX), 0x70,
-
-          // LDA Absolute
-          op(Op::LDA_AB), 0x00, 0x30,
-
-          // LDA Absolute,X
-          op(Op::LDA_ABSX), 0x10, 0x30,
-
-          // LDA Absolute,Y
-          op(Op::LDA_ABSY), 0x20, 0x30,
-
-          // Test indirect addressing modes
-          // LDA (Indirect,X)
-          op(Op::LDA_INX), 0x90,
-
-          // LDA (Indirect),Y
-          op(Op::LDA_INY), 0x92,
-
-          // Return from the main program
-          op(Op::RTS)}},
-        // Subroutine at 0x2080
-
-        // Subroutine at 0x2050
-        {0x2050,
-         {// Do something in the subroutine
-          op(Op::LDA_IM), 0xFF,
-          // Return from subroutine
-          op(Op::RTS)}},
-
-        // Data for various addressing modes
-        {0x0080, {0x55}},  // Zero page data for LDA_ZP
-        {0x0070, {0x00}},  // Base for Zero page,X
-        {0x0075, {0x66}},  // Zero page,X data (0x70+X where X=5)
-        {0x3000, {0x77}},  // Absolute data for LDA_AB
-        {0x3015, {0x88}},  // Absolute,X data (0x3010+X where X=5)
-        {0x3022, {0x99}},  // Absolute,Y data (0x3020+Y where Y=2)
-
-        // Indirect addressing data
-        {0x0090, {0x00}},        // Zero page for indirect X
-        {0x0095, {0x00, 0x40}},  // Indirect address pointer after X offset (0x90+X where X=5)
-        {0x4000, {0xAA}},        // Target for Indirect,X
-
-        {0x0092, {0x30, 0x40}},  // Zero page for indirect Y
-        {0x4032, {0xBB}},        // Target for Indirect,Y (0x4030+Y where Y=2)
-    };
-
-    return demo;
-}
-
-// This function returns a demo program that showcases LDX instructions
-// with various addressing modes
-std::map<u32, std::vector<byte>> get_ldx_demo() {
-    std::map<u32, std::vector<byte>> demo = {
-        // Program entry point (JSR to main routine)
-        {0xFFFC, {op(Op::JSR), 0x00, 0x20}},
-
-        // Main routine at 0x2000
-        {0x2000,
-         {// LDX Immediate
-          op(Op::LDX_IM), 0xAA,
+namespace {
+
+// Program entry point (JSR to main routine at 0x2000)
+constexpr byte ENTRY[] = {op(Op::JSR), 0x00, 0x20};
+
+// Subroutine at 0x2050
+constexpr byte SUBROUTINE[] = {
+    // Do something in the subroutine
+    op(Op::LDA_IM), 0xFF,
+    // Return from subroutine
+    op(Op::RTS),
+};
+
+// Data for the LDA addressing modes
+constexpr byte LDA_ZP_DATA[] = {0x55};     // Zero page data for LDA_ZP
+constexpr byte ZPX_BASE[] = {0x00};        // Base for Zero page,X
+constexpr byte LDA_ZPX_DATA[] = {0x66};    // Zero page,X data (0x70+X where X=5)
+constexpr byte LDA_AB_DATA[] = {0x77};     // Absolute data for LDA_AB
+constexpr byte LDA_ABSX_DATA[] = {0x88};   // Absolute,X data (0x3010+X where X=5)
+constexpr byte LDA_ABSY_DATA[] = {0x99};   // Absolute,Y data (0x3020+Y where Y=2)
+
+// Indirect addressing data
+constexpr byte INX_BASE[] = {0x00};            // Zero page for indirect X
+constexpr byte INX_POINTER[] = {0x00, 0x40};   // Indirect address pointer after X offset (0x90+X where X=5)
+constexpr byte INX_TARGET[] = {0xAA};          // Target for Indirect,X
+constexpr byte INY_POINTER[] = {0x30, 0x40};   // Zero page for indirect Y
+constexpr byte INY_TARGET[] = {0xBB};          // Target for Indirect,Y (0x4030+Y where Y=2)
+
+// Data for the LDX addressing modes
+constexpr byte LDX_ZP_DATA[] = {0xCC};    // Zero page data for LDX_ZP
+constexpr byte LDX_ZPY_DATA[] = {0xDD};   // Zero page,Y data (0xA5+Y where Y=2)
+constexpr byte LDX_AB_DATA[] = {0xEE};    // Absolute data for LDX_AB
+constexpr byte LDX_ABSY_DATA[] = {0xFF};  // Absolute,Y data (0x3060+Y where Y=2)
+
+// Data for the LDY addressing modes
+constexpr byte LDY_ZP_DATA[] = {0x11};    // Zero page data for LDY_ZP
+constexpr byte LDY_ZPX_DATA[] = {0x22};   // Zero page,X data (0xB5+X where X=5)
+constexpr byte LDY_AB_DATA[] = {0x33};    // Absolute data for LDY_AB
+constexpr byte LDY_ABSX_DATA[] = {0x44};  // Absolute,X data (0x3080+X where X=5)
+
+// Main routine of the LDA demo at 0x2000
+// Test LDA instructions with various addressing modes
+constexpr byte LDA_MAIN[] = {
+    // LDA Immediate
+    op(Op::LDA_IM), 0x42,
+
+    // LDA Zero Page
+    op(Op::LDA_ZP), 0x80,
+
+    // LDA Zero Page,X
+    op(Op::LDA_ZPX), 0x70,
+
+    // LDA Absolute
+    op(Op::LDA_AB), 0x00, 0x30,
+
+    // LDA Absolute,X
+    op(Op::LDA_ABSX), 0x10, 0x30,
+
+    // LDA Absolute,Y
+    op(Op::LDA_ABSY), 0x20, 0x30,
+
+    // Test indirect addressing modes
+    // LDA (Indirect,X)
+    op(Op::LDA_INX), 0x90,
+
+    // LDA (Indirect),Y
+    op(Op::LDA_INY), 0x92,
+
+    // Return from the main program
+    op(Op::RTS),
+};
+
+constexpr ProgramImage::Segment LDA_DEMO[] = {
+    {0xFFFC, ENTRY},
+    {0x2000, LDA_MAIN},
+    {0x2050, SUBROUTINE},
+
+    {0x0080, LDA_ZP_DATA},
+    {0x0070, ZPX_BASE},
+    {0x0075, LDA_ZPX_DATA},
+    {0x3000, LDA_AB_DATA},
+    {0x3015, LDA_ABSX_DATA},
+    {0x3022, LDA_ABSY_DATA},
+
+    {0x0090, INX_BASE},
+    {0x0095, INX_POINTER},
+    {0x4000, INX_TARGET},
+    {0x0092, INY_POINTER},
+    {0x4032, INY_TARGET},
+};
+
+// Main routine of the LDX demo at 0x2000
+constexpr byte LDX_MAIN[] = {
+    // LDX Immediate
+    op(Op::LDX_IM), 0xAA,
 
-          // LDX Zero Page
-          op(Op::LDX_ZP), 0xA0,
+    // LDX Zero Page
+    op(Op::LDX_ZP), 0xA0,
 
-          // LDX Zero Page,Y
-          op(Op::LDX_ZPY), 0xA5,
+    // LDX Zero Page,Y
+    op(Op::LDX_ZPY), 0xA5,
+
+    // LDX Absolute
+    op(Op::LDX_AB), 0x50, 0x30,
+
+    // LDX Absolute,Y
+    op(Op::LDX_ABSY), 0x60, 0x30,
+
+    // Return from the main program
+    op(Op::RTS),
+};
 
-          // LDX Absolute
-          op(Op::LDX_AB), 0x50, 0x30,
+constexpr ProgramImage::Segment LDX_DEMO[] = {
+    {0xFFFC, ENTRY},
+    {0x2000, LDX_MAIN},
 
-          // LDX Absolute,Y
-          op(Op::LDX_ABSY), 0x60, 0x30,
+    {0x00A0, LDX_ZP_DATA},
+    {0x00A7, LDX_ZPY_DATA},
+    {0x3050, LDX_AB_DATA},
+    {0x3062, LDX_ABSY_DATA},
+};
 
-          // Return from the main program
-          op(Op::RTS)}},
+// Main routine of the LDY demo at 0x2000
+constexpr byte LDY_MAIN[] = {
+    // LDY Immediate
+    op(Op::LDY_IM), 0xBB,
 
-        // Data for various addressing modes
-        {0x00A0, {0xCC}},  // Zero page data for LDX_ZP
-        {0x00A7, {0xDD}},  // Zero page,Y data (0xA5+Y where Y=2)
-        {0x3050, {0xEE}},  // Absolute data for LDX_AB
-        {0x3062, {0xFF}},  // Absolute,Y data (0x3060+Y where Y=2)
-    };
+    // LDY Zero Page
+    op(Op::LDY_ZP), 0xB0,
 
-    return demo;
-}
+    // LDY Zero Page,X
+    op(Op::LDY_ZPX), 0xB5,
 
-// This function returns a demo program that showcases LDY instructions
-// with various addressing modes
-std::map<u32, std::vector<byte>> get_ldy_demo() {
-    std::map<u32, std::vector<byte>> demo = {
-        // Program entry point (JSR to main routine)
-        {0xFFFC, {op(Op::JSR), 0x00, 0x20}},
+    // LDY Absolute
+    op(Op::LDY_AB), 0x70, 0x30,
 
-        // Main routine at 0x2000
-        {0x2000,
-         {// LDY Immediate
-          op(Op::LDY_IM), 0xBB,
+    // LDY Absolute,X
+    op(Op::LDY_ABSX), 0x80, 0x30,
 
-          // LDY Zero Page
-          op(Op::LDY_ZP), 0xB0,
+    // Return from the main program
+    op(Op::RTS),
+};
 
-          // LDY Zero Page,X
-          op(Op::LDY_ZPX), 0xB5,
+constexpr ProgramImage::Segment LDY_DEMO[] = {
+    {0xFFFC, ENTRY},
+    {0x2000, LDY_MAIN},
 
-          // LDY Absolute
-          op(Op::LDY_AB), 0x70, 0x30,
+    {0x00B0, LDY_ZP_DATA},
+    {0x00BA, LDY_ZPX_DATA},
+    {0x3070, LDY_AB_DATA},
+    {0x3085, LDY_ABSX_DATA},
+};
 
-          // LDY Absolute,X
-          op(Op::LDY_ABSX), 0x80, 0x30,
+// Main routine of the combined demo at 0x2000
+// Test LDA instructions with various addressing modes
+constexpr byte INSTRUCTION_MAIN[] = {
+    // LDA Immediate
+    op(Op::LDA_IM), 0x42,
 
-          // Return from the main program
-          op(Op::RTS)}},
+    // LDA Zero Page
+    op(Op::LDA_ZP), 0x80,
 
-        // Data for various addressing modes
-        {0x00B0, {0x11}},  // Zero page data for LDY_ZP
-        {0x00BA, {0x22}},  // Zero page,X data (0xB5+X where X=5)
-        {0x3070, {0x33}},  // Absolute data for LDY_AB
-        {0x3085, {0x44}},  // Absolute,X data (0x3080+X where X=5)
-    };
+    // LDA Zero Page,X
+    op(Op::LDA_ZPX), 0x70,
 
-    return demo;
-}
+    // LDA Absolute
+    op(Op::LDA_AB), 0x00, 0x30,
 
-// Combined instruction demo that runs all types of instructions
-std::map<u32, std::vector<byte>> get_instruction_demo() {
-    std::map<u32, std::vector<byte>> demo = {
-        // Program entry point (JSR to main routine)
-        {0xFFFC, {op(Op::JSR), 0x00, 0x20}},
+    // LDA Absolute,X
+    op(Op::LDA_ABSX), 0x10, 0x30,
 
-        // Main routine at 0x2000
-        // Test LDA instructions with various addressing modes
-        {0x2000,
-         {// LDA Immediate
-          op(Op::LDA_IM), 0x42,
+    // LDA Absolute,Y
+    op(Op::LDA_ABSY), 0x20, 0x30,
 
-          // LDA Zero Page
-          op(Op::LDA_ZP), 0x80,
+    // Test indirect addressing modes
+    // LDA (Indirect,X)
+    op(Op::LDA_INX), 0x90,
 
-          // LDA Zero Page,X
-          op(Op::LDA_ZPX), 0x70,
+    // LDA (Indirect),Y
+    op(Op::LDA_INY), 0x92,
 
-          // LDA Absolute
-          op(Op::LDA_AB), 0x00, 0x30,
+    // Test LDY instructions with various addressing modes first
+    // (while X is still 0x05 from the initial setup)
 
-          // LDA Absolute,X
-          op(Op::LDA_ABSX), 0x10, 0x30,
+    // LDY Immediate
+    op(Op::LDY_IM), 0xBB,
 
-          // LDA Absolute,Y
-          op(Op::LDA_ABSY), 0x20, 0x30,
+    // LDY Zero Page
+    op(Op::LDY_ZP), 0xB0,
 
-          // Test indirect addressing modes
-          // LDA (Indirect,X)
-          op(Op::LDA_INX), 0x90,
+    // LDY Zero Page,X
+    op(Op::LDY_ZPX), 0xB5,
 
-          // LDA (Indirect),Y
-          op(Op::LDA_INY), 0x92,
+    // LDY Absolute
+    op(Op::LDY_AB), 0x70, 0x30,
 
-          // Test LDY instructions with various addressing modes first
-          // (while X is still 0x05 from the initial setup)
+    // LDY Absolute,X
+    op(Op::LDY_ABSX), 0x80, 0x30,
 
-          // LDY Immediate
-          op(Op::LDY_IM), 0xBB,
+    // Now we can change X with LDX instructions
+    // LDX Immediate
+    op(Op::LDX_IM), 0xAA,
 
-          // LDY Zero Page
-          op(Op::LDY_ZP), 0xB0,
+    // LDX Zero Page
+    op(Op::LDX_ZP), 0xA0,
 
-          // LDY Zero Page,X
-          op(Op::LDY_ZPX), 0xB5,
+    // LDX Zero Page,Y
+    op(Op::LDX_ZPY), 0xA5,
 
-          // LDY Absolute
-          op(Op::LDY_AB), 0x70, 0x30,
+    // LDX Absolute
+    op(Op::LDX_AB), 0x50, 0x30,
 
-          // LDY Absolute,X
-          op(Op::LDY_ABSX), 0x80, 0x30,
+    // LDX Absolute,Y
+    op(Op::LDX_ABSY), 0x60, 0x30,
 
-          // Now we can change X with LDX instructions
-          // LDX Immediate
-          op(Op::LDX_IM), 0xAA,
+    // Jump to subroutine
+    op(Op::JSR), 0x50, 0x20,
 
-          // LDX Zero Page
-          op(Op::LDX_ZP), 0xA0,
+    // NOP instructions
+    op(Op::NOP), op(Op::NOP),
 
-          // LDX Zero Page,Y
-          op(Op::LDX_ZPY), 0xA5,
+    // Return from the main program
+    op(Op::RTS),
+};
 
-          // LDX Absolute
-          op(Op::LDX_AB), 0x50, 0x30,
+constexpr ProgramImage::Segment INSTRUCTION_DEMO[] = {
+    {0xFFFC, ENTRY},
+    {0x2000, INSTRUCTION_MAIN},
+    {0x2050, SUBROUTINE},
 
-          // LDX Absolute,Y
-          op(Op::LDX_ABSY), 0x60, 0x30,
+    {0x0080, LDA_ZP_DATA},
+    {0x0070, ZPX_BASE},
+    {0x0075, LDA_ZPX_DATA},
+    {0x3000, LDA_AB_DATA},
+    {0x3015, LDA_ABSX_DATA},
+    {0x3022, LDA_ABSY_DATA},
 
-          // Jump to subroutine
-          op(Op::JSR), 0x50, 0x20,
+    {0x00A0, LDX_ZP_DATA},
+    {0x00A7, LDX_ZPY_DATA},
+    {0x3050, LDX_AB_DATA},
+    {0x3062, LDX_ABSY_DATA},
 
-          // NOP instructions
-          op(Op::NOP), op(Op::NOP),
+    {0x00B0, LDY_ZP_DATA},
+    {0x00BA, LDY_ZPX_DATA},
+    {0x3070, LDY_AB_DATA},
+    {0x3085, LDY_ABSX_DATA},
 
-          // Return from the main program
-          op(Op::RTS)}},
+    {0x0090, INX_BASE},
+    {0x0095, INX_POINTER},
+    {0x4000, INX_TARGET},
+    {0x0092, INY_POINTER},
+    {0x4032, INY_TARGET},
+};
 
-        // Subroutine at 0x2050
-        {0x2050,
-         {// Do something in the subroutine
-          op(Op::LDA_IM), 0xFF,
-          // Return from subroutine
-          op(Op::RTS)}},
+// Counter program at 0x8000, same code as programs/counter.asm
+constexpr byte COUNTER_MAIN[] = {
+    // LDX #$00 - Initialize X register with 0
+    op(Op::LDX_IM), 0x00,
 
-        // Data for various addressing modes
-        {0x0080, {0x55}},  // Zero page data for LDA_ZP
-        {0x0070, {0x00}},  // Base for Zero page,X
-        {0x0075, {0x66}},  // Zero page,X data (0x70+X where X=5)
-        {0x3000, {0x77}},  // Absolute data for LDA_AB
-        {0x3015, {0x88}},  // Absolute,X data (0x3010+X where X=5)
-        {0x3022, {0x99}},  // Absolute,Y data (0x3020+Y where Y=2)
+    // STX $0200 - Publish the initial value
+    op(Op::STX_ABS), 0x00, 0x02,
 
-        // LDX data locations
-        {0x00A0, {0xCC}},  // Zero page data for LDX_ZP
-        {0x00A7, {0xDD}},  // Zero page,Y data (0xA5+Y where Y=2)
-        {0x3050, {0xEE}},  // Absolute data for LDX_AB
-        {0x3062, {0xFF}},  // Absolute,Y data (0x3060+Y where Y=2)
+    // Loop start: increment X, store it and repeat
+    op(Op::INX),
 
-        // LDY data locations
-        {0x00B0, {0x11}},  // Zero page data for LDY_ZP
-        {0x00BA, {0x22}},  // Zero page,X data (0xB5+X where X=5)
-        {0x3070, {0x33}},  // Absolute data for LDY_AB
-        {0x3085, {0x44}},  // Absolute,X data (0x3080+X where X=5)
+    // STX $0200
+    op(Op::STX_ABS), 0x00, 0x02,
 
-        // Indirect addressing data
-        {0x0090, {0x00}},        // Zero page for indirect X
-        {0x0095, {0x00, 0x40}},  // Indirect address pointer after X offset (0x90+X where X=5)
-        {0x4000, {0xAA}},        // Target for Indirect,X
+    // JMP $8005 - Back to the loop start
+    op(Op::JMP), 0x05, 0x80,
+};
 
-        {0x0092, {0x30, 0x40}},  // Zero page for indirect Y
-        {0x4032, {0xBB}},        // Target for Indirect,Y (0x4030+Y where Y=2)
-    };
+// Execution starts at 0xFFFC, jump to the program
+constexpr byte COUNTER_ENTRY[] = {op(Op::JMP), 0x00, 0x80};
 
-    return demo;
-}
+constexpr ProgramImage::Segment COUNTER_PROGRAM[] = {
+    {0x8000, COUNTER_MAIN},
+    {0xFFFC, COUNTER_ENTRY},
+};
 
-// Simple counter program that increments X register and stores it to memory
-std::map<u32, std::vector<byte>> get_counter_program() {
-    std::map<u32, std::vector<byte>> program = {
-        // Program starts at 0x8000
-        {0x8000,
-         {
-             // LDX #$00 - Initialize X register with 0
-             op(Op::LDX_IM), 0x00,
+}  // namespace
 
-             // Loop start (increment X and repeat)
-             // INX instruction - not implemented yet, placeholder
-             0xE8,  // INX opcode
+// This function returns a demo program that showcases LDA instructions
+// with various addressing modes
+ProgramImage get_lda_demo() { return LDA_DEMO; }
 
-             // NOP (placeholder for future STX implementation)
-             op(Op::NOP),
+// This function returns a demo program that showcases LDX instructions
+// with various addressing modes
+ProgramImage get_ldx_demo() { return LDX_DEMO; }
 
-             // JMP back to loop start (placeholder, not implemented yet)
-             0x4C, 0x02, 0x80,  // JMP $8002 opcode and address
-         }},
+// This function returns a demo program that showcases LDY instructions
+// with various addressing modes
+ProgramImage get_ldy_demo() { return LDY_DEMO; }
 
-        // Reset vector pointing to the program start
-        {0xFFFC, {0x00, 0x80}},
-    };
+// Combined instruction demo that runs all types of instructions
+ProgramImage get_instruction_demo() { return INSTRUCTION_DEMO; }
 
-    return program;
-}
+// Simple counter program that increments X register and stores it to memory.
+ProgramImage get_counter_program() { return COUNTER_PROGRAM; }
 
 }  // namespace demo_programs
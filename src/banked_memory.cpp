@@ -0,0 +1,127 @@
+#include "banked_memory.h"
+
+#include <algorithm>
+#include <cstring>
+
+BankedMemory::BankedMemory(Mem& mem, u32 backing_size, u32 window_size)
+    : mem(mem), window_bytes(window_size), banks(0) {
+    if (window_size == 0 || window_size % Mem::PAGE_SIZE != 0 || window_size > Mem::MAX_MEM) {
+        return;
+    }
+    banks = (backing_size + window_size - 1) / window_size;
+    if (banks == 0) {
+        banks = 1;
+    }
+    backing.resize(static_cast<size_t>(banks) * window_size);
+}
+
+BankedMemory::~BankedMemory() {
+    for (const Window& window : windows) {
+        mem.unmap(window.first_page, window_bytes / Mem::PAGE_SIZE);
+    }
+    if (registers.mapped) {
+        mem.unmap(static_cast<byte>(registers.base >> 8), 1);
+    }
+}
+
+byte BankedMemory::add_window(word base, bool read_only) {
+    // A misaligned window would wrap around the page table into the zero page
+    if (!ok() || base % window_bytes != 0 || base + window_bytes > Mem::MAX_MEM || windows.size() >= NO_WINDOW) {
+        return NO_WINDOW;
+    }
+    const u32 first_page = base / Mem::PAGE_SIZE;
+    const u32 pages = window_bytes / Mem::PAGE_SIZE;
+    for (const Window& window : windows) {
+        if (first_page < window.first_page + pages && window.first_page < first_page + pages) {
+            return NO_WINDOW;
+        }
+    }
+
+    windows.push_back({static_cast<byte>(first_page), read_only, 0, 0});
+    if (read_only) {
+        mem.map_rom(static_cast<byte>(first_page), pages, backing.data());
+    } else {
+        mem.map_ram(static_cast<byte>(first_page), pages, backing.data());
+    }
+    return static_cast<byte>(windows.size() - 1);
+}
+
+void BankedMemory::select(byte window, u32 bank) {
+    Window& w = windows[window];
+    w.bank = bank < banks ? bank : bank % banks;
+
+    // Only the window's page table entries change. Should something else have
+    // mapped over the window since, the window is mapped afresh.
+    byte* host = backing.data() + static_cast<size_t>(w.bank) * window_bytes;
+    u32 pages = window_bytes / Mem::PAGE_SIZE;
+    if (mem.repoint(w.first_page, pages, host)) {
+        return;
+    }
+    if (w.read_only) {
+        mem.map_rom(w.first_page, pages, host);
+    } else {
+        mem.map_ram(w.first_page, pages, host);
+    }
+}
+
+void BankedMemory::load(u32 index, const byte* bytes, u32 size) {
+    index %= banks;
+    size = std::min(size, window_bytes);
+    std::memcpy(bank(index), bytes, size);
+
+    const u32 pages = (size + Mem::PAGE_SIZE - 1) / Mem::PAGE_SIZE;
+    for (const Window& window : windows) {
+        if (window.bank != index) {
+            continue;
+        }
+        for (u32 i = 0; i < pages; ++i) {
+            mem.host_wrote(static_cast<byte>(window.first_page + i));
+        }
+    }
+}
+
+byte BankedMemory::read(word offset) {
+    byte window = static_cast<byte>(offset / 2);
+    if (window >= windows.size()) {
+        return 0;
+    }
+    return static_cast<byte>(offset & 1 ? windows[window].bank >> 8 : windows[window].bank);
+}
+
+void BankedMemory::write(word offset, byte value) {
+    byte window = static_cast<byte>(offset / 2);
+    if (window >= windows.size()) {
+        return;
+    }
+    if (offset & 1) {
+        windows[window].high_latch = value;
+    } else {
+        select(window, (windows[window].high_latch << 8) | value);
+    }
+}
+
+void BankedMemory::map_registers(word base) {
+    if (registers.mapped) {
+        mem.unmap(static_cast<byte>(registers.base >> 8), 1);
+    }
+    registers.base = base;
+    registers.mapped = true;
+    mem.map_io(static_cast<byte>(base >> 8), 1, registers);
+}
+
+byte BankedMemory::Registers::read(word addr) {
+    word offset = static_cast<word>(addr - base);
+    if (addr < base || offset >= owner.register_count()) {
+        return static_cast<const Mem&>(owner.mem)[addr];
+    }
+    return owner.read(offset);
+}
+
+void BankedMemory::Registers::write(word addr, byte value) {
+    word offset = static_cast<word>(addr - base);
+    if (addr < base || offset >= owner.register_count()) {
+        owner.mem[addr] = value;
+        return;
+    }
+    owner.write(offset, value);
+}
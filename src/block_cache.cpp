@@ -0,0 +1,620 @@
+#include "block_cache.h"
+
+#include <array>
+
+#include "cycles.h"
+#include "dispatch.h"
+#include "op_codes.h"
+#include "operations.h"
+
+// -----------------------------------------------------------------------------
+// Micro-op handlers
+//
+// Same semantics as the handlers in src/instructions/, but the operand bytes
+// were read at decode time and PC/base cycles are advanced by the run loop.
+// -----------------------------------------------------------------------------
+namespace {
+
+// Loads and stores come from the templates in operations.h, with the operand from decode time
+template <typename Operation>
+void predecoded(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    Operation::apply(cpu, mem, op.operand);
+}
+
+void jsr(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    cpu.push16(mem, cpu.PC - 1);
+    cpu.PC = op.operand;
+}
+
+void rts(Cpu& cpu, Mem& mem, const MicroOp&) {
+    cpu.PC = cpu.pull16(mem) + 1;
+}
+
+void jmp(Cpu& cpu, Mem&, const MicroOp& op) {
+    cpu.PC = op.operand;
+}
+
+void jmpi(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    // The pointer is read at run time; it keeps the page boundary bug of JMP ($xxFF)
+    word high_byte_addr = (op.operand & 0xFF00) | ((op.operand + 1) & 0xFF);
+    cpu.PC = mem.read(op.operand) | (mem.read(high_byte_addr) << 8);
+}
+
+void nop(Cpu&, Mem&, const MicroOp&) {}
+
+void pha(Cpu& cpu, Mem& mem, const MicroOp&) {
+    cpu.push8(mem, cpu.A);
+}
+
+void php(Cpu& cpu, Mem& mem, const MicroOp&) {
+    cpu.push8(mem, cpu.status());
+}
+
+void pla(Cpu& cpu, Mem& mem, const MicroOp&) {
+    cpu.A = cpu.pull8(mem);
+    cpu.set_nz(cpu.A);
+}
+
+void plp(Cpu& cpu, Mem& mem, const MicroOp&) {
+    cpu.set_flags(cpu.pull8(mem));
+}
+
+void tsx(Cpu& cpu, Mem&, const MicroOp&) {
+    cpu.X = cpu.SP;
+    cpu.set_nz(cpu.X);
+}
+
+void txs(Cpu& cpu, Mem&, const MicroOp&) {
+    cpu.SP = cpu.X;
+}
+
+void inx(Cpu& cpu, Mem&, const MicroOp&) {
+    cpu.X++;
+    cpu.set_nz(cpu.X);
+}
+
+// The operand of a trap micro-op is the address of the bad opcode
+[[gnu::cold]] void trap(Cpu& cpu, Mem&, const MicroOp& op) {
+    cpu.invalid_opcodes++;
+    cpu.last_invalid_pc = op.operand;
+}
+
+constexpr std::array<MicroHandler, 256> build_micro_table() {
+    std::array<MicroHandler, 256> t{};
+    for (auto& h : t) {
+        h = trap;
+    }
+
+    // LDA
+    t[op(Op::LDA_IM)] = predecoded<instructions::Load<Register::A, addressing::IMM>>;
+    t[op(Op::LDA_ZP)] = predecoded<instructions::Load<Register::A, addressing::ZP>>;
+    t[op(Op::LDA_ZPX)] = predecoded<instructions::Load<Register::A, addressing::ZPX>>;
+    t[op(Op::LDA_AB)] = predecoded<instructions::Load<Register::A, addressing::ABS>>;
+    t[op(Op::LDA_ABSX)] = predecoded<instructions::Load<Register::A, addressing::ABSX>>;
+    t[op(Op::LDA_ABSY)] = predecoded<instructions::Load<Register::A, addressing::ABSY>>;
+    t[op(Op::LDA_INX)] = predecoded<instructions::Load<Register::A, addressing::INDX>>;
+    t[op(Op::LDA_INY)] = predecoded<instructions::Load<Register::A, addressing::INDY>>;
+    // LDX
+    t[op(Op::LDX_IM)] = predecoded<instructions::Load<Register::X, addressing::IMM>>;
+    t[op(Op::LDX_ZP)] = predecoded<instructions::Load<Register::X, addressing::ZP>>;
+    t[op(Op::LDX_ZPY)] = predecoded<instructions::Load<Register::X, addressing::ZPY>>;
+    t[op(Op::LDX_AB)] = predecoded<instructions::Load<Register::X, addressing::ABS>>;
+    t[op(Op::LDX_ABSY)] = predecoded<instructions::Load<Register::X, addressing::ABSY>>;
+    // LDY
+    t[op(Op::LDY_IM)] = predecoded<instructions::Load<Register::Y, addressing::IMM>>;
+    t[op(Op::LDY_ZP)] = predecoded<instructions::Load<Register::Y, addressing::ZP>>;
+    t[op(Op::LDY_ZPX)] = predecoded<instructions::Load<Register::Y, addressing::ZPX>>;
+    t[op(Op::LDY_AB)] = predecoded<instructions::Load<Register::Y, addressing::ABS>>;
+    t[op(Op::LDY_ABSX)] = predecoded<instructions::Load<Register::Y, addressing::ABSX>>;
+    // STA
+    t[op(Op::STA_ZP)] = predecoded<instructions::Store<Register::A, addressing::ZP>>;
+    t[op(Op::STA_ZPX)] = predecoded<instructions::Store<Register::A, addressing::ZPX>>;
+    t[op(Op::STA_ABS)] = predecoded<instructions::Store<Register::A, addressing::ABS>>;
+    t[op(Op::STA_ABSX)] = predecoded<instructions::Store<Register::A, addressing::ABSX>>;
+    t[op(Op::STA_ABSY)] = predecoded<instructions::Store<Register::A, addressing::ABSY>>;
+    t[op(Op::STA_INX)] = predecoded<instructions::Store<Register::A, addressing::INDX>>;
+    t[op(Op::STA_INY)] = predecoded<instructions::Store<Register::A, addressing::INDY>>;
+    // STX
+    t[op(Op::STX_ZP)] = predecoded<instructions::Store<Register::X, addressing::ZP>>;
+    t[op(Op::STX_ZPY)] = predecoded<instructions::Store<Register::X, addressing::ZPY>>;
+    t[op(Op::STX_ABS)] = predecoded<instructions::Store<Register::X, addressing::ABS>>;
+    // STY
+    t[op(Op::STY_ZP)] = predecoded<instructions::Store<Register::Y, addressing::ZP>>;
+    t[op(Op::STY_ZPX)] = predecoded<instructions::Store<Register::Y, addressing::ZPX>>;
+    t[op(Op::STY_ABS)] = predecoded<instructions::Store<Register::Y, addressing::ABS>>;
+    // Control flow and miscellaneous
+    t[op(Op::JSR)] = jsr;
+    t[op(Op::RTS)] = rts;
+    t[op(Op::JMP)] = jmp;
+    t[op(Op::JMPI)] = jmpi;
+    t[op(Op::NOP)] = nop;
+    // Stack operations
+    t[op(Op::PHA)] = pha;
+    t[op(Op::PHP)] = php;
+    t[op(Op::PLA)] = pla;
+    t[op(Op::PLP)] = plp;
+    t[op(Op::TSX)] = tsx;
+    t[op(Op::TXS)] = txs;
+    // Increment operations
+    t[op(Op::INX)] = inx;
+
+    return t;
+}
+
+constexpr std::array<MicroHandler, 256> micro_table = build_micro_table();
+
+// -----------------------------------------------------------------------------
+// Superinstructions
+//
+// Each one runs the work of its `parts` in order, with a single trip through
+// the run loop. Stores inside them only go to addresses known at decode time
+// that are not on the block's own code pages, so they can never invalidate
+// the block they are running from.
+// -----------------------------------------------------------------------------
+
+// LDA #imm ; STA abs (and the LDX/STX, LDY/STY forms)
+template <Register R>
+void load_imm_store_abs(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    byte value = static_cast<byte>(op.parts[0].operand);
+    cpu.set(R, value);
+    cpu.set_nz(value);
+    mem.write(op.parts[1].operand, value);
+}
+
+// INX ; STX abs
+void inx_store_abs(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    inx(cpu, mem, op.parts[0]);
+    mem.write(op.parts[1].operand, cpu.X);
+}
+
+// INX ; STX abs ; JMP abs - the body of a counting loop
+void inx_store_abs_jmp(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    inx(cpu, mem, op.parts[0]);
+    mem.write(op.parts[1].operand, cpu.X);
+    cpu.PC = op.parts[2].operand;
+}
+
+// PHA ; <one instruction> ; PLA - saving A around a single instruction
+void pha_pla(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    pha(cpu, mem, op.parts[0]);
+    op.parts[1].handler(cpu, mem, op.parts[1]);
+    pla(cpu, mem, op.parts[2]);
+}
+
+// JSR into a short leaf subroutine, its body and the RTS back
+void call_leaf(Cpu& cpu, Mem& mem, const MicroOp& op) {
+    for (const MicroOp* part = op.parts; part != op.parts + op.length; ++part) {
+        cpu.PC = part->next_pc;
+        part->handler(cpu, mem, *part);
+    }
+}
+
+// Instructions after which decoding stops
+bool ends_block(byte opcode) {
+    return opcode == op(Op::JMP) || opcode == op(Op::JMPI) || opcode == op(Op::JSR) || opcode == op(Op::RTS) ||
+           dispatch::table[opcode].handler == instructions::TRAP;
+}
+
+// Stores whose target is the operand itself
+bool is_static_store(byte opcode) {
+    return opcode == op(Op::STA_ZP) || opcode == op(Op::STA_ABS) || opcode == op(Op::STX_ZP) ||
+           opcode == op(Op::STX_ABS) || opcode == op(Op::STY_ZP) || opcode == op(Op::STY_ABS);
+}
+
+// Stores whose target depends on X, Y or a pointer in memory
+bool is_indexed_store(byte opcode) {
+    return opcode == op(Op::STA_ZPX) || opcode == op(Op::STA_ABSX) || opcode == op(Op::STA_ABSY) ||
+           opcode == op(Op::STA_INX) || opcode == op(Op::STA_INY) || opcode == op(Op::STX_ZPY) ||
+           opcode == op(Op::STY_ZPX);
+}
+
+// True when `uop` may run inside a superinstruction of a block whose code is on `pages`:
+// no control flow, and every store provably misses the block's code
+bool fusable(const MicroOp& uop, const std::bitset<Mem::NUM_PAGES>& pages) {
+    byte opcode = uop.opcode;
+    if (ends_block(opcode) || is_indexed_store(opcode)) {
+        return false;
+    }
+    if (is_static_store(opcode)) {
+        return !pages[uop.operand >> 8];
+    }
+    if (opcode == op(Op::PHA) || opcode == op(Op::PHP)) {
+        return !pages[0x01];
+    }
+    return true;
+}
+
+// Most cycles `uop` can add to its base cost at run time
+u32 max_penalty(const MicroOp& uop) {
+    return dispatch::table[uop.opcode].penalty == Penalty::PageCross ? PAGE_CROSS_CYCLES : 0;
+}
+
+// Decodes the instruction at `addr`. Its bytes are counted when it runs, see count_fetches().
+MicroOp decode_op(Mem& mem, word addr) {
+    byte opcode = mem.fetch_uncounted(addr);
+    const dispatch::OpEntry& entry = dispatch::table[opcode];
+    byte length = 1 + dispatch::operand_bytes(entry.mode);
+
+    MicroOp uop{micro_table[opcode], nullptr, 0, 0, opcode, entry.cycles};
+    if (entry.handler == instructions::TRAP) {
+        uop.operand = addr;
+        length = 1;
+    } else if (length == 2) {
+        uop.operand = mem.fetch_uncounted(static_cast<word>(addr + 1));
+    } else if (length == 3) {
+        uop.operand =
+            mem.fetch_uncounted(static_cast<word>(addr + 1)) | (mem.fetch_uncounted(static_cast<word>(addr + 2)) << 8);
+    }
+    uop.next_pc = static_cast<word>(addr + length);
+    return uop;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// BlockCache
+// -----------------------------------------------------------------------------
+BlockCache::BlockCache(Mem& mem) : mem(mem) {}
+
+Block* BlockCache::lookup(word pc) {
+    // No block is running between lookups, so retired blocks can go now
+    if (!retired.empty()) {
+        retired.clear();
+    }
+
+    auto it = blocks.find(pc);
+    if (it != blocks.end()) {
+        return it->second.get();
+    }
+    return decode(pc);
+}
+
+bool BlockCache::fuses(byte first, byte second) {
+    // PHA and JSR start a superinstruction with whatever follows them
+    if (first == op(Op::PHA) || first == op(Op::JSR)) {
+        return true;
+    }
+    return (first == op(Op::LDA_IM) && second == op(Op::STA_ABS)) ||
+           (first == op(Op::LDX_IM) && second == op(Op::STX_ABS)) ||
+           (first == op(Op::LDY_IM) && second == op(Op::STY_ABS)) ||
+           (first == op(Op::INX) && second == op(Op::STX_ABS)) ||
+           (first == op(Op::STX_ABS) && second == op(Op::JMP));
+}
+
+void BlockCache::mark_code(word pc, word addr, byte length, PageSet& pages) {
+    for (byte i = 0; i < length; ++i) {
+        byte page = static_cast<word>(addr + i) >> 8;
+        if (page_blocks[page].empty() || page_blocks[page].back() != pc) {
+            page_blocks[page].push_back(pc);
+        }
+        mem.mark_code_page(page);
+        pages[page] = true;
+    }
+}
+
+Block* BlockCache::decode(word pc) {
+    auto block = std::make_unique<Block>();
+    block->start = pc;
+
+    PageSet pages;
+    word addr = pc;
+    for (u32 n = 0; n < MAX_BLOCK_OPS; ++n) {
+        MicroOp uop = decode_op(mem, addr);
+        mark_code(pc, addr, static_cast<word>(uop.next_pc - addr), pages);
+
+        addr = uop.next_pc;
+        block->ops.push_back(uop);
+        block->cycles += uop.cycles;
+        block->penalties += max_penalty(uop);
+
+        if (ends_block(uop.opcode)) {
+            block->returns = uop.opcode == op(Op::RTS);
+            break;
+        }
+    }
+
+    // A JSR at the end of the block can take its leaf subroutine along
+    if (fusion && block->ops.back().opcode == op(Op::JSR)) {
+        decode_leaf(*block, block->ops.back(), pages);
+    }
+    return insert(std::move(block), pages);
+}
+
+void BlockCache::restore(word start, Span<const MicroOp> ops, Span<const MicroOp> leaf) {
+    if (ops.empty() || blocks.count(start) != 0) {
+        return;
+    }
+    auto block = std::make_unique<Block>();
+    block->start = start;
+
+    PageSet pages;
+    word addr = start;
+    for (MicroOp uop : ops) {
+        uop.handler = micro_table[uop.opcode];
+        mark_code(start, addr, static_cast<word>(uop.next_pc - addr), pages);
+
+        addr = uop.next_pc;
+        block->ops.push_back(uop);
+        block->cycles += uop.cycles;
+        block->penalties += max_penalty(uop);
+    }
+    block->returns = block->ops.back().opcode == op(Op::RTS);
+
+    if (fusion && !leaf.empty()) {
+        for (MicroOp uop : leaf) {
+            uop.handler = micro_table[uop.opcode];
+            block->leaf.push_back(uop);
+        }
+        mark_leaf(*block, pages);
+    }
+    insert(std::move(block), pages);
+}
+
+Block* BlockCache::insert(std::unique_ptr<Block> block, const PageSet& pages) {
+    if (fusion) {
+        fuse(*block, pages);
+    } else {
+        block->fused_cycles = block->cycles;
+        block->fused_penalties = block->penalties;
+        block->fused_returns = block->returns;
+    }
+
+    Block* result = block.get();
+    blocks[block->start] = std::move(block);
+    return result;
+}
+
+void BlockCache::mark_leaf(Block& block, PageSet& pages) {
+    // The leaf's code belongs to this block, so stores to it drop the caller too
+    word addr = block.leaf[0].operand;
+    for (size_t i = 1; i < block.leaf.size(); ++i) {
+        mark_code(block.start, addr, static_cast<word>(block.leaf[i].next_pc - addr), pages);
+        addr = block.leaf[i].next_pc;
+    }
+}
+
+bool BlockCache::decode_leaf(Block& block, const MicroOp& call, PageSet& pages) {
+    std::vector<MicroOp> leaf{call};
+    word addr = call.operand;
+    for (u32 n = 0; n < MAX_LEAF_OPS; ++n) {
+        MicroOp uop = decode_op(mem, addr);
+        leaf.push_back(uop);
+
+        if (uop.opcode == op(Op::RTS)) {
+            block.leaf = std::move(leaf);
+            mark_leaf(block, pages);
+            return true;
+        }
+        if (ends_block(uop.opcode)) {
+            return false;
+        }
+        addr = uop.next_pc;
+    }
+    return false;
+}
+
+void BlockCache::fuse(Block& block, const PageSet& pages) {
+    const std::vector<MicroOp>& ops = block.ops;
+
+    // The leaf subroutine, if any, was decoded with the block and its code
+    // pages are in `pages`, so the checks below cover them too
+    bool leaf = !block.leaf.empty();
+    if (leaf) {
+        for (size_t i = 1; i + 1 < block.leaf.size(); ++i) {
+            if (!fusable(block.leaf[i], pages)) {
+                block.leaf.clear();
+                leaf = false;
+                break;
+            }
+        }
+        leaf = leaf && !pages[0x01];
+    }
+
+    std::vector<MicroOp> fused;
+    auto emit = [&](MicroHandler handler, const MicroOp* parts, size_t length) {
+        MicroOp uop{handler, parts, parts[0].operand, parts[length - 1].next_pc, parts[0].opcode, 0};
+        for (size_t i = 0; i < length; ++i) {
+            uop.cycles += parts[i].cycles;
+        }
+        uop.length = static_cast<byte>(length);
+        fused.push_back(uop);
+    };
+
+    for (size_t i = 0; i < ops.size();) {
+        const MicroOp* cur = &ops[i];
+        size_t left = ops.size() - i;
+        byte first = cur[0].opcode;
+        byte second = left > 1 ? cur[1].opcode : op(Op::BRK);
+
+        if (left > 2 && first == op(Op::INX) && second == op(Op::STX_ABS) && cur[2].opcode == op(Op::JMP) &&
+            fusable(cur[1], pages)) {
+            emit(inx_store_abs_jmp, cur, 3);
+            i += 3;
+        } else if (left > 1 && first == op(Op::INX) && second == op(Op::STX_ABS) && fusable(cur[1], pages)) {
+            emit(inx_store_abs, cur, 2);
+            i += 2;
+        } else if (left > 1 && first == op(Op::LDA_IM) && second == op(Op::STA_ABS) && fusable(cur[1], pages)) {
+            emit(load_imm_store_abs<Register::A>, cur, 2);
+            i += 2;
+        } else if (left > 1 && first == op(Op::LDX_IM) && second == op(Op::STX_ABS) && fusable(cur[1], pages)) {
+            emit(load_imm_store_abs<Register::X>, cur, 2);
+            i += 2;
+        } else if (left > 1 && first == op(Op::LDY_IM) && second == op(Op::STY_ABS) && fusable(cur[1], pages)) {
+            emit(load_imm_store_abs<Register::Y>, cur, 2);
+            i += 2;
+        } else if (left > 2 && first == op(Op::PHA) && cur[2].opcode == op(Op::PLA) && fusable(cur[0], pages) &&
+                   fusable(cur[1], pages)) {
+            emit(pha_pla, cur, 3);
+            i += 3;
+        } else if (left == 1 && leaf) {
+            emit(call_leaf, block.leaf.data(), block.leaf.size());
+            i += 1;
+        } else {
+            fused.push_back(*cur);
+            i += 1;
+        }
+    }
+
+    // Nothing was fused; the block runs from `ops` only
+    if (fused.size() == ops.size() && !leaf) {
+        block.fused_cycles = block.cycles;
+        block.fused_penalties = block.penalties;
+        block.fused_returns = block.returns;
+        return;
+    }
+
+    block.fused = std::move(fused);
+    block.fused_returns = block.returns || leaf;
+    for (const MicroOp& uop : block.fused) {
+        block.fused_cycles += uop.cycles;
+    }
+    block.fused_penalties = block.penalties;
+    for (size_t i = 1; leaf && i < block.leaf.size(); ++i) {
+        block.fused_penalties += max_penalty(block.leaf[i]);
+    }
+}
+
+void BlockCache::invalidate_page(byte page) {
+    for (word start : page_blocks[page]) {
+        auto it = blocks.find(start);
+        if (it != blocks.end()) {
+            it->second->valid = false;
+            retired.push_back(std::move(it->second));
+            blocks.erase(it);
+        }
+    }
+    page_blocks[page].clear();
+    current_epoch++;
+}
+
+void BlockCache::clear() {
+    for (auto& [start, block] : blocks) {
+        block->valid = false;
+        retired.push_back(std::move(block));
+    }
+    blocks.clear();
+    for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+        page_blocks[page].clear();
+        mem.clear_code_page(static_cast<byte>(page));
+    }
+    native_code.reset();
+    current_epoch++;
+}
+
+bool BlockCache::translate(Block& block) {
+    Jit::Status status = native_code.compile(block);
+    if (status != Jit::Status::Full) {
+        return status == Jit::Status::Compiled;
+    }
+
+    // Much of the arena usually belongs to blocks that were invalidated since
+    native_code.reset();
+    for (auto& [start, cached] : blocks) {
+        cached->native = nullptr;
+        cached->executions = 0;
+    }
+    for (auto& stale : retired) {
+        stale->native = nullptr;
+    }
+    return native_code.compile(block) == Jit::Status::Compiled;
+}
+
+// -----------------------------------------------------------------------------
+// Block engine
+// -----------------------------------------------------------------------------
+namespace {
+
+// Counts the bytes of the instruction `uop` was decoded from as fetched, as the
+// interpreters do each time they run it
+void count_fetches(Mem& mem, const MicroOp& uop) {
+    const dispatch::OpEntry& entry = dispatch::table[uop.opcode];
+    word length = entry.handler == instructions::TRAP ? 1 : 1 + dispatch::operand_bytes(entry.mode);
+    for (word addr = uop.next_pc - length; addr != uop.next_pc; ++addr) {
+        mem.access_counts.fetch(addr);
+    }
+}
+
+// Shared by the block and JIT engines; `Native` adds the recompiler tier
+template <bool Native>
+bool run_cached_blocks(Cpu& cpu, u64 deadline, Mem& mem) {
+    BlockCache& cache = mem.blocks();
+    Block* block = nullptr;
+
+    while (cpu.cycle_count < deadline) {
+        const u64 remaining = deadline - cpu.cycle_count;
+
+        // Follow the cached successor link when it is still valid.
+        // An invalidated block may be freed by the lookup, so it is not linked.
+        bool can_link = block != nullptr && block->valid;
+        if (can_link && block->next_epoch == cache.epoch() && block->next->start == cpu.PC) {
+            block = block->next;
+        } else {
+            Block* next = cache.lookup(cpu.PC);
+            if (can_link) {
+                block->next = next;
+                block->next_epoch = cache.epoch();
+            }
+            block = next;
+        }
+
+        if constexpr (Native) {
+            // Translate blocks once they are hot; failed blocks are not retried
+            if (block->native == nullptr && ++block->executions == Jit::HOT_THRESHOLD) {
+                cache.translate(*block);
+            }
+            // Accesses to pages that are not the RAM in `data` leave native code for the interpreter
+            if (block->native != nullptr && remaining >= block->cycles + block->penalties) {
+                const u64 before = cpu.cycle_count;
+                if (Jit::run(*block, cpu, mem, deadline)) {
+                    return true;
+                }
+                // A side exit on the first instruction made no progress; interpret the block instead
+                if (cpu.cycle_count != before || cpu.PC != block->start) {
+                    continue;
+                }
+            }
+        }
+
+        // When the whole block fits into the budget even with every page-crossing
+        // penalty, skip the per-op deadline check and run the superinstructions.
+        // Counting builds run one op per instruction so that fetches are counted per instruction.
+        const bool fits = remaining >= block->fused_cycles + block->fused_penalties;
+        const bool use_fused = fits && !block->fused.empty() && !access_counters::Policy::enabled;
+        const std::vector<MicroOp>& ops = use_fused ? block->fused : block->ops;
+
+        const MicroOp* uop = ops.data();
+        const MicroOp* end = uop + ops.size();
+        for (; uop != end; ++uop) {
+            if (!fits && cpu.cycle_count >= deadline) {
+                return false;
+            }
+            if constexpr (access_counters::Policy::enabled) {
+                count_fetches(mem, *uop);
+            }
+            cpu.cycle_count += uop->cycles;
+            cpu.PC = uop->next_pc;
+            uop->handler(cpu, mem, *uop);
+
+            // A store hit this block's code; the rest of it is stale
+            if (!block->valid) {
+                ++uop;
+                break;
+            }
+        }
+
+        if (uop == end && (use_fused ? block->fused_returns : block->returns)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+bool Cpu::run_blocks(u64 deadline, Mem& mem) {
+    return run_cached_blocks<false>(*this, deadline, mem);
+}
+
+bool Cpu::run_jit(u64 deadline, Mem& mem) {
+    return run_cached_blocks<true>(*this, deadline, mem);
+}
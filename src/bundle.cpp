@@ -0,0 +1,228 @@
+#include "bundle.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "block_cache.h"
+
+namespace bundle {
+
+namespace {
+
+// Tables start on 8-byte boundaries, so every field is aligned in the mapping
+constexpr u32 ALIGN = 8;
+
+u32 aligned(size_t size) {
+    return static_cast<u32>((size + ALIGN - 1) / ALIGN * ALIGN);
+}
+
+// Appends `size` bytes at an aligned offset and returns that offset
+u32 append(std::vector<byte>& out, const void* bytes, size_t size) {
+    u32 offset = aligned(out.size());
+    out.resize(offset + size);
+    if (size != 0) {
+        std::memcpy(out.data() + offset, bytes, size);
+    }
+    return offset;
+}
+
+}  // namespace
+
+u64 hash(const byte* bytes, size_t size, u64 h) {
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return h;
+}
+
+std::vector<byte> build(const ProgramImage& image, word entry, const binary_reader::Symbols& symbols,
+                        const BlockCache* cache) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.entry = entry;
+
+    std::vector<byte> out(sizeof(Header));
+
+    // Segment bytes first, then the table that points at them
+    std::vector<Segment> segments;
+    for (const ProgramImage::Segment& segment : image) {
+        u32 offset = append(out, segment.bytes.data(), segment.bytes.size());
+        segments.push_back({segment.address, static_cast<u32>(segment.bytes.size()), offset, 0});
+    }
+    header.segment_count = static_cast<u32>(segments.size());
+    header.segments = append(out, segments.data(), segments.size() * sizeof(Segment));
+
+    std::vector<Symbol> table;
+    std::string names;
+    for (const auto& [name, address] : symbols) {
+        table.push_back({address, static_cast<u32>(names.size())});
+        names.append(name).push_back('\0');
+    }
+    header.symbol_count = static_cast<u32>(table.size());
+    header.symbols = append(out, table.data(), table.size() * sizeof(Symbol));
+    header.strings = append(out, names.data(), names.size());
+    header.strings_size = static_cast<u32>(names.size());
+
+    if (cache != nullptr) {
+        std::vector<const Block*> cached;
+        cache->for_each([&](const Block& block) {
+            if (block.valid) {
+                cached.push_back(&block);
+            }
+        });
+        std::sort(cached.begin(), cached.end(), [](const Block* a, const Block* b) { return a->start < b->start; });
+
+        std::vector<BlockRecord> records;
+        std::vector<OpRecord> ops;
+        for (const Block* block : cached) {
+            records.push_back({block->start, static_cast<u32>(ops.size()), static_cast<word>(block->ops.size()),
+                               static_cast<word>(block->leaf.size()), 0});
+            for (const std::vector<MicroOp>* list : {&block->ops, &block->leaf}) {
+                for (const MicroOp& uop : *list) {
+                    ops.push_back({uop.operand, uop.next_pc, uop.opcode, uop.cycles, 0});
+                }
+            }
+        }
+        header.block_count = static_cast<u32>(records.size());
+        header.blocks = append(out, records.data(), records.size() * sizeof(BlockRecord));
+        header.op_count = static_cast<u32>(ops.size());
+        header.ops = append(out, ops.data(), ops.size() * sizeof(OpRecord));
+    }
+
+    out.resize(aligned(out.size()));
+    header.file_size = out.size();
+    std::memcpy(out.data(), &header, sizeof(Header));
+    header.hash = hash(out.data(), out.size());
+    std::memcpy(out.data(), &header, sizeof(Header));
+    return out;
+}
+
+bool write(const std::string& path, const ProgramImage& image, word entry, const binary_reader::Symbols& symbols,
+           const BlockCache* cache) {
+    std::vector<byte> bytes = build(image, entry, symbols, cache);
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && written;
+}
+
+}  // namespace bundle
+
+Bundle::Bundle(const std::string& path) : Bundle(RomImage::from_file(path)) {}
+
+Bundle::Bundle(std::shared_ptr<const RomImage> image) : file(std::move(image)) {
+    if (!file || file->size() < sizeof(bundle::Header)) {
+        return;
+    }
+    const byte* base = file->data();
+    const size_t size = file->size();
+    const auto* head = reinterpret_cast<const bundle::Header*>(base);
+    if (std::memcmp(head->magic, bundle::MAGIC, sizeof(bundle::MAGIC)) != 0 || head->version != bundle::VERSION ||
+        head->byte_order != bundle::BYTE_ORDER_MARK || head->file_size != size || head->entry >= Mem::MAX_MEM) {
+        return;
+    }
+
+    // A table must lie past the header, inside the file, and start aligned; absent tables are empty
+    auto inside = [&](u32 offset, u64 bytes) {
+        return bytes == 0 || (offset >= sizeof(bundle::Header) && offset % 8 == 0 && offset <= size &&
+                              bytes <= size - offset);
+    };
+    if (!inside(head->segments, u64{head->segment_count} * sizeof(bundle::Segment)) ||
+        !inside(head->symbols, u64{head->symbol_count} * sizeof(bundle::Symbol)) ||
+        !inside(head->strings, head->strings_size) ||
+        !inside(head->blocks, u64{head->block_count} * sizeof(bundle::BlockRecord)) ||
+        !inside(head->ops, u64{head->op_count} * sizeof(bundle::OpRecord))) {
+        return;
+    }
+
+    // Every block needs its ops inside the op table, and no more than a decode makes
+    const auto* records = reinterpret_cast<const bundle::BlockRecord*>(base + head->blocks);
+    for (u32 i = 0; i < head->block_count; ++i) {
+        const bundle::BlockRecord& record = records[i];
+        if (record.start >= Mem::MAX_MEM || record.op_count == 0 || record.op_count > BlockCache::MAX_BLOCK_OPS ||
+            record.leaf_count > BlockCache::MAX_LEAF_OPS + 1 || record.first_op > head->op_count ||
+            u32{record.op_count} + record.leaf_count > head->op_count - record.first_op) {
+            return;
+        }
+    }
+
+    // Names are looked up in place, so the string table has to end in a NUL
+    if (head->symbol_count != 0 && (head->strings_size == 0 || base[head->strings + head->strings_size - 1] != 0)) {
+        return;
+    }
+    const auto* symbols = reinterpret_cast<const bundle::Symbol*>(base + head->symbols);
+    for (u32 i = 0; i < head->symbol_count; ++i) {
+        if (symbols[i].name >= head->strings_size) {
+            return;
+        }
+    }
+
+    const auto* segments = reinterpret_cast<const bundle::Segment*>(base + head->segments);
+    views.reserve(head->segment_count);
+    for (u32 i = 0; i < head->segment_count; ++i) {
+        const bundle::Segment& segment = segments[i];
+        if (!inside(segment.offset, segment.size) || segment.address > Mem::MAX_MEM ||
+            segment.size > Mem::MAX_MEM - segment.address) {
+            views.clear();
+            return;
+        }
+        views.push_back({segment.address, Span<const byte>(base + segment.offset, segment.size)});
+    }
+
+    header = head;
+    symbol_table = symbols;
+    strings = reinterpret_cast<const char*>(base + head->strings);
+    blocks = Span<const bundle::BlockRecord>(records, head->block_count);
+    ops = Span<const bundle::OpRecord>(reinterpret_cast<const bundle::OpRecord*>(base + head->ops), head->op_count);
+}
+
+bool Bundle::verify() const {
+    if (!ok()) {
+        return false;
+    }
+    // The mapping is read-only, so the header is hashed from a copy with the hash cleared
+    bundle::Header copy = *header;
+    copy.hash = 0;
+    u64 h = bundle::hash(reinterpret_cast<const byte*>(&copy), sizeof(copy));
+    return bundle::hash(file->data() + sizeof(copy), file->size() - sizeof(copy), h) == header->hash;
+}
+
+const char* Bundle::symbol_name(u32 i) const {
+    return strings + symbol_table[i].name;
+}
+
+bool Bundle::find_symbol(const char* name, u32& address) const {
+    for (u32 i = 0; i < header->symbol_count; ++i) {
+        if (std::strcmp(symbol_name(i), name) == 0) {
+            address = symbol_table[i].address;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Bundle::load(Cpu& cpu, Mem& mem) const {
+    for (const ProgramImage::Segment& segment : views) {
+        mem.load(segment.address, segment.bytes.data(), static_cast<u32>(segment.bytes.size()));
+    }
+    cpu.PC = entry();
+}
+
+void Bundle::warm(Mem& mem) const {
+    BlockCache& cache = mem.blocks();
+    MicroOp decoded[BlockCache::MAX_BLOCK_OPS + BlockCache::MAX_LEAF_OPS + 1];
+    for (const bundle::BlockRecord& record : blocks) {
+        u32 count = u32{record.op_count} + record.leaf_count;
+        for (u32 i = 0; i < count; ++i) {
+            const bundle::OpRecord& op = ops[record.first_op + i];
+            decoded[i] = {nullptr, nullptr, op.operand, op.next_pc, op.opcode, op.cycles};
+        }
+        cache.restore(static_cast<word>(record.start), Span<const MicroOp>(decoded, record.op_count),
+                      Span<const MicroOp>(decoded + record.op_count, record.leaf_count));
+    }
+}
@@ -0,0 +1,349 @@
+#include "bus.h"
+
+#include <algorithm>
+
+#include "dispatch.h"
+#include "op_codes.h"
+
+namespace bus {
+
+namespace {
+
+constexpr word stack(byte sp) {
+    return Cpu::STACK_BASE | sp;
+}
+
+// The address an indexed mode puts on the bus first: the low byte is already
+// indexed, the high byte is not corrected for a carry yet
+constexpr word uncorrected(word base, byte index) {
+    return (base & 0xFF00) | static_cast<byte>(base + index);
+}
+
+// Register that a load or store moves
+Register operand_register(byte opcode) {
+    switch (static_cast<Op>(opcode)) {
+        case Op::LDX_IM:
+        case Op::LDX_ZP:
+        case Op::LDX_ZPY:
+        case Op::LDX_AB:
+        case Op::LDX_ABSY:
+        case Op::STX_ZP:
+        case Op::STX_ZPY:
+        case Op::STX_ABS:
+            return Register::X;
+        case Op::LDY_IM:
+        case Op::LDY_ZP:
+        case Op::LDY_ZPX:
+        case Op::LDY_AB:
+        case Op::LDY_ABSX:
+        case Op::STY_ZP:
+        case Op::STY_ZPX:
+        case Op::STY_ABS:
+            return Register::Y;
+        default:
+            return Register::A;
+    }
+}
+
+// Runs bus cycles one at a time. Each access goes through Mem on its own
+// cycle, with `cycle_count` already counting that cycle, and the observer
+// sees both halves of every cycle. An access on an instruction's last cycle
+// therefore sees the same count as on the engines that charge all cycles first.
+class Stepper {
+   public:
+    Stepper(Cpu& cpu, Mem& mem) : cpu(cpu), mem(mem) {}
+
+    // Opcode and operand bytes
+    byte fetch(word addr, bool sync = false) {
+        phase1(addr, false, sync);
+        phase2(mem.fetch(addr));
+        return end();
+    }
+
+    // Data, pointer and stack reads
+    byte read(word addr) {
+        phase1(addr, false, false);
+        phase2(mem.read(addr));
+        return end();
+    }
+
+    // Reads whose data the CPU ignores; sampled without side effects
+    void dummy(word addr) {
+        phase1(addr, false, false);
+        phase2(mem.peek(addr));
+        end();
+    }
+
+    void write(word addr, byte value) {
+        phase1(addr, true, false);
+        phase2(value);
+        mem.write(addr, value);
+        end();
+    }
+
+   private:
+    // Address, direction and SYNC change while PHI2 is low
+    void phase1(word addr, bool write, bool sync) {
+        cpu.cycle_count++;
+        cpu.PHI0 = 0;
+        cpu.PIN_3 = 1;  // PHI1O
+        cpu.PHI2O = 0;
+        cpu.addr_bus.ADDR = addr;
+        cpu.RWB = !write;
+        cpu.PIN_7 = sync;  // SYNC
+        if (cpu.bus_observer) {
+            cpu.bus_observer->half_cycle(cpu);
+        }
+    }
+
+    // The data bus is valid while PHI2 is high
+    void phase2(byte data) {
+        cpu.PHI0 = 1;
+        cpu.PIN_3 = 0;
+        cpu.PHI2O = 1;
+        cpu.data_bus.DATA = data;
+        if (cpu.bus_observer) {
+            cpu.bus_observer->half_cycle(cpu);
+        }
+    }
+
+    // A read latches the data bus at the end of the cycle, so an observer
+    // may have driven it instead of memory
+    byte end() const { return static_cast<byte>(cpu.data_bus.DATA); }
+
+    Cpu& cpu;
+    Mem& mem;
+};
+
+// Effective address of a Read or Write instruction, after its operand and
+// pointer cycles. Indexed reads that stay on the page need no fix-up cycle;
+// crossing reads and all writes read the uncorrected address first.
+word effective_address(Stepper& bus, Cpu& cpu, AddrMode mode, bool write) {
+    auto indexed = [&](word base, byte index) {
+        word addr = static_cast<word>(base + index);
+        if (write || addr != uncorrected(base, index)) {
+            bus.dummy(uncorrected(base, index));
+        }
+        return addr;
+    };
+
+    switch (mode) {
+        case AddrMode::ZP:
+            return bus.fetch(cpu.PC++);
+        case AddrMode::ZPX:
+        case AddrMode::ZPY: {
+            byte zp = bus.fetch(cpu.PC++);
+            bus.dummy(zp);  // While the index is added
+            return static_cast<byte>(zp + (mode == AddrMode::ZPX ? cpu.X : cpu.Y));
+        }
+        case AddrMode::ABS: {
+            byte lo = bus.fetch(cpu.PC++);
+            return lo | (bus.fetch(cpu.PC++) << 8);
+        }
+        case AddrMode::ABSX:
+        case AddrMode::ABSY: {
+            byte lo = bus.fetch(cpu.PC++);
+            word base = lo | (bus.fetch(cpu.PC++) << 8);
+            return indexed(base, mode == AddrMode::ABSX ? cpu.X : cpu.Y);
+        }
+        case AddrMode::INDX: {
+            byte zp = bus.fetch(cpu.PC++);
+            bus.dummy(zp);  // While X is added
+            byte ptr = zp + cpu.X;
+            byte lo = bus.read(ptr);
+            return lo | (bus.read(static_cast<byte>(ptr + 1)) << 8);
+        }
+        case AddrMode::INDY: {
+            byte ptr = bus.fetch(cpu.PC++);
+            byte lo = bus.read(ptr);
+            word base = lo | (bus.read(static_cast<byte>(ptr + 1)) << 8);
+            return indexed(base, cpu.Y);
+        }
+        default:
+            return 0;
+    }
+}
+
+}  // namespace
+
+}  // namespace bus
+
+bool Cpu::run_pins(u64 deadline, Mem& mem) {
+    bus::Stepper bus(*this, mem);
+
+    // Stack cycles, with the same checks as push8 and pull8
+    auto push = [&](byte value) {
+#ifdef EMULATOR_STACK_CHECKS
+        if (SP == 0x00) {
+            stack_fault(true);
+        }
+#endif
+        bus.write(bus::stack(SP--), value);
+    };
+    auto pull = [&]() {
+#ifdef EMULATOR_STACK_CHECKS
+        if (SP == 0xFF) {
+            stack_fault(false);
+        }
+#endif
+        return bus.read(bus::stack(++SP));
+    };
+
+    while (cycle_count < deadline) {
+        byte ins = bus.fetch(PC++, true);
+        const dispatch::OpEntry& entry = dispatch::table[ins];
+
+        switch (entry.access) {
+            case dispatch::Access::None:
+                entry.handler(*this, mem);  // The trap touches no memory
+                break;
+            case dispatch::Access::Implied:
+                bus.dummy(PC);  // The next byte is read and discarded
+                entry.handler(*this, mem);
+                break;
+            case dispatch::Access::Read: {
+                byte value = entry.mode == AddrMode::IMM ? bus.fetch(PC++)
+                                                         : bus.read(bus::effective_address(bus, *this, entry.mode, false));
+                set(bus::operand_register(ins), value);
+                set_nz(value);
+                break;
+            }
+            case dispatch::Access::Write: {
+                word addr = bus::effective_address(bus, *this, entry.mode, true);
+                bus.write(addr, get(bus::operand_register(ins)));
+                break;
+            }
+            case dispatch::Access::Push:
+                bus.dummy(PC);
+                push(ins == op(Op::PHA) ? A : status());
+                break;
+            case dispatch::Access::Pull: {
+                bus.dummy(PC);
+                bus.dummy(bus::stack(SP));  // While SP is incremented
+                byte value = pull();
+                if (ins == op(Op::PLA)) {
+                    A = value;
+                    set_nz(value);
+                } else {
+                    set_flags(value);
+                }
+                break;
+            }
+            case dispatch::Access::Call: {
+                byte lo = bus.fetch(PC++);
+                bus.dummy(bus::stack(SP));  // Internal operation
+                push(PC >> 8);              // PC is at the target's high byte, the return address minus one
+                push(PC & 0xFF);
+                PC = lo | (bus.fetch(PC) << 8);
+                break;
+            }
+            case dispatch::Access::Return: {
+                bus.dummy(PC);
+                bus.dummy(bus::stack(SP));
+                byte lo = pull();
+                word addr = lo | (pull() << 8);
+                bus.dummy(addr);  // While PC is incremented past the JSR
+                PC = addr + 1;
+                return true;
+            }
+            case dispatch::Access::Jump: {
+                byte lo = bus.fetch(PC++);
+                word target = lo | (bus.fetch(PC++) << 8);
+                if (entry.mode == AddrMode::IND) {
+                    // The pointer's high byte comes from the same page (JMP ($xxFF) bug)
+                    byte low = bus.read(target);
+                    target = low | (bus.read((target & 0xFF00) | static_cast<byte>(target + 1)) << 8);
+                }
+                PC = target;
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+Bus::Bus(Cpu& cpu, Mem& mem) : cpu(cpu), mem(mem), synced_cycles(cpu.cycle_count) {}
+
+Bus::~Bus() {
+    unmap_all();
+}
+
+void Bus::map(Device& device, word base, u32 size) {
+    if (size == 0) {
+        return;
+    }
+    if (base + size > Mem::MAX_MEM) {
+        size = Mem::MAX_MEM - base;
+    }
+    sync();
+
+    // Newest first, so that later mappings win where they overlap
+    regions.insert(regions.begin(), {&device, base, size});
+    if (std::find(devices.begin(), devices.end(), &device) == devices.end()) {
+        devices.push_back(&device);
+    }
+
+    u32 first = base >> 8;
+    u32 last = (base + size - 1) >> 8;
+    mem.map_io(static_cast<byte>(first), last - first + 1, *this);
+}
+
+void Bus::unmap_all() {
+    for (const Region& region : regions) {
+        u32 first = region.base >> 8;
+        u32 last = (region.base + region.size - 1) >> 8;
+        mem.unmap(static_cast<byte>(first), last - first + 1);
+    }
+    regions.clear();
+    devices.clear();
+}
+
+u64 Bus::run(u64 cycles, StopReason& reason) {
+    u64 used = 0;
+    reason = StopReason::CyclesExhausted;
+    while (used < cycles && reason != StopReason::Returned) {
+        u64 slice = cycles - used < quantum ? cycles - used : quantum;
+        used += cpu.run(slice, mem, reason);
+        sync();
+    }
+    return used;
+}
+
+void Bus::sync() {
+    // A CPU reset winds the cycle count back; there is nothing to catch up on then
+    if (cpu.cycle_count > synced_cycles) {
+        u64 elapsed = cpu.cycle_count - synced_cycles;
+        for (Device* device : devices) {
+            device->tick(elapsed);
+        }
+    }
+    synced_cycles = cpu.cycle_count;
+}
+
+const Bus::Region* Bus::find(word addr) const {
+    for (const Region& region : regions) {
+        if (static_cast<word>(addr - region.base) < region.size) {
+            return &region;
+        }
+    }
+    return nullptr;
+}
+
+byte Bus::read(word addr) {
+    const Region* region = find(addr);
+    if (!region) {
+        return mem.peek(addr);  // RAM under the I/O page
+    }
+    sync();
+    return region->device->read(static_cast<word>(addr - region->base));
+}
+
+void Bus::write(word addr, byte value) {
+    const Region* region = find(addr);
+    if (!region) {
+        mem[addr] = value;
+        return;
+    }
+    sync();
+    region->device->write(static_cast<word>(addr - region->base), value);
+}
@@ -0,0 +1,26 @@
+#include "devices.h"
+
+namespace devices {
+
+byte ConsoleOutput::read(word offset) {
+    (void)offset;
+    return 0;
+}
+
+void ConsoleOutput::write(word offset, byte value) {
+    if (offset == 0) {
+        out.put(static_cast<char>(value));
+    }
+}
+
+byte CycleCounter::read(word offset) {
+    return offset < SIZE ? static_cast<byte>(latch >> (offset * 8)) : 0;
+}
+
+void CycleCounter::write(word offset, byte value) {
+    (void)offset;
+    (void)value;
+    latch = static_cast<u32>(count);
+}
+
+}  // namespace devices
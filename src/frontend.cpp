@@ -0,0 +1,253 @@
+#include "frontend.h"
+
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "colors.h"
+#include "op_codes.h"
+
+namespace frontend {
+
+i32 execute(Cpu& cpu, i32 cycles, Mem& mem, bool* completed_out) {
+    i32 starting_cycles = cycles;
+    bool completed = false;
+    bool ran_instructions = false;
+
+    // Determine execution mode based on environment
+    bool manual_mode = false;
+
+    // Skip the user prompt if we're in testing mode
+#ifndef __TESTING
+    // Ask the user to provide whether the execution mode will be
+    // automatic or manual stepping
+    //
+    // in automatic mode the execution will be done without any intervention
+    // in manual mode use will have to press enter or yes to continue execution
+    // or enter s/state/STATE/S to see the cpu state at that point
+    // in manual mode the user can also enter 'q' to quit the execution
+
+    // ask the user for input
+    std::cout << colors::BOLD << colors::BLUE << "Please select the execution mode from below:\n";
+    std::cout << colors::GREEN << "1. Automatic execution (default)\n";
+    std::cout << "2. Manual stepping (press Enter to continue, 's' to see state, 'q' to quit)\n";
+    std::cout << "Enter your choice (1 or 2): ";
+    std::cout << colors::RESET;
+    std::string choice;
+    std::getline(std::cin, choice);
+
+    if (choice == "2") {
+        manual_mode = true;
+        std::cout << colors::BOLD << colors::BLUE << "Manual stepping mode enabled. ";
+        std::cout << "Press Enter to step, 's' to view state, 'q' to quit.\n" << colors::RESET;
+    } else {
+        std::cout << colors::BOLD << colors::BLUE << "Automatic execution mode enabled.\n" << colors::RESET;
+    }
+#endif
+
+    while (cycles > 0) {
+        word inst = mem[cpu.PC];  // Store the current instruction address for printing
+
+        // Print execution state
+        print_current_execution(cpu, inst, mem);
+
+        // Handle manual stepping mode
+        if (manual_mode) {
+            // The state view and an abort both hand the registers out, so N and Z must be current
+            cpu.sync_flags();
+            int r = cpu_mode_decider(cpu, manual_mode, cycles, starting_cycles, completed_out);
+            if (r == ABORT_STATUS) {
+                return ABORT_STATUS;
+            }
+        }
+
+        u32 invalid_before = cpu.invalid_opcodes;
+        u32 rom_traps_before = mem.rom_write_traps;
+#ifdef EMULATOR_STACK_CHECKS
+        u32 stack_faults_before = cpu.stack_overflows + cpu.stack_underflows;
+#endif
+        u64 before = cpu.cycle_count;
+        completed = cpu.step(mem);
+        cycles -= static_cast<i32>(cpu.cycle_count - before);
+        ran_instructions = true;
+
+        // Report opcodes that went through the trap handler
+        if (cpu.invalid_opcodes != invalid_before) {
+            std::cout << "Invalid op code: 0x" << std::setw(2) << std::setfill('0') << std::hex
+                      << static_cast<int>(mem[cpu.last_invalid_pc]) << std::dec << " at address 0x" << std::hex
+                      << cpu.last_invalid_pc << std::dec << std::endl;
+        }
+
+        // Report stores into ROM mapped with RomWrites::Trap
+        if (mem.rom_write_traps != rom_traps_before) {
+            std::cout << "Write to ROM at address 0x" << std::hex << mem.last_rom_write << std::dec << " ignored"
+                      << std::endl;
+        }
+
+#ifdef EMULATOR_STACK_CHECKS
+        // Report pushes and pulls that wrapped SP around the stack page
+        if (cpu.stack_overflows + cpu.stack_underflows != stack_faults_before) {
+            const Cpu::StackFault& fault = cpu.last_stack_fault;
+            std::cout << "Stack " << (fault.overflow ? "overflow" : "underflow") << " at address 0x" << std::hex
+                      << fault.pc << std::dec << ", cycle " << fault.cycle << std::endl;
+        }
+#endif
+
+        if (completed) {
+            break;
+        }
+    }
+
+    // Mark as completed if:
+    // 1. We explicitly reached RTS or encountered a 0x00 opcode, OR
+    // 2. We executed at least one instruction and didn't run out of cycles
+    if (!completed && ran_instructions && cycles >= 0) {
+        completed = true;
+    }
+
+    // If we ran out of cycles before completion
+    if (!completed && cycles < 0) {
+        std::cout << colors::BOLD << colors::RED << "Warning:" << colors::RESET
+                  << "\tInsufficient cycles. Execution incomplete." << std::endl;
+        std::cout << "\tRequired: > " << starting_cycles << " cycles" << std::endl;
+        std::cout << "\tProvided: " << starting_cycles << " cycles" << std::endl;
+        std::cout << "\tUsed: " << starting_cycles - cycles << " cycles" << std::endl;
+    }
+
+    // Show final execution status if in manual mode
+    if (manual_mode) {
+        std::cout << colors::BOLD << colors::BLUE << "Execution " << (completed ? colors::GREEN : colors::RED)
+                  << (completed ? "completed" : "incomplete") << colors::BLUE << " after " << (starting_cycles - cycles)
+                  << " cycles.\n"
+                  << colors::RESET;
+    }
+
+    // If caller wants to know completion status
+    if (completed_out != nullptr) {
+        *completed_out = completed;
+    }
+
+    // Reset output to decimal mode for subsequent displays
+    std::cout << std::dec;
+
+    // Stepping leaves N and Z pending with lazy flags
+    cpu.sync_flags();
+
+    // Return the number of cycles actually used
+    return starting_cycles - cycles;
+}
+
+i32 cpu_mode_decider(const Cpu& cpu, bool manual_mode, i32& cycles, i32 starting_cycles, bool* completed_out) {
+    if (manual_mode) {
+        while (true) {
+            std::cout << colors::YELLOW << "[Step: Enter/s/q]: " << colors::RESET;
+            std::string input;
+            std::getline(std::cin, input);
+
+            // Convert input to lowercase for case-insensitive comparison
+            for (auto& c : input) {
+                c = std::tolower(c);
+            }
+
+            if (input.empty() || input == "y" || input == "yes") {
+                // Continue execution - just break from this loop
+                break;
+            } else if (input == "s" || input == "state") {
+                // Show CPU state without advancing
+                print_state(cpu, starting_cycles - cycles, false);
+                continue;
+            } else if (input == "q" || input == "quit") {
+                // Quit execution
+                std::cout << colors::BOLD << colors::BLUE << "Execution terminated by user.\n" << colors::RESET;
+
+                // If caller wants to know completion status
+                if (completed_out != nullptr) {
+                    *completed_out = false;
+                }
+
+                // Return the number of cycles actually used
+                return ABORT_STATUS;
+            } else {
+                std::cout << colors::RED << "Invalid input. Press Enter to continue, 's' for state, 'q' to quit.\n"
+                          << colors::RESET;
+                continue;
+            }
+        }
+    }
+    return starting_cycles - cycles;
+}
+
+void print_current_execution(const Cpu& cpu, word ins, Mem& mem) {
+    word operand_word = static_cast<word>(mem[cpu.PC]) | (static_cast<word>(mem[cpu.PC + 1]) << 8);
+
+    std::cout << colors::BOLD << colors::BLUE;
+    std::cout << "0x" << std::setfill('0') << std::setw(4) << std::hex << (cpu.PC) << ": ";
+    std::cout << colors::GREEN << "sp = 0x01" << std::setfill('0') << std::setw(2) << std::hex
+              << static_cast<int>(cpu.SP) << "  ";
+    std::cout << "pc = 0x" << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(cpu.PC) << "  ";
+    std::cout << colors::RESET << colors::BLUE;
+    std::cout << "ins = 0x" << std::setfill('0') << std::setw(2) << std::hex << static_cast<int>(ins);
+    std::cout << " [" << std::setfill(' ') << std::setw(10) << opcodes::from_byte(ins) << "]";
+    std::cout << " [argument (next 2-bytes) = 0x" << std::setfill('0') << std::setw(4) << std::hex << operand_word
+              << "]";
+    std::cout << colors::RESET << std::endl;
+    std::cout << std::dec;  // Ensure we print in decimal mode for the rest of the output
+}
+
+void print_state(const Cpu& cpu, int cycles_used, bool program_completed) {
+    // Save the current cout formatting state
+    auto flags = std::cout.flags();
+
+    // Create a nicer formatted output with borders and aligned values
+    std::cout << colors::GREEN << "\n";
+    std::cout << "┌───────────────── CPU STATE ─────────────────┐\n";
+    std::cout << "| " << colors::BOLD << "Execution " << (program_completed ? colors::GREEN : colors::RED)
+              << (program_completed ? "COMPLETED" : "INCOMPLETE") << colors::RESET << colors::GREEN << colors::BOLD
+              << " using " << cycles_used << " cycles" << std::setw(13) << std::setfill(' ') << " │\n";
+    std::cout << "├───────────────── REGISTERS ─────────────────┤\n";
+    // Register section
+    std::cout << "│ ";
+    std::cout << colors::BOLD << "PC" << colors::GREEN << " (16-bit): 0x" << std::setw(4) << std::setfill('0')
+              << std::hex << cpu.PC << " -- ";
+    std::cout << colors::BOLD << "SP" << colors::GREEN << " (8-bit): 0x01" << std::setw(2) << std::setfill('0')
+              << std::hex << static_cast<int>(cpu.SP) << "   │\n";
+
+    std::cout << "├─────────────────────────────────────────────┤\n";
+
+    // Display A, X, Y registers with both hex and decimal values
+    std::cout << "│ ";
+    std::cout << colors::BOLD << "A" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0') << std::hex
+              << static_cast<int>(cpu.A) << " (" << std::setw(3) << std::setfill(' ') << std::dec
+              << static_cast<int>(cpu.A)
+              << ")";
+
+    std::cout << "  " << colors::BOLD << "X" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0')
+              << std::hex << static_cast<int>(cpu.X) << " (" << std::setw(3) << std::setfill(' ') << std::dec
+              << static_cast<int>(cpu.X) << ")";
+
+    std::cout << "  " << colors::BOLD << "Y" << colors::GREEN << ": 0x" << std::setw(2) << std::setfill('0')
+              << std::hex << static_cast<int>(cpu.Y) << " (" << std::setw(3) << std::setfill(' ') << std::dec
+              << static_cast<int>(cpu.Y) << ")"
+              << " │\n";
+
+    // Status flags section
+    std::cout << "├─────────────── STATUS FLAGS ────────────────┤\n";
+    std::cout << "│  ";
+    std::cout << colors::BOLD << "N   V   U   B   D   I   Z   C" << colors::GREEN << "              │\n";
+
+    // Status byte in 6502 order, including N and Z still pending with lazy flags
+    byte status = cpu.status();
+    std::cout << "│ ";
+    for (int bit = 7; bit >= 0; --bit) {
+        std::cout << " " << ((status >> bit) & 1) << "  ";
+    }
+    std::cout << "            │\n";
+
+    std::cout << "└─────────────────────────────────────────────┘" << colors::RESET << "\n";
+
+    // Restore the original cout formatting state
+    std::cout.flags(flags);
+}
+
+}  // namespace frontend
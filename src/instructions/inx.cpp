@@ -0,0 +1,8 @@
+#include "instructions.h"
+
+namespace instructions {
+void INX(Cpu& cpu, Mem& mem) {
+    cpu.X++;  // Wraps from 0xFF to 0x00
+    cpu.set_nz(cpu.X);
+}
+}  // namespace instructions
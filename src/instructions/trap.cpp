@@ -0,0 +1,13 @@
+#include "instructions.h"
+
+namespace instructions {
+
+// Every opcode byte without an implementation lands here. It is charged the
+// single cycle of its opcode fetch from the opcode table. The event is
+// only recorded; reporting it is left to the front end.
+[[gnu::cold]] void TRAP(Cpu& cpu, Mem& mem) {
+    cpu.invalid_opcodes++;
+    cpu.last_invalid_pc = cpu.PC - 1;
+}
+
+}  // namespace instructions
@@ -0,0 +1,777 @@
+#include "jit.h"
+
+#include "block_cache.h"
+#include "cpu.h"
+#include "memory.h"
+
+#ifdef EMULATOR_JIT
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "dispatch.h"
+#include "op_codes.h"
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Host register assignment
+//
+// The translated code never calls out, so everything except RBX, RBP and R12
+// (saved in the prologue) is a caller-saved register.
+// -----------------------------------------------------------------------------
+enum Reg : int {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R9 = 9,
+    R10 = 10,
+    R11 = 11,
+    R12 = 12,
+    NONE = -1,
+};
+
+constexpr int CTX = RDI;    // JitContext*
+constexpr int MEM = RSI;    // Mem::data
+constexpr int PAGES = RDX;  // Mem::slow_stores
+constexpr int LOADS = R12;  // Mem::slow_loads
+constexpr int CYC = RCX;    // Remaining cycles
+constexpr int REG_A = R8;
+constexpr int REG_X = R9;
+constexpr int REG_Y = R10;
+constexpr int REG_SP = R11;
+constexpr int FLAGS = RBX;
+constexpr int T0 = RAX;  // Scratch, also the return value
+constexpr int T1 = RBP;  // Scratch
+
+// Condition codes for Jcc
+enum Cond : byte { JE = 0x4, JNE = 0x5, JS = 0x8, JNS = 0x9, JGE = 0xD };
+
+// -----------------------------------------------------------------------------
+// Emitter for the handful of x86-64 instructions the translator needs.
+// All operations on emulated registers use 32-bit or 8-bit forms; the host
+// registers always hold zero-extended bytes.
+// -----------------------------------------------------------------------------
+class Emitter {
+   public:
+    std::vector<byte> code;
+
+    size_t pos() const { return code.size(); }
+
+    void emit(byte b) { code.push_back(b); }
+
+    void imm32(u32 v) {
+        for (int i = 0; i < 4; ++i) {
+            emit(static_cast<byte>(v >> (8 * i)));
+        }
+    }
+
+    // REX prefix; `byte_reg` forces it for SPL/BPL/SIL/DIL
+    void rex(bool w, int reg, int index, int base, bool byte_reg = false) {
+        byte r = 0x40 | (w << 3) | ((reg >> 3) & 1) << 2 | ((index >= 0 ? index >> 3 : 0) & 1) << 1 |
+                 ((base >> 3) & 1);
+        bool low_byte = byte_reg && ((reg >= 4 && reg < 8) || (base >= 4 && base < 8));
+        if (r != 0x40 || low_byte) {
+            emit(r);
+        }
+    }
+
+    // [base + index + disp32]
+    void modrm_mem(int reg, int base, int index, i32 disp) {
+        if (index < 0 && (base & 7) != 4) {
+            emit(0x80 | (reg & 7) << 3 | (base & 7));
+        } else {
+            emit(0x80 | (reg & 7) << 3 | 4);
+            emit(((index < 0 ? 4 : index) & 7) << 3 | (base & 7));
+        }
+        imm32(static_cast<u32>(disp));
+    }
+
+    void modrm_rr(int reg, int rm) { emit(0xC0 | (reg & 7) << 3 | (rm & 7)); }
+
+    // movzx dst32, byte [base + index + disp]
+    void load8(int dst, int base, int index, i32 disp) {
+        rex(false, dst, index, base);
+        emit(0x0F);
+        emit(0xB6);
+        modrm_mem(dst, base, index, disp);
+    }
+
+    // mov byte [base + index + disp], src8
+    void store8(int src, int base, int index, i32 disp) {
+        byte r = 0x40 | ((src >> 3) & 1) << 2 | ((index >= 0 ? index >> 3 : 0) & 1) << 1 | ((base >> 3) & 1);
+        if (r != 0x40 || (src >= 4 && src < 8)) {
+            emit(r);
+        }
+        emit(0x88);
+        modrm_mem(src, base, index, disp);
+    }
+
+    // mov dst32, dword [base + disp] / mov dword [base + disp], src32
+    void load32(int dst, int base, i32 disp) {
+        rex(false, dst, NONE, base);
+        emit(0x8B);
+        modrm_mem(dst, base, NONE, disp);
+    }
+    void store32(int src, int base, i32 disp) {
+        rex(false, src, NONE, base);
+        emit(0x89);
+        modrm_mem(src, base, NONE, disp);
+    }
+
+    // mov dst64, qword [base + disp]
+    void load64(int dst, int base, i32 disp) {
+        rex(true, dst, NONE, base);
+        emit(0x8B);
+        modrm_mem(dst, base, NONE, disp);
+    }
+
+    // mov word [base + disp], src16
+    void store16(int src, int base, i32 disp) {
+        emit(0x66);
+        rex(false, src, NONE, base);
+        emit(0x89);
+        modrm_mem(src, base, NONE, disp);
+    }
+
+    // mov dst32, imm32
+    void mov_imm(int dst, u32 value) {
+        rex(false, 0, NONE, dst);
+        emit(0xB8 + (dst & 7));
+        imm32(value);
+    }
+
+    // mov dst32, src32
+    void mov(int dst, int src) {
+        rex(false, src, NONE, dst);
+        emit(0x89);
+        modrm_rr(src, dst);
+    }
+
+    // movzx dst32, src8 / movzx dst32, src16
+    void movzx8(int dst, int src) {
+        rex(false, dst, NONE, src, true);
+        emit(0x0F);
+        emit(0xB6);
+        modrm_rr(dst, src);
+    }
+    void movzx16(int dst, int src) {
+        rex(false, dst, NONE, src);
+        emit(0x0F);
+        emit(0xB7);
+        modrm_rr(dst, src);
+    }
+
+    // lea dst32, [base + disp]
+    void lea(int dst, int base, i32 disp) {
+        rex(false, dst, NONE, base);
+        emit(0x8D);
+        modrm_mem(dst, base, NONE, disp);
+    }
+
+    // add/or/and/sub/cmp r32, imm32 (`ext` is the /digit of opcode 81)
+    void alu_imm(int ext, int reg, u32 value) {
+        rex(false, 0, NONE, reg);
+        emit(0x81);
+        modrm_rr(ext, reg);
+        imm32(value);
+    }
+    void add_imm(int reg, u32 value) { alu_imm(0, reg, value); }
+    void or_imm(int reg, u32 value) { alu_imm(1, reg, value); }
+    void and_imm(int reg, u32 value) { alu_imm(4, reg, value); }
+    void sub_imm(int reg, u32 value) { alu_imm(5, reg, value); }
+    void cmp_imm(int reg, u32 value) { alu_imm(7, reg, value); }
+
+    // or dst32, src32 / add dst32, src32 / sub dst32, src32
+    void or_rr(int dst, int src) {
+        rex(false, src, NONE, dst);
+        emit(0x09);
+        modrm_rr(src, dst);
+    }
+    void add_rr(int dst, int src) {
+        rex(false, src, NONE, dst);
+        emit(0x01);
+        modrm_rr(src, dst);
+    }
+    void sub_rr(int dst, int src) {
+        rex(false, src, NONE, dst);
+        emit(0x29);
+        modrm_rr(src, dst);
+    }
+
+    // test r8, r8
+    void test8(int reg) {
+        rex(false, reg, NONE, reg, true);
+        emit(0x84);
+        modrm_rr(reg, reg);
+    }
+
+    // inc r8 / dec r8
+    void inc8(int reg) {
+        rex(false, 0, NONE, reg, true);
+        emit(0xFE);
+        modrm_rr(0, reg);
+    }
+    void dec8(int reg) {
+        rex(false, 0, NONE, reg, true);
+        emit(0xFE);
+        modrm_rr(1, reg);
+    }
+
+    // shl/shr r32, imm8
+    void shl(int reg, byte count) {
+        rex(false, 0, NONE, reg);
+        emit(0xC1);
+        modrm_rr(4, reg);
+        emit(count);
+    }
+    void shr(int reg, byte count) {
+        rex(false, 0, NONE, reg);
+        emit(0xC1);
+        modrm_rr(5, reg);
+        emit(count);
+    }
+
+    // cmp byte [base + index + disp], imm8
+    void cmp_mem8(int base, int index, i32 disp, byte value) {
+        rex(false, 0, index, base);
+        emit(0x80);
+        modrm_mem(7, base, index, disp);
+        emit(value);
+    }
+
+    // Jumps with a 32-bit displacement; return the position to patch
+    size_t jcc(Cond cond) {
+        emit(0x0F);
+        emit(0x80 | cond);
+        imm32(0);
+        return pos() - 4;
+    }
+    size_t jmp() {
+        emit(0xE9);
+        imm32(0);
+        return pos() - 4;
+    }
+    void jcc_to(Cond cond, size_t target) { patch(jcc(cond), target); }
+    void jmp_to(size_t target) { patch(jmp(), target); }
+
+    // Points the displacement at `at` to `target`
+    void patch(size_t at, size_t target) {
+        i32 rel = static_cast<i32>(target) - static_cast<i32>(at + 4);
+        std::memcpy(&code[at], &rel, sizeof(rel));
+    }
+    void bind(size_t at) { patch(at, pos()); }
+
+    void push(int reg) {
+        if (reg >= 8) {
+            emit(0x41);
+        }
+        emit(0x50 + (reg & 7));
+    }
+    void pop(int reg) {
+        if (reg >= 8) {
+            emit(0x41);
+        }
+        emit(0x58 + (reg & 7));
+    }
+    void ret() { emit(0xC3); }
+};
+
+// Where N and Z currently come from. Every instruction that writes A, X or Y
+// also sets N and Z from it, so they are tracked lazily and only written into
+// the flags register when the flags byte is needed.
+enum class NZ : byte { Flags, A, X, Y };
+
+int nz_register(NZ source) {
+    switch (source) {
+        case NZ::A:
+            return REG_A;
+        case NZ::X:
+            return REG_X;
+        case NZ::Y:
+            return REG_Y;
+        default:
+            return NONE;
+    }
+}
+
+// A way out of the block before instruction `index`, taken when a store
+// has to go through Mem::write, e.g. because its page holds cached code
+struct SideExit {
+    size_t jump;      // Jcc to patch
+    word pc;          // Address of the instruction that is left to the interpreter
+    u32 cycles_back;  // Cycles of the instructions that did not run
+    NZ nz;            // Flag source at that point
+};
+
+class Translator {
+   public:
+    explicit Translator(const Block& block) : block(block) {}
+
+    // Returns false when the block holds an instruction that is not translated
+    bool translate();
+
+    std::vector<byte>& code() { return out.code; }
+
+   private:
+    const Block& block;
+    Emitter out;
+    NZ nz = NZ::Flags;
+    size_t top = 0;  // Start of the block body, where a native loop jumps back to
+    std::vector<SideExit> exits;
+    std::vector<size_t> to_epilogue;
+
+    // Cycles of ops[index..end]
+    u32 cycles_from(size_t index) const {
+        u32 sum = 0;
+        for (size_t i = index; i < block.ops.size(); ++i) {
+            sum += block.ops[i].cycles;
+        }
+        return sum;
+    }
+
+    word pc_of(size_t index) const { return index == 0 ? block.start : block.ops[index - 1].next_pc; }
+
+    // Writes N and Z from their current source into the flags register
+    void materialize(NZ source) {
+        int reg = nz_register(source);
+        if (reg == NONE) {
+            return;
+        }
+        out.and_imm(FLAGS, static_cast<byte>(~(Cpu::STATUS_N | Cpu::STATUS_Z)));
+        out.test8(reg);
+        size_t not_zero = out.jcc(JNE);
+        out.or_imm(FLAGS, Cpu::STATUS_Z);
+        out.bind(not_zero);
+        out.test8(reg);  // The OR above clobbered SF
+        size_t positive = out.jcc(JNS);
+        out.or_imm(FLAGS, Cpu::STATUS_N);
+        out.bind(positive);
+    }
+
+    // Leaves the block before instruction `index` when the `table` entry for
+    // the page in `page_reg` (or the constant `page`) is set
+    void guard(int table, size_t index, int page_reg, byte page) {
+        if (page_reg == NONE) {
+            out.cmp_mem8(table, NONE, page, 0);
+        } else {
+            out.cmp_mem8(table, page_reg, 0, 0);
+        }
+        exits.push_back({out.jcc(JNE), pc_of(index), cycles_from(index), nz});
+    }
+
+    // Stores that have to go through Mem::write
+    void guard_store(size_t index, int page_reg, byte page) { guard(PAGES, index, page_reg, page); }
+
+    // Loads from pages that are not the RAM in `data`
+    void guard_load(size_t index, int page_reg, byte page) { guard(LOADS, index, page_reg, page); }
+
+    // Computes the effective address of an indexed or indirect operand into T0
+    void address(AddrMode mode, word operand) {
+        switch (mode) {
+            case AddrMode::ZPX:
+            case AddrMode::ZPY:
+                out.lea(T0, mode == AddrMode::ZPX ? REG_X : REG_Y, operand);
+                out.movzx8(T0, T0);  // Zero page wraparound
+                break;
+            case AddrMode::ABSX:
+            case AddrMode::ABSY:
+                out.lea(T0, mode == AddrMode::ABSX ? REG_X : REG_Y, operand);
+                out.movzx16(T0, T0);
+                break;
+            case AddrMode::INDX:
+                out.lea(T0, REG_X, operand);
+                out.movzx8(T0, T0);
+                out.load8(T1, MEM, T0, 0);
+                out.inc8(T0);  // Pointer high byte wraps within the zero page
+                out.load8(T0, MEM, T0, 0);
+                out.shl(T0, 8);
+                out.or_rr(T0, T1);
+                break;
+            case AddrMode::INDY:
+                out.load8(T0, MEM, NONE, static_cast<byte>(operand + 1));
+                out.shl(T0, 8);
+                out.load8(T1, MEM, NONE, static_cast<byte>(operand));
+                out.or_rr(T0, T1);
+                out.add_rr(T0, REG_Y);
+                out.movzx16(T0, T0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Charges the page-crossing cycle of an indexed read: the carry out of
+    // the base's low byte plus the index. Right after address(), T1 still
+    // holds the pointer's low byte for (ind),Y.
+    void page_cross_penalty(AddrMode mode, word operand) {
+        if (mode == AddrMode::ABSX || mode == AddrMode::ABSY) {
+            out.lea(T1, mode == AddrMode::ABSX ? REG_X : REG_Y, operand & 0xFF);
+        } else {
+            out.add_rr(T1, REG_Y);
+        }
+        out.shr(T1, 8);
+        out.sub_rr(CYC, T1);
+    }
+
+    void load(size_t index, int reg, NZ source, AddrMode mode, word operand, bool penalty) {
+        if (mode == AddrMode::IMM) {
+            out.mov_imm(reg, static_cast<byte>(operand));
+        } else if (mode == AddrMode::ZP || mode == AddrMode::ABS) {
+            guard_load(index, NONE, operand >> 8);
+            out.load8(reg, MEM, NONE, operand);
+        } else {
+            if (mode == AddrMode::INDX || mode == AddrMode::INDY) {
+                guard_load(index, NONE, 0x00);  // The pointer
+            }
+            address(mode, operand);
+            out.mov(T1, T0);
+            out.shr(T1, 8);
+            guard_load(index, T1, 0);
+            if (penalty) {
+                if (mode == AddrMode::INDY) {
+                    out.load8(T1, MEM, NONE, static_cast<byte>(operand));  // The guard clobbered the pointer's low byte
+                }
+                page_cross_penalty(mode, operand);
+            }
+            out.load8(reg, MEM, T0, 0);
+        }
+        nz = source;
+    }
+
+    void store(size_t index, int reg, AddrMode mode, word operand) {
+        if (mode == AddrMode::ZP || mode == AddrMode::ABS) {
+            guard_store(index, NONE, operand >> 8);
+            out.store8(reg, MEM, NONE, operand);
+        } else {
+            if (mode == AddrMode::INDX || mode == AddrMode::INDY) {
+                guard_load(index, NONE, 0x00);  // The pointer
+            }
+            address(mode, operand);
+            out.mov(T1, T0);
+            out.shr(T1, 8);
+            guard_store(index, T1, 0);
+            out.store8(reg, MEM, T0, 0);
+        }
+    }
+
+    // Pushes `reg` onto the stack page
+    void push(int reg) {
+        out.store8(reg, MEM, REG_SP, 0x0100);
+        out.dec8(REG_SP);
+    }
+
+    // Pulls a byte from the stack page into `reg`
+    void pull(int reg) {
+        out.inc8(REG_SP);
+        out.load8(reg, MEM, REG_SP, 0x0100);
+    }
+
+    // Stores the exit PC and the return value, then jumps to the epilogue
+    void leave(word pc, bool returned) {
+        materialize(nz);
+        out.mov_imm(T0, pc);
+        out.store16(T0, CTX, offsetof(JitContext, pc));
+        out.mov_imm(T0, returned ? 1 : 0);
+        to_epilogue.push_back(out.jmp());
+    }
+
+    bool translate_op(size_t index);
+};
+
+bool Translator::translate_op(size_t index) {
+    const MicroOp& uop = block.ops[index];
+    const AddrMode mode = dispatch::table[uop.opcode].mode;
+    const bool penalty = dispatch::table[uop.opcode].penalty == Penalty::PageCross;
+
+#ifdef EMULATOR_STACK_CHECKS
+    // Pushes and pulls stay in the interpreter, where Cpu::push8/pull8 check SP
+    const dispatch::Access access = dispatch::table[uop.opcode].access;
+    if (access == dispatch::Access::Push || access == dispatch::Access::Pull || access == dispatch::Access::Call ||
+        access == dispatch::Access::Return) {
+        return false;
+    }
+#endif
+
+    switch (static_cast<Op>(uop.opcode)) {
+        case Op::LDA_IM:
+        case Op::LDA_ZP:
+        case Op::LDA_ZPX:
+        case Op::LDA_AB:
+        case Op::LDA_ABSX:
+        case Op::LDA_ABSY:
+        case Op::LDA_INX:
+        case Op::LDA_INY:
+            load(index, REG_A, NZ::A, mode, uop.operand, penalty);
+            return true;
+        case Op::LDX_IM:
+        case Op::LDX_ZP:
+        case Op::LDX_ZPY:
+        case Op::LDX_AB:
+        case Op::LDX_ABSY:
+            load(index, REG_X, NZ::X, mode, uop.operand, penalty);
+            return true;
+        case Op::LDY_IM:
+        case Op::LDY_ZP:
+        case Op::LDY_ZPX:
+        case Op::LDY_AB:
+        case Op::LDY_ABSX:
+            load(index, REG_Y, NZ::Y, mode, uop.operand, penalty);
+            return true;
+        case Op::STA_ZP:
+        case Op::STA_ZPX:
+        case Op::STA_ABS:
+        case Op::STA_ABSX:
+        case Op::STA_ABSY:
+        case Op::STA_INX:
+        case Op::STA_INY:
+            store(index, REG_A, mode, uop.operand);
+            return true;
+        case Op::STX_ZP:
+        case Op::STX_ZPY:
+        case Op::STX_ABS:
+            store(index, REG_X, mode, uop.operand);
+            return true;
+        case Op::STY_ZP:
+        case Op::STY_ZPX:
+        case Op::STY_ABS:
+            store(index, REG_Y, mode, uop.operand);
+            return true;
+        case Op::NOP:
+            return true;
+        case Op::PHA:
+            guard_store(index, NONE, 0x01);
+            push(REG_A);
+            return true;
+        case Op::PHP:
+            guard_store(index, NONE, 0x01);
+            materialize(nz);
+            nz = NZ::Flags;
+            push(FLAGS);
+            return true;
+        case Op::PLA:
+            guard_load(index, NONE, 0x01);
+            pull(REG_A);
+            nz = NZ::A;
+            return true;
+        case Op::PLP:
+            guard_load(index, NONE, 0x01);
+            pull(FLAGS);
+            nz = NZ::Flags;
+            return true;
+        case Op::TSX:
+            out.mov(REG_X, REG_SP);
+            nz = NZ::X;
+            return true;
+        case Op::TXS:
+            out.mov(REG_SP, REG_X);
+            return true;
+        case Op::INX:
+            out.inc8(REG_X);
+            nz = NZ::X;
+            return true;
+        case Op::JMP:
+            if (uop.operand == block.start) {
+                // Loop back natively while the budget covers another iteration
+                materialize(nz);
+                nz = NZ::Flags;
+                out.cmp_imm(CYC, block.cycles + block.penalties);
+                out.jcc_to(JGE, top);
+            }
+            leave(uop.operand, false);
+            return true;
+        case Op::JSR: {
+            guard_store(index, NONE, 0x01);
+            word ret = static_cast<word>(uop.next_pc - 1);
+            out.mov_imm(T0, ret >> 8);
+            push(T0);
+            out.mov_imm(T0, ret & 0xFF);
+            push(T0);
+            leave(uop.operand, false);
+            return true;
+        }
+        case Op::RTS:
+            guard_load(index, NONE, 0x01);
+            materialize(nz);
+            pull(T1);
+            out.mov(T0, T1);
+            pull(T1);
+            out.shl(T1, 8);
+            out.or_rr(T0, T1);
+            out.add_imm(T0, 1);
+            out.store16(T0, CTX, offsetof(JitContext, pc));
+            out.mov_imm(T0, 1);
+            to_epilogue.push_back(out.jmp());
+            return true;
+        default:
+            return false;  // JMP indirect and invalid opcodes stay in the interpreter
+    }
+}
+
+bool Translator::translate() {
+    // Prologue: RBX, RBP and R12 are callee-saved, everything else is free
+    out.push(RBX);
+    out.push(RBP);
+    out.push(R12);
+    out.load64(MEM, CTX, offsetof(JitContext, mem));
+    out.load64(PAGES, CTX, offsetof(JitContext, slow_stores));
+    out.load64(LOADS, CTX, offsetof(JitContext, slow_loads));
+    out.load32(CYC, CTX, offsetof(JitContext, cycles));
+    out.load8(REG_A, CTX, NONE, offsetof(JitContext, a));
+    out.load8(REG_X, CTX, NONE, offsetof(JitContext, x));
+    out.load8(REG_Y, CTX, NONE, offsetof(JitContext, y));
+    out.load8(REG_SP, CTX, NONE, offsetof(JitContext, sp));
+    out.load8(FLAGS, CTX, NONE, offsetof(JitContext, flags));
+
+    // The whole block is charged up front
+    top = out.pos();
+    out.sub_imm(CYC, block.cycles);
+
+    for (size_t i = 0; i < block.ops.size(); ++i) {
+        if (!translate_op(i)) {
+            return false;
+        }
+    }
+
+    // Blocks cut at MAX_BLOCK_OPS fall through to the next instruction
+    byte last = block.ops.back().opcode;
+    if (last != op(Op::JMP) && last != op(Op::JSR) && last != op(Op::RTS)) {
+        leave(block.ops.back().next_pc, false);
+    }
+
+    // Side exits refund the instructions that did not run
+    for (const SideExit& exit : exits) {
+        out.bind(exit.jump);
+        out.add_imm(CYC, exit.cycles_back);
+        materialize(exit.nz);
+        out.mov_imm(T0, exit.pc);
+        out.store16(T0, CTX, offsetof(JitContext, pc));
+        out.mov_imm(T0, 0);
+        to_epilogue.push_back(out.jmp());
+    }
+
+    // Epilogue: write the emulated state back
+    for (size_t jump : to_epilogue) {
+        out.bind(jump);
+    }
+    out.store32(CYC, CTX, offsetof(JitContext, cycles));
+    out.store8(REG_A, CTX, NONE, offsetof(JitContext, a));
+    out.store8(REG_X, CTX, NONE, offsetof(JitContext, x));
+    out.store8(REG_Y, CTX, NONE, offsetof(JitContext, y));
+    out.store8(REG_SP, CTX, NONE, offsetof(JitContext, sp));
+    out.store8(FLAGS, CTX, NONE, offsetof(JitContext, flags));
+    out.pop(R12);
+    out.pop(RBP);
+    out.pop(RBX);
+    out.ret();
+    return true;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Jit
+// -----------------------------------------------------------------------------
+Jit::~Jit() {
+    if (arena != nullptr) {
+        munmap(arena, ARENA_SIZE);
+    }
+}
+
+bool Jit::supported() {
+    return true;
+}
+
+Jit::Status Jit::compile(Block& block) {
+    if (unavailable) {
+        return Status::Unsupported;
+    }
+    if (arena == nullptr) {
+        void* p = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            unavailable = true;
+            return Status::Unsupported;
+        }
+        arena = static_cast<byte*>(p);
+    }
+
+    Translator translator(block);
+    if (!translator.translate()) {
+        return Status::Unsupported;
+    }
+
+    const std::vector<byte>& code = translator.code();
+    size_t size = (code.size() + 15) & ~static_cast<size_t>(15);
+    if (used + size > ARENA_SIZE) {
+        return Status::Full;
+    }
+
+    // The first page may already hold earlier blocks, so it is made writable again while the code is copied
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = used / page_size * page_size;
+    size_t last = (used + size + page_size - 1) / page_size * page_size;
+    if (mprotect(arena + first, last - first, PROT_READ | PROT_WRITE) != 0) {
+        return Status::Unsupported;
+    }
+    std::memcpy(arena + used, code.data(), code.size());
+    if (mprotect(arena + first, last - first, PROT_READ | PROT_EXEC) != 0) {
+        // Earlier blocks on these pages can no longer run; have the caller drop them all
+        unavailable = true;
+        return Status::Full;
+    }
+    block.native = reinterpret_cast<NativeCode>(arena + used);
+    used += size;
+    return Status::Compiled;
+}
+
+bool Jit::run(const Block& block, Cpu& cpu, Mem& mem, u64 deadline) {
+    // Native code counts a 32-bit budget down; a longer one is split across calls
+    i32 budget = static_cast<i32>(std::min<u64>(deadline - cpu.cycle_count, std::numeric_limits<i32>::max()));
+    JitContext ctx{mem.data, mem.slow_stores, mem.slow_loads, budget, cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.status()};
+    int returned = block.native(&ctx);
+
+    cpu.cycle_count += static_cast<u64>(budget - ctx.cycles);
+    cpu.PC = ctx.pc;
+    cpu.A = ctx.a;
+    cpu.X = ctx.x;
+    cpu.Y = ctx.y;
+    cpu.SP = ctx.sp;
+    cpu.set_flags(ctx.flags);
+    return returned != 0;
+}
+
+void Jit::reset() {
+    used = 0;
+}
+
+#else
+
+// Without the recompiler every block stays in the interpreter
+Jit::~Jit() = default;
+
+bool Jit::supported() {
+    return false;
+}
+
+Jit::Status Jit::compile(Block&) {
+    return Status::Unsupported;
+}
+
+bool Jit::run(const Block&, Cpu&, Mem&, u64) {
+    return false;
+}
+
+void Jit::reset() {}
+
+#endif  // EMULATOR_JIT
@@ -1,7 +1,9 @@
 #include <iostream>
 
+#include "colors.h"
 #include "cpu.h"
 #include "demo_programs.h"
+#include "frontend.h"
 #include "memory.h"
 #include "op_codes.h"
 #include "reader.h"
@@ -24,10 +26,10 @@ int main() {
     binary_reader::read_from_array(cpu, mem, lda_demo);
 
     bool program_completed = false;
-    i32 cycles_used = cpu.execute(100, mem, &program_completed);
+    i32 cycles_used = frontend::execute(cpu, 100, mem, &program_completed);
 
     std::cout << "\nLDA Demo completed. Final CPU state:\n";
-    cpu.print_state(cycles_used, program_completed);
+    frontend::print_state(cpu, cycles_used, program_completed);
 
     return 0;
 }
@@ -1,19 +1,287 @@
 #include "memory.h"
 
+#include <algorithm>
+
+#include "block_cache.h"
+
+Mem::Mem() {
+    // `data` starts out uninitialized, so the first init() clears all of it
+    std::memset(touched_bits, 0xFF, sizeof(touched_bits));
+    for (u32 page = 0; page < NUM_PAGES; ++page) {
+        ram_pages[page] = data + page * PAGE_SIZE;
+        pages[page] = {ram_pages[page], ram_pages[page]};
+        slow_stores[page] = 0;
+        slow_loads[page] = 0;
+    }
+}
+
+Mem::~Mem() = default;
+
 void Mem::init() {
-    std::memset(data, 0, MAX_MEM);  // Zero out the memory block
+    rom_write_traps = 0;
+    last_rom_write = 0;
+
+    if (shared_image) {
+        for (u32 page = 0; page < NUM_PAGES; ++page) {
+            if (mappings[page].type == PageType::Shared) {
+                unmap(static_cast<byte>(page), 1);
+            }
+        }
+        shared_image.reset();
+    }
+
+    if (reset == ResetMode::Full) {
+        std::memset(data, 0, MAX_MEM);  // Zero out the memory block
+    } else {
+        // Zero out the pages written since the last init and watch them again.
+        // Untouched pages still have no write pointer.
+        for (u32 i = 0; i < NUM_PAGES / 64; ++i) {
+            u64 bits = touched_bits[i];
+            touched_bits[i] = 0;
+            for (; bits != 0; bits &= bits - 1) {
+                byte page = static_cast<byte>(i * 64 + __builtin_ctzll(bits));
+                std::memset(data + page * PAGE_SIZE, 0, PAGE_SIZE);
+                update_write_pointer(page);
+            }
+        }
+    }
+
+    // Nothing that was decoded before is valid any more
+    if (code_cache) {
+        code_cache->clear();
+    }
+}
+
+void Mem::write_word(word value, u32 address) {
+    write(address, value & 0xFF);    // Low byte first (little-endian)
+    write(address + 1, value >> 8);  // High byte second
+}
+
+void Mem::load(u32 addr, const byte* bytes, u32 size) {
+    if (addr >= MAX_MEM) {
+        return;
+    }
+    size = std::min(size, MAX_MEM - addr);
+    while (size > 0) {
+        u32 offset = addr & 0xFF;
+        u32 chunk = std::min(size, PAGE_SIZE - offset);
+        if (slow_stores[addr >> 8]) {
+            prepare_write(addr);
+        }
+        std::memcpy(ram_page(addr >> 8) + offset, bytes, chunk);
+        addr += chunk;
+        bytes += chunk;
+        size -= chunk;
+    }
+}
+
+void Mem::map_ram(byte first_page, u32 count, byte* host) {
+    for (u32 i = 0; i < count; ++i) {
+        map(first_page + i, {PageType::Ram, nullptr}, host + i * PAGE_SIZE, host + i * PAGE_SIZE);
+    }
+}
+
+bool Mem::repoint(byte first_page, u32 count, byte* host) {
+    if (first_page + count > NUM_PAGES) {
+        return false;
+    }
+    for (u32 page = first_page; page < first_page + count; ++page) {
+        bool rom = mappings[page].type == PageType::Rom && !mappings[page].owner;
+        bool ram = mappings[page].type == PageType::Ram && ram_pages[page] != data + page * PAGE_SIZE;
+        if (!rom && !ram) {
+            return false;
+        }
+    }
+
+    // The pages stay remapped, so flat(), slow_loads and slow_stores do not change
+    for (u32 i = 0; i < count; ++i) {
+        byte page = first_page + i;
+        byte* bytes = host + i * PAGE_SIZE;
+        if (code_pages[page]) {
+            invalidate_code(page * PAGE_SIZE);
+        }
+        pages[page].read = bytes;
+        if (mappings[page].type == PageType::Ram) {
+            ram_pages[page] = bytes;
+            pages[page].write = pages[page].write ? bytes : nullptr;
+        }
+    }
+    return true;
+}
+
+void Mem::map_rom(byte first_page, u32 count, const byte* host, RomWrites writes,
+                  std::shared_ptr<const void> owner) {
+    for (u32 i = 0; i < count; ++i) {
+        byte page = first_page + i;
+        map(page, {PageType::Rom, nullptr, writes, owner}, host + i * PAGE_SIZE, data + page * PAGE_SIZE);
+    }
+}
+
+void Mem::map_io(byte first_page, u32 count, IoHandler& handler) {
+    for (u32 i = 0; i < count; ++i) {
+        byte page = first_page + i;
+        map(page, {PageType::Io, &handler}, nullptr, data + page * PAGE_SIZE);
+    }
+}
+
+void Mem::unmap(byte first_page, u32 count) {
+    map_ram(first_page, count, data + first_page * PAGE_SIZE);
+}
+
+void Mem::map_shared(const byte* image, std::shared_ptr<const void> owner) {
+    for (u32 page = 0; page < NUM_PAGES; ++page) {
+        byte* own = data + page * PAGE_SIZE;
+        bool ram = mappings[page].type == PageType::Ram && ram_pages[page] == own;
+        if (ram || mappings[page].type == PageType::Shared) {
+            // ram_pages points into the image, see ram_page()
+            byte* shared = const_cast<byte*>(image + page * PAGE_SIZE);
+            map(static_cast<byte>(page), {PageType::Shared, nullptr}, shared, shared);
+        }
+    }
+    shared_image = std::move(owner);
+}
+
+void Mem::map(byte page, const Mapping& mapping, const byte* read, byte* ram) {
+    bool was_remapped = mappings[page].type != PageType::Ram || ram_pages[page] != data + page * PAGE_SIZE;
+    bool is_remapped = mapping.type != PageType::Ram || ram != data + page * PAGE_SIZE;
+    remapped_pages += is_remapped - was_remapped;
+
+    mappings[page] = mapping;
+    ram_pages[page] = ram;
+    pages[page].read = read;
+    slow_loads[page] = read != data + page * PAGE_SIZE;
+    update_write_pointer(page);
+
+    // Whatever was decoded from the old mapping is stale
+    if (code_pages[page]) {
+        invalidate_code(page * PAGE_SIZE);
+    }
+}
+
+byte Mem::read_io(u32 addr) const {
+    return mappings[addr >> 8].io->read(static_cast<word>(addr));
+}
+
+void Mem::write_slow(u32 addr, byte value) {
+    byte page = static_cast<byte>(addr >> 8);
+    if (code_pages[page]) {
+        invalidate_code(addr);
+    }
+
+    switch (mappings[page].type) {
+        case PageType::Shared:
+            unshare(page);
+            [[fallthrough]];
+        case PageType::Ram:
+            if (tracking && !dirty(page)) {
+                mark_dirty(page);
+            }
+            if (!touched(page)) {
+                mark_touched(page);
+            }
+            ram_pages[page][addr & 0xFF] = value;
+            break;
+        case PageType::Rom:
+            // Writes to ROM are dropped
+            if (mappings[page].rom_writes == RomWrites::Trap) {
+                rom_write_traps++;
+                last_rom_write = static_cast<word>(addr);
+            }
+            break;
+        case PageType::Io:
+            mappings[page].io->write(static_cast<word>(addr), value);
+            break;
+    }
+}
+
+void Mem::prepare_write(u32 addr) {
+    byte page = static_cast<byte>(addr >> 8);
+    if (code_pages[page]) {
+        invalidate_code(addr);
+    }
+    if (mappings[page].type == PageType::Shared) {
+        unshare(page);
+    }
+    if (tracking && !dirty(page)) {
+        mark_dirty(page);
+    }
+    if (!touched(page)) {
+        mark_touched(page);  // Also covers the RAM under ROM and I/O pages
+    }
+}
+
+void Mem::unshare(byte page) {
+    touched_bits[page >> 6] |= u64{1} << (page & 63);
+    std::memcpy(data + page * PAGE_SIZE, pages[page].read, PAGE_SIZE);
+    map(page, {PageType::Ram, nullptr}, data + page * PAGE_SIZE, data + page * PAGE_SIZE);
+}
+
+void Mem::set_reset_mode(ResetMode mode) {
+    reset = mode;
+
+    // Stores made in Full mode were not recorded
+    std::memset(touched_bits, 0xFF, sizeof(touched_bits));
+    for (u32 page = 0; page < NUM_PAGES; ++page) {
+        update_write_pointer(static_cast<byte>(page));
+    }
 }
 
-void Mem::write_word(i32& cycles, word value, u32 address) {
-    data[address] = (value & 0xFF);    // Low byte first (little-endian)
-    data[address + 1] = (value >> 8);  // High byte second
-    cycles -= 2;
+void Mem::track_writes(bool enable) {
+    tracking = enable;
+    clear_dirty();
 }
 
-byte Mem::operator[](u32 addr) const {
-    return data[addr];
+u32 Mem::dirty_count() const {
+    u32 count = 0;
+    for (u64 bits : dirty_bits) {
+        count += __builtin_popcountll(bits);
+    }
+    return count;
+}
+
+void Mem::clear_dirty() {
+    std::memset(dirty_bits, 0, sizeof(dirty_bits));
+    for (u32 page = 0; page < NUM_PAGES; ++page) {
+        update_write_pointer(static_cast<byte>(page));
+    }
+}
+
+void Mem::mark_dirty(byte page) {
+    dirty_bits[page >> 6] |= u64{1} << (page & 63);
+    generations[page]++;
+    update_write_pointer(page);
+}
+
+void Mem::mark_touched(byte page) {
+    touched_bits[page >> 6] |= u64{1} << (page & 63);
+    update_write_pointer(page);
+}
+
+void Mem::update_write_pointer(byte page) {
+    bool recorded = (!tracking || dirty(page)) && (reset == ResetMode::Full || touched(page));
+    bool direct = mappings[page].type == PageType::Ram && !code_pages[page] && recorded;
+    pages[page].write = direct ? ram_pages[page] : nullptr;
+    slow_stores[page] = !direct || ram_pages[page] != data + page * PAGE_SIZE;
+}
+
+void Mem::invalidate_code(u32 addr) {
+    u32 page = addr >> 8;
+    if (code_cache) {
+        code_cache->invalidate_page(static_cast<byte>(page));
+    }
+    clear_code_page(static_cast<byte>(page));
+}
+
+void Mem::clear_code_page(byte page) {
+    code_pages[page] = 0;
+
+    // Stores to the page may go straight to memory again
+    update_write_pointer(page);
 }
 
-byte& Mem::operator[](u32 addr) {
-    return data[addr];
+BlockCache& Mem::blocks() {
+    if (!code_cache) {
+        code_cache = std::make_unique<BlockCache>(*this);
+    }
+    return *code_cache;
 }
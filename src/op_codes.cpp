@@ -51,8 +51,60 @@ std::string from_byte(byte opcode) {
             return "LDY_AB";
         case 0xBC:
             return "LDY_ABSX";
-        default:
-            return "Unknown opcode: 0x" + std::to_string(opcode);
+        // STA opcodes
+        case 0x85:
+            return "STA_ZP";
+        case 0x95:
+            return "STA_ZPX";
+        case 0x8D:
+            return "STA_ABS";
+        case 0x9D:
+            return "STA_ABSX";
+        case 0x99:
+            return "STA_ABSY";
+        case 0x81:
+            return "STA_INX";
+        case 0x91:
+            return "STA_INY";
+        // STX opcodes
+        case 0x86:
+            return "STX_ZP";
+        case 0x96:
+            return "STX_ZPY";
+        case 0x8E:
+            return "STX_ABS";
+        // STY opcodes
+        case 0x84:
+            return "STY_ZP";
+        case 0x94:
+            return "STY_ZPX";
+        case 0x8C:
+            return "STY_ABS";
+        // Jump opcodes
+        case 0x4C:
+            return "JMP";
+        case 0x6C:
+            return "JMPI";
+        // Stack opcodes
+        case 0x48:
+            return "PHA";
+        case 0x08:
+            return "PHP";
+        case 0x68:
+            return "PLA";
+        case 0x28:
+            return "PLP";
+        case 0xBA:
+            return "TSX";
+        case 0x9A:
+            return "TXS";
+        // Increment opcodes
+        case 0xE8:
+            return "INX";
+        default: {
+            const char* digits = "0123456789ABCDEF";
+            return std::string("Unknown opcode: 0x") + digits[opcode >> 4] + digits[opcode & 0x0F];
+        }
     }
 }
 }  // namespace opcodes
@@ -1,11 +1,601 @@
 #include "reader.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "banked_memory.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EMULATOR_HAS_MMAP
+#endif
+
 namespace binary_reader {
-void read_from_array(Cpu& cpu, Mem& mem, const std::map<u32, std::vector<byte>> data) {
+
+namespace {
+
+// Read-only view of a whole file: an mmap where the platform has one, a
+// buffered copy elsewhere. Empty if the file cannot be read or has no bytes.
+class FileView {
+   public:
+    explicit FileView(const std::string& path) {
+#ifdef EMULATOR_HAS_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                bytes = static_cast<const byte*>(p);
+                length = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (file) {
+            buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            bytes = buffer.data();
+            length = buffer.size();
+        }
+#endif
+    }
+
+    ~FileView() {
+#ifdef EMULATOR_HAS_MMAP
+        if (bytes != nullptr) {
+            munmap(const_cast<byte*>(bytes), length);
+        }
+#endif
+    }
+
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    const byte* data() const { return bytes; }
+    size_t size() const { return length; }
+
+   private:
+    const byte* bytes = nullptr;
+    size_t length = 0;
+#ifndef EMULATOR_HAS_MMAP
+    std::vector<byte> buffer;
+#endif
+};
+
+// Nibble value of every character; 0xFF for anything that is not a hex digit
+constexpr std::array<byte, 256> build_hex_table() {
+    std::array<byte, 256> table{};
+    for (auto& value : table) {
+        value = 0xFF;
+    }
+    for (int i = 0; i < 10; ++i) {
+        table['0' + i] = static_cast<byte>(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+        table['A' + i] = static_cast<byte>(10 + i);
+        table['a' + i] = static_cast<byte>(10 + i);
+    }
+    return table;
+}
+
+constexpr std::array<byte, 256> HEX = build_hex_table();
+
+// Decodes `count` bytes from pairs of hex digits and adds them up for the
+// record checksum in the same pass; false on anything but hex digits
+bool decode_hex(const char* text, u32 count, byte* out, byte& total) {
+    byte bad = 0;
+    byte sum = 0;
+    for (u32 i = 0; i < count; ++i) {
+        byte hi = HEX[static_cast<unsigned char>(text[2 * i])];
+        byte lo = HEX[static_cast<unsigned char>(text[2 * i + 1])];
+        bad |= hi | lo;
+        byte value = static_cast<byte>((hi << 4) | lo);
+        sum += value;
+        out[i] = value;
+    }
+    total = sum;
+    return (bad & 0xF0) == 0;
+}
+
+// Longest record either format can hold: a count byte of 255 plus the header
+constexpr u32 MAX_RECORD_BYTES = 260;
+
+// What a record parser tells the line loop
+enum class Step : byte {
+    Next,  // Go on with the next line
+    Stop,  // End-of-file or start record: ignore the rest
+};
+
+// Calls `record(line, length, step)` for every non-blank line, with trailing
+// CR and blanks removed, until it fails or asks to stop
+template <typename Record>
+LoadResult for_each_line(const char* text, size_t size, Record record) {
+    const char* end = text + size;
+    u32 line = 0;
+    while (text < end) {
+        line++;
+        const char* eol = static_cast<const char*>(std::memchr(text, '\n', static_cast<size_t>(end - text)));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        const char* last = eol;
+        while (last > text && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) {
+            last--;
+        }
+        if (last > text) {
+            Step step = Step::Next;
+            LoadError error = record(text, static_cast<u32>(last - text), step);
+            if (error != LoadError::None) {
+                return {error, line};
+            }
+            if (step == Step::Stop) {
+                break;
+            }
+        }
+        text = eol + 1;
+    }
+    return {};
+}
+
+// Sets the PC from a start address record
+LoadError set_entry(Cpu& cpu, u32 entry) {
+    if (entry >= Mem::MAX_MEM) {
+        return LoadError::Range;
+    }
+    cpu.PC = static_cast<word>(entry);
+    return LoadError::None;
+}
+
+// Stores a data record that has passed its checksum
+LoadError store(Mem& mem, u32 addr, const byte* data, u32 count) {
+    if (addr > Mem::MAX_MEM || count > Mem::MAX_MEM - addr) {
+        return LoadError::Range;
+    }
+    mem.load(addr, data, count);
+    return LoadError::None;
+}
+
+// Sequential little-endian reader over an object file. Reading past the end
+// sets failed() and yields zeros, so callers check once per section.
+class ByteReader {
+   public:
+    ByteReader(const byte* data, size_t size) : pos(data), end(data + size) {}
+
+    bool failed() const { return bad; }
+
+    const byte* take(size_t count) {
+        if (count > static_cast<size_t>(end - pos)) {
+            bad = true;
+            pos = end;
+            return nullptr;
+        }
+        const byte* start = pos;
+        pos += count;
+        return start;
+    }
+
+    byte u8() {
+        const byte* p = take(1);
+        return p ? p[0] : 0;
+    }
+
+    u32 u16() {
+        const byte* p = take(2);
+        return p ? static_cast<u32>(p[0] | (p[1] << 8)) : 0;
+    }
+
+    // A 16-bit or, in objects with 32-bit fields, a 32-bit value
+    u32 field(bool wide) {
+        u32 low = u16();
+        return wide ? low | (u16() << 16) : low;
+    }
+
+    // A NUL-terminated name
+    std::string name() {
+        const byte* nul = static_cast<const byte*>(std::memchr(pos, 0, static_cast<size_t>(end - pos)));
+        if (nul == nullptr) {
+            bad = true;
+            pos = end;
+            return {};
+        }
+        std::string text(reinterpret_cast<const char*>(pos), static_cast<size_t>(nul - pos));
+        pos = nul + 1;
+        return text;
+    }
+
+   private:
+    const byte* pos;
+    const byte* end;
+    bool bad = false;
+};
+
+// o65 file layout, after the format description by André Fachat
+namespace o65 {
+
+constexpr byte MAGIC[6] = {0x01, 0x00, 'o', '6', '5', 0x00};
+
+// Mode word bits
+constexpr u32 MODE_65816 = 0x8000;
+constexpr u32 MODE_PAGED = 0x4000;  // Relocation by pages: HIGH entries carry no low byte
+constexpr u32 MODE_LONG = 0x2000;   // 32-bit header fields
+constexpr u32 MODE_CHAIN = 0x0400;  // Another object follows
+constexpr u32 MODE_BSSZERO = 0x0200;
+constexpr u32 MODE_ALIGN = 0x0003;
+
+// Segment ids used by relocation entries and exported globals
+enum Segment : byte { Undefined, Absolute, Text, Data, Bss, Zero, SEGMENTS };
+
+// Relocation types, in the top three bits of an entry's type byte
+constexpr byte RELOC_TYPE = 0xE0;
+constexpr byte RELOC_WORD = 0x80;
+constexpr byte RELOC_HIGH = 0x40;
+constexpr byte RELOC_LOW = 0x20;
+constexpr byte RELOC_SEGMENT = 0x1F;
+
+}  // namespace o65
+
+// Applies one segment's relocation table to `image`, the `size` bytes of that
+// segment. Every entry adds the move of its target segment, or the address
+// of an imported symbol, to the bytes it points at.
+LoadError relocate(ByteReader& in, byte* image, u32 size, const u32 (&moves)[o65::SEGMENTS],
+                   const std::vector<u32>& imported, bool wide, bool paged) {
+    u64 offset = ~u64{0};  // Entries count from the byte before the segment
+    while (true) {
+        byte step = in.u8();
+        if (in.failed()) {
+            return LoadError::Syntax;
+        }
+        if (step == 0) {
+            return LoadError::None;
+        }
+        if (step == 0xFF) {
+            offset += 0xFE;
+            continue;
+        }
+        offset += step;
+
+        byte type = in.u8();
+        byte segment = type & o65::RELOC_SEGMENT;
+        u32 move;
+        if (segment == o65::Undefined) {
+            u32 index = in.field(wide);
+            if (index >= imported.size()) {
+                return LoadError::Syntax;
+            }
+            move = imported[index];
+        } else if (segment < o65::SEGMENTS) {
+            move = moves[segment];
+        } else {
+            return LoadError::Syntax;
+        }
+
+        u32 width = (type & o65::RELOC_TYPE) == o65::RELOC_WORD ? 2 : 1;
+        if (offset + width > size) {
+            return LoadError::Syntax;
+        }
+        byte* target = image + offset;
+        switch (type & o65::RELOC_TYPE) {
+            case o65::RELOC_WORD: {
+                u32 value = (target[0] | (target[1] << 8)) + move;
+                target[0] = static_cast<byte>(value);
+                target[1] = static_cast<byte>(value >> 8);
+                break;
+            }
+            case o65::RELOC_HIGH: {
+                // The low byte decides the carry; it lives in the table unless relocation is by pages
+                u32 low = paged ? 0 : in.u8();
+                target[0] = static_cast<byte>((((target[0] << 8) | low) + move) >> 8);
+                break;
+            }
+            case o65::RELOC_LOW:
+                target[0] = static_cast<byte>(target[0] + move);
+                break;
+            default:  // 65816 segment and bank relocations
+                return LoadError::Syntax;
+        }
+    }
+}
+
+}  // namespace
+
+void read_from_array(Cpu& cpu, Mem& mem, const ProgramImage& image) {
+    for (const ProgramImage::Segment& segment : image) {
+        mem.load(segment.address, segment.bytes.data(), static_cast<u32>(segment.bytes.size()));
+    }
+}
+
+void read_from_array(Cpu& cpu, Mem& mem, const std::map<u32, std::vector<byte>>& data) {
     for (const auto& [address, bytes] : data) {
-        for (size_t i = 0; i < bytes.size(); ++i) {
-            mem[address + i] = bytes[i];
+        mem.load(address, bytes.data(), static_cast<u32>(bytes.size()));
+    }
+}
+
+bool read_from_binary_file(Cpu& cpu, Mem& mem, const std::string& file_path, const u32 m_offset) {
+    FileView file(file_path);
+    if (file.size() == 0 || m_offset > Mem::MAX_MEM || file.size() > Mem::MAX_MEM - m_offset) {
+        return false;
+    }
+    mem.load(m_offset, file.data(), static_cast<u32>(file.size()));
+    return true;
+}
+
+bool read_from_binary_file(BankedMemory& banked, const std::string& file_path, const u32 first_bank) {
+    FileView file(file_path);
+    const size_t bank_size = banked.window_size();
+    if (file.size() == 0 || first_bank >= banked.bank_count() ||
+        file.size() > (banked.bank_count() - first_bank) * bank_size) {
+        return false;
+    }
+
+    // One bank at a time, so that windows showing a bank see the new bytes
+    for (size_t done = 0; done < file.size(); done += bank_size) {
+        u32 chunk = static_cast<u32>(std::min(bank_size, file.size() - done));
+        banked.load(first_bank + static_cast<u32>(done / bank_size), file.data() + done, chunk);
+    }
+    return true;
+}
+
+LoadResult read_from_intel_hex(Cpu& cpu, Mem& mem, const char* text, size_t size) {
+    u32 base = 0;  // From extended segment and linear address records
+    return for_each_line(text, size, [&](const char* line, u32 length, Step& step) {
+        // :LLAAAATT<data>CC
+        byte bytes[MAX_RECORD_BYTES];
+        byte total;
+        u32 count = (length - 1) / 2;
+        if (line[0] != ':' || length < 11 || (length - 1) % 2 != 0 || count > MAX_RECORD_BYTES ||
+            !decode_hex(line + 1, count, bytes, total) || count != bytes[0] + 5u) {
+            return LoadError::Syntax;
+        }
+        if (total != 0) {
+            return LoadError::Checksum;
+        }
+
+        const byte* data = bytes + 4;
+        u32 data_length = bytes[0];
+        switch (bytes[3]) {
+            case 0x00:  // Data
+                return store(mem, base + ((bytes[1] << 8) | bytes[2]), data, data_length);
+            case 0x01:  // End of file
+                step = Step::Stop;
+                return LoadError::None;
+            case 0x02:  // Extended segment address: bits 4-19
+                if (data_length != 2) {
+                    return LoadError::Syntax;
+                }
+                base = ((data[0] << 8) | data[1]) << 4;
+                return LoadError::None;
+            case 0x03:  // Start segment address, CS:IP
+                if (data_length != 4) {
+                    return LoadError::Syntax;
+                }
+                return set_entry(cpu, (((data[0] << 8) | data[1]) << 4) + ((data[2] << 8) | data[3]));
+            case 0x04:  // Extended linear address: bits 16-31
+                if (data_length != 2) {
+                    return LoadError::Syntax;
+                }
+                base = static_cast<u32>((data[0] << 8) | data[1]) << 16;
+                return LoadError::None;
+            case 0x05:  // Start linear address
+                if (data_length != 4) {
+                    return LoadError::Syntax;
+                }
+                return set_entry(cpu, (static_cast<u32>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+            default:
+                return LoadError::Syntax;
+        }
+    });
+}
+
+LoadResult read_from_srec(Cpu& cpu, Mem& mem, const char* text, size_t size) {
+    // Address bytes of S0 to S9; 0 for the unused S4
+    static constexpr byte ADDRESS_BYTES[10] = {2, 2, 3, 4, 0, 2, 3, 4, 3, 2};
+
+    return for_each_line(text, size, [&](const char* line, u32 length, Step& step) {
+        // S<type><count><address><data><checksum>; count covers everything after itself
+        byte bytes[MAX_RECORD_BYTES];
+        byte total;
+        u32 count = (length - 2) / 2;
+        if (line[0] != 'S' || length < 4 || line[1] < '0' || line[1] > '9' || (length - 2) % 2 != 0 ||
+            count > MAX_RECORD_BYTES || !decode_hex(line + 2, count, bytes, total) || count != bytes[0] + 1u) {
+            return LoadError::Syntax;
+        }
+        if (total != 0xFF) {
+            return LoadError::Checksum;
+        }
+
+        byte type = static_cast<byte>(line[1] - '0');
+        u32 address_bytes = ADDRESS_BYTES[type];
+        if (address_bytes == 0 || bytes[0] < address_bytes + 1) {
+            return LoadError::Syntax;
+        }
+        u32 addr = 0;
+        for (u32 i = 0; i < address_bytes; ++i) {
+            addr = (addr << 8) | bytes[1 + i];
+        }
+
+        switch (type) {
+            case 1:
+            case 2:
+            case 3:  // Data
+                return store(mem, addr, bytes + 1 + address_bytes, bytes[0] - address_bytes - 1);
+            case 7:
+            case 8:
+            case 9:  // Start address, which also ends the file
+                step = Step::Stop;
+                return set_entry(cpu, addr);
+            default:  // S0 header, S5/S6 record counts
+                return LoadError::None;
         }
+    });
+}
+
+bool read_from_prg(Cpu& cpu, Mem& mem, const byte* data, size_t size, word* load_address) {
+    if (size < 3) {
+        return false;
+    }
+    u32 addr = data[0] | (data[1] << 8);
+    if (size - 2 > Mem::MAX_MEM - addr) {
+        return false;
     }
+    mem.load(addr, data + 2, static_cast<u32>(size - 2));
+    if (load_address != nullptr) {
+        *load_address = static_cast<word>(addr);
+    }
+    return true;
 }
+
+O65Module read_from_o65(Cpu& cpu, Mem& mem, const byte* data, size_t size, const O65Placement& placement,
+                        const Symbols& imports) {
+    O65Module module;
+    auto fail = [&](LoadError error) {
+        module.error = error;
+        return module;
+    };
+
+    ByteReader in(data, size);
+    const byte* magic = in.take(sizeof(o65::MAGIC));
+    if (magic == nullptr || std::memcmp(magic, o65::MAGIC, sizeof(o65::MAGIC)) != 0) {
+        return fail(LoadError::Syntax);
+    }
+    u32 mode = in.u16();
+    if (mode & (o65::MODE_65816 | o65::MODE_CHAIN)) {
+        return fail(LoadError::Syntax);
+    }
+    const bool wide = mode & o65::MODE_LONG;
+    const bool paged = mode & o65::MODE_PAGED;
+
+    u32 text_base = in.field(wide);
+    module.text_size = in.field(wide);
+    u32 data_base = in.field(wide);
+    module.data_size = in.field(wide);
+    u32 bss_base = in.field(wide);
+    module.bss_size = in.field(wide);
+    u32 zero_base = in.field(wide);
+    module.zero_size = in.field(wide);
+    in.field(wide);  // Stack size, only a hint for the OS
+
+    // Header options: length (counting itself and the type byte), type, contents
+    for (byte length = in.u8(); length != 0 && !in.failed(); length = in.u8()) {
+        if (length < 2 || in.take(length - 1u) == nullptr) {
+            return fail(LoadError::Syntax);
+        }
+    }
+
+    const u32 text_size = module.text_size;
+    const u32 data_size = module.data_size;
+    const byte* text = in.take(text_size);
+    const byte* initialized = in.take(data_size);
+    if (in.failed()) {
+        return fail(LoadError::Syntax);
+    }
+
+    // Undefined references, by the index relocation entries use
+    std::vector<u32> imported(in.field(wide));
+    for (u32& address : imported) {
+        auto symbol = imports.find(in.name());
+        if (in.failed()) {
+            return fail(LoadError::Syntax);
+        }
+        if (symbol == imports.end()) {
+            return fail(LoadError::Unresolved);
+        }
+        address = symbol->second;
+    }
+
+    module.text = placement.text;
+    module.data = placement.data == O65Placement::NEXT ? module.text + text_size : placement.data;
+    module.bss = placement.bss == O65Placement::NEXT ? module.data + data_size : placement.bss;
+    module.zero = placement.zero == O65Placement::ASSEMBLED ? zero_base : placement.zero;
+
+    static constexpr u32 ALIGNMENT[4] = {1, 2, 4, Mem::PAGE_SIZE};
+    const u32 align = ALIGNMENT[mode & o65::MODE_ALIGN];
+    auto fits = [&](u32 base, u32 length, u32 limit) {
+        return length == 0 || (base <= limit && length <= limit - base && base % align == 0);
+    };
+    if (!fits(module.text, text_size, Mem::MAX_MEM) || !fits(module.data, data_size, Mem::MAX_MEM) ||
+        !fits(module.bss, module.bss_size, Mem::MAX_MEM) || !fits(module.zero, module.zero_size, Mem::PAGE_SIZE)) {
+        return fail(LoadError::Range);
+    }
+
+    // Moves are added modulo the field width, so moving down works too
+    const u32 moves[o65::SEGMENTS] = {
+        0, 0, module.text - text_base, module.data - data_base, module.bss - bss_base, module.zero - zero_base,
+    };
+
+    // Text, data and a cleared bss, relocated here before anything is stored
+    std::vector<byte> image(text_size + data_size + module.bss_size);
+    std::memcpy(image.data(), text, text_size);
+    std::memcpy(image.data() + text_size, initialized, data_size);
+    LoadError error = relocate(in, image.data(), text_size, moves, imported, wide, paged);
+    if (error == LoadError::None) {
+        error = relocate(in, image.data() + text_size, data_size, moves, imported, wide, paged);
+    }
+    if (error != LoadError::None) {
+        return fail(error);
+    }
+
+    const u32 mask = wide ? 0xFFFFFFFF : 0xFFFF;
+    for (u32 count = in.field(wide); count > 0 && !in.failed(); --count) {
+        std::string name = in.name();
+        byte segment = in.u8();
+        u32 value = in.field(wide);
+        if (segment == o65::Undefined || segment >= o65::SEGMENTS) {
+            return fail(LoadError::Syntax);
+        }
+        module.exports[name] = (value + moves[segment]) & mask;
+    }
+    if (in.failed()) {
+        return fail(LoadError::Syntax);
+    }
+
+    mem.load(module.text, image.data(), text_size);
+    mem.load(module.data, image.data() + text_size, data_size);
+    if (mode & o65::MODE_BSSZERO) {
+        mem.load(module.bss, image.data() + text_size + data_size, module.bss_size);
+    }
+    return module;
+}
+
+LoadResult read_from_intel_hex(Cpu& cpu, Mem& mem, const std::string& file_path) {
+    FileView file(file_path);
+    if (file.size() == 0) {
+        return {LoadError::File, 0};
+    }
+    return read_from_intel_hex(cpu, mem, reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+LoadResult read_from_srec(Cpu& cpu, Mem& mem, const std::string& file_path) {
+    FileView file(file_path);
+    if (file.size() == 0) {
+        return {LoadError::File, 0};
+    }
+    return read_from_srec(cpu, mem, reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+bool read_from_prg(Cpu& cpu, Mem& mem, const std::string& file_path, word* load_address) {
+    FileView file(file_path);
+    return read_from_prg(cpu, mem, file.data(), file.size(), load_address);
+}
+
+O65Module read_from_o65(Cpu& cpu, Mem& mem, const std::string& file_path, const O65Placement& placement,
+                        const Symbols& imports) {
+    FileView file(file_path);
+    if (file.size() == 0) {
+        O65Module module;
+        module.error = LoadError::File;
+        return module;
+    }
+    return read_from_o65(cpu, mem, file.data(), file.size(), placement, imports);
+}
+
 }  // namespace binary_reader
@@ -0,0 +1,81 @@
+#include "rom_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EMULATOR_HAS_MMAP
+#endif
+
+RomImage::~RomImage() {
+#ifdef EMULATOR_HAS_MMAP
+    if (mapped_length != 0) {
+        munmap(const_cast<byte*>(bytes), mapped_length);
+        return;
+    }
+#endif
+    delete[] bytes;
+}
+
+std::shared_ptr<const RomImage> RomImage::from_file(const std::string& path) {
+#ifdef EMULATOR_HAS_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // Mapping whole host pages past the end reads zeros, which covers a partial last emulated page
+    size_t length = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::shared_ptr<RomImage> image(new RomImage);
+    image->bytes = static_cast<const byte*>(p);
+    image->length = length;
+    image->mapped_length = length;
+    return image;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+    std::vector<byte> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (contents.empty()) {
+        return nullptr;
+    }
+    return from_bytes(contents.data(), contents.size());
+#endif
+}
+
+std::shared_ptr<const RomImage> RomImage::from_bytes(const byte* bytes, size_t size) {
+    // Padded to whole pages, so that a partial last page reads as zero
+    size_t padded = (size + Mem::PAGE_SIZE - 1) / Mem::PAGE_SIZE * Mem::PAGE_SIZE;
+    byte* copy = new byte[padded]();
+    std::memcpy(copy, bytes, size);
+
+    std::shared_ptr<RomImage> image(new RomImage);
+    image->bytes = copy;
+    image->length = size;
+    return image;
+}
+
+void RomImage::map(Mem& mem, word base, Mem::RomWrites writes) const {
+    u32 first = base >> 8;
+    u32 count = std::min<u32>(pages(), Mem::NUM_PAGES - first);
+    mem.map_rom(static_cast<byte>(first), count, bytes, writes, shared_from_this());
+}
@@ -0,0 +1,37 @@
+#include "snapshot.h"
+
+#include <cstring>
+
+Snapshot::Snapshot(const Cpu& cpu, const Mem& mem) {
+    regs = {cpu.save(), cpu.engine, cpu.cycle_count, cpu.invalid_opcodes, cpu.last_invalid_pc};
+
+    std::shared_ptr<Image> copy(new Image);  // Not value-initialized; every byte is copied below
+    for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+        // A shared page's RAM is the earlier image; everything else, including
+        // pages mapped to host RAM, ROM or I/O, has its RAM in `data`
+        const bool shared = mem.page_type(static_cast<byte>(page)) == Mem::PageType::Shared;
+        const byte* ram = shared ? mem.ram_page_data(static_cast<byte>(page)) : mem.data + page * Mem::PAGE_SIZE;
+        std::memcpy(copy->memory + page * Mem::PAGE_SIZE, ram, Mem::PAGE_SIZE);
+    }
+    image = std::move(copy);
+}
+
+void Snapshot::restore(Cpu& cpu, Mem& mem) const {
+    cpu.load(regs.state);
+    cpu.engine = regs.engine;
+    cpu.cycle_count = regs.cycle_count;
+    cpu.invalid_opcodes = regs.invalid_opcodes;
+    cpu.last_invalid_pc = regs.last_invalid_pc;
+
+    mem.map_shared(image->memory, image);
+}
+
+std::vector<std::unique_ptr<Machine>> Snapshot::fork(u32 count) const {
+    std::vector<std::unique_ptr<Machine>> children;
+    children.reserve(count);
+    for (u32 i = 0; i < count; ++i) {
+        children.push_back(std::make_unique<Machine>());
+        restore(children.back()->cpu, children.back()->mem);
+    }
+    return children;
+}
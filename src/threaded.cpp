@@ -0,0 +1,113 @@
+#include "cpu.h"
+#include "dispatch.h"
+#include "instructions.h"
+#include "op_codes.h"
+
+#ifdef EMULATOR_THREADED_DISPATCH
+
+// Opcodes that get their own label in the threaded core.
+// RTS is handled separately because it ends the run.
+#define THREADED_OPS(X) \
+    X(LDA_IM)           \
+    X(LDA_ZP)           \
+    X(LDA_ZPX)          \
+    X(LDA_AB)           \
+    X(LDA_ABSX)         \
+    X(LDA_ABSY)         \
+    X(LDA_INX)          \
+    X(LDA_INY)          \
+    X(LDX_IM)           \
+    X(LDX_ZP)           \
+    X(LDX_ZPY)          \
+    X(LDX_AB)           \
+    X(LDX_ABSY)         \
+    X(LDY_IM)           \
+    X(LDY_ZP)           \
+    X(LDY_ZPX)          \
+    X(LDY_AB)           \
+    X(LDY_ABSX)         \
+    X(STA_ZP)           \
+    X(STA_ZPX)          \
+    X(STA_ABS)          \
+    X(STA_ABSX)         \
+    X(STA_ABSY)         \
+    X(STA_INX)          \
+    X(STA_INY)          \
+    X(STX_ZP)           \
+    X(STX_ZPY)          \
+    X(STX_ABS)          \
+    X(STY_ZP)           \
+    X(STY_ZPX)          \
+    X(STY_ABS)          \
+    X(JSR)              \
+    X(JMP)              \
+    X(JMPI)             \
+    X(NOP)              \
+    X(PHA)              \
+    X(PHP)              \
+    X(PLA)              \
+    X(PLP)              \
+    X(TSX)              \
+    X(TXS)              \
+    X(INX)
+
+// Fetch the next opcode and jump straight to its label. Every handler carries
+// its own copy of this indirect jump, so the branch predictor sees one
+// branch per opcode instead of a single shared one.
+#define DISPATCH()                      \
+    do {                                \
+        if (cycle_count >= deadline) {  \
+            return false;               \
+        }                               \
+        ins = fetch_byte(mem);          \
+        goto* labels[ins];              \
+    } while (0)
+
+// Base cycles of an opcode, a constant folded into every handler
+#define CYCLES(name) dispatch::table[op(Op::name)].cycles
+
+bool Cpu::run_threaded(u64 deadline, Mem& mem) {
+    // Label addresses only exist inside this function, so the table is filled here
+    void* labels[256];
+    for (auto& l : labels) {
+        l = &&op_TRAP;
+    }
+#define REGISTER_LABEL(name) labels[op(Op::name)] = &&op_##name;
+    THREADED_OPS(REGISTER_LABEL)
+#undef REGISTER_LABEL
+    labels[op(Op::RTS)] = &&op_RTS;
+
+    byte ins;
+    DISPATCH();
+
+#define THREADED_HANDLER(name)       \
+    op_##name:                       \
+    cycle_count += CYCLES(name);     \
+    instructions::name(*this, mem);  \
+    DISPATCH();
+    THREADED_OPS(THREADED_HANDLER)
+#undef THREADED_HANDLER
+
+op_RTS:
+    cycle_count += CYCLES(RTS);
+    instructions::RTS(*this, mem);
+    return true;
+
+op_TRAP:
+    cycle_count += dispatch::table[ins].cycles;
+    instructions::TRAP(*this, mem);
+    DISPATCH();
+}
+
+#undef CYCLES
+#undef DISPATCH
+#undef THREADED_OPS
+
+#else
+
+bool Cpu::run_threaded(u64 deadline, Mem& mem) {
+    // Labels-as-values are not available, use the table-driven loop instead
+    return run_table(deadline, mem);
+}
+
+#endif  // EMULATOR_THREADED_DISPATCH
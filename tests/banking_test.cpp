@@ -0,0 +1,218 @@
+#include "banked_memory.h"
+#include "block_cache.h"
+#include "bus.h"
+#include "cpu.h"
+#include "jit.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// 2 MiB of 8 KiB banks
+static constexpr u32 BACKING_SIZE = 2 * 1024 * 1024;
+
+void inline_bank_select_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    BankedMemory banked(mem, BACKING_SIZE, BankedMemory::WINDOW_8K);
+    byte window = banked.add_window(0xA000);
+    for (u32 bank = 0; bank < banked.bank_count(); ++bank) {
+        banked.bank(bank)[0] = static_cast<byte>(bank);
+        banked.bank(bank)[1] = static_cast<byte>(bank >> 8);
+    }
+
+    if (banked.bank_count() != 256) {
+        throw testing::TestFailedException("2 MiB should hold 256 banks of 8 KiB");
+    }
+    for (u32 bank : {0u, 1u, 200u, 255u}) {
+        banked.select(window, bank);
+        if (mem.read(0xA000) != static_cast<byte>(bank) || mem.read(0xA001) != static_cast<byte>(bank >> 8)) {
+            throw testing::TestFailedException("Window should show the selected bank");
+        }
+    }
+
+    // Stores land in the selected bank and stay there across switches
+    banked.select(window, 7);
+    mem.write(0xBFFF, 0x77);
+    banked.select(window, 8);
+    mem.write(0xBFFF, 0x88);
+    if (banked.bank(7)[0x1FFF] != 0x77 || banked.bank(8)[0x1FFF] != 0x88 || mem.data[0xBFFF] != 0x00) {
+        throw testing::TestFailedException("Stores should go to the selected bank's backing store");
+    }
+}
+
+void inline_bank_register_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        BankedMemory banked(mem, BACKING_SIZE, BankedMemory::WINDOW_4K);
+        banked.add_window(0x8000);
+        banked.add_window(0x9000, true);
+        banked.bank(0x123)[0] = 0x5A;
+        banked.bank(0x003)[0] = 0xA5;
+
+        Bus bus(cpu, mem);
+        bus.map(banked, 0xDF00, banked.register_count());
+
+        const byte code[] = {
+            op(Op::LDA_IM), 0x01,         // LDA #$01
+            op(Op::STA_ABS), 0x01, 0xDF,  // STA $DF01 (high byte of window 0's bank)
+            op(Op::LDA_IM), 0x23,         // LDA #$23
+            op(Op::STA_ABS), 0x00, 0xDF,  // STA $DF00 (window 0 shows bank $123)
+            op(Op::LDX_AB), 0x00, 0x80,   // LDX $8000
+            op(Op::LDA_IM), 0x03,         // LDA #$03
+            op(Op::STA_ABS), 0x02, 0xDF,  // STA $DF02 (window 1 shows bank 3)
+            op(Op::STA_ABS), 0x00, 0x90,  // STA $9000 (read-only, dropped)
+            op(Op::LDY_AB), 0x00, 0x90,   // LDY $9000
+            op(Op::RTS),                  // RTS
+        };
+        for (size_t i = 0; i < sizeof(code); ++i) {
+            mem[0x2000 + i] = code[i];
+        }
+        cpu.PC = 0x2000;
+        cpu.engine = engine;
+        StopReason reason;
+        bus.run(1000, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (cpu.X != 0x5A || banked.selected(0) != 0x123) {
+            throw testing::TestFailedException("Bank-select stores should switch window 0");
+        }
+        if (cpu.Y != 0xA5 || banked.bank(3)[0] != 0xA5) {
+            throw testing::TestFailedException("Read-only window should switch and drop writes");
+        }
+    }
+
+    std::printf("%s>> STA $DF00 switched banks on every engine%s\n", CYAN, RESET);
+}
+
+void inline_bank_code_test(Cpu& cpu, Mem& mem) {
+    // The same address holds different code in different banks
+    for (Engine engine : {Engine::Block, Engine::Jit}) {
+        cpu.reset(mem);
+        BankedMemory banked(mem, BACKING_SIZE, BankedMemory::WINDOW_4K);
+        byte window = banked.add_window(0x4000);
+        for (u32 bank = 0; bank < 4; ++bank) {
+            byte* code = banked.bank(bank);
+            code[0] = op(Op::LDX_IM);
+            code[1] = static_cast<byte>(bank + 1);
+            code[2] = op(Op::RTS);
+        }
+
+        cpu.engine = engine;
+        for (int run = 0; run < 40; ++run) {
+            u32 bank = run % 4;
+            banked.select(window, bank);
+            cpu.PC = 0x4000;
+            StopReason reason;
+            cpu.run(100, mem, reason);
+            if (cpu.X != bank + 1) {
+                cpu.engine = DEFAULT_ENGINE;
+                throw testing::TestFailedException("Code cached from another bank was executed");
+            }
+        }
+        cpu.engine = DEFAULT_ENGINE;
+    }
+}
+
+void inline_bank_window_checks_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    mem[0x0000] = 0x11;
+    {
+        BankedMemory banked(mem, BACKING_SIZE, BankedMemory::WINDOW_8K);
+        // $F800 is not 8 KiB aligned; mapped anyway, the window would wrap onto pages $00-$17
+        if (banked.add_window(0xF800) != BankedMemory::NO_WINDOW ||
+            banked.add_window(0x1000) != BankedMemory::NO_WINDOW) {
+            throw testing::TestFailedException("Misaligned window should be rejected");
+        }
+        if (banked.add_window(0xE000) != 0 || banked.add_window(0xE000) != BankedMemory::NO_WINDOW) {
+            throw testing::TestFailedException("Window overlapping another should be rejected");
+        }
+        if (banked.register_count() != 2 || mem.read(0x0000) != 0x11) {
+            throw testing::TestFailedException("Rejected windows should leave memory alone");
+        }
+    }
+
+    for (u32 size : {0u, 100u, 0x1080u, 2 * Mem::MAX_MEM}) {
+        BankedMemory banked(mem, BACKING_SIZE, size);
+        if (banked.ok() || banked.add_window(0x0000) != BankedMemory::NO_WINDOW) {
+            throw testing::TestFailedException("Window size that is not whole pages should be rejected");
+        }
+    }
+
+    // Not a power of two: $F000 is a multiple of 12 KiB, but the window would end past $FFFF
+    BankedMemory banked(mem, BACKING_SIZE, 12 * 1024);
+    if (banked.add_window(0xF000) != BankedMemory::NO_WINDOW || banked.add_window(0xC000) != 0) {
+        throw testing::TestFailedException("Window past the end of memory should be rejected");
+    }
+}
+
+void inline_bank_direct_registers_test(Cpu& cpu, Mem& mem) {
+    // INX ; STX $DF00 (select bank X) ; LDA $8000 ; STA $0300,X ; JMP $2000
+    static constexpr byte CODE[] = {
+        op(Op::INX),                   // INX
+        op(Op::STX_ABS), 0x00, 0xDF,   // STX $DF00
+        op(Op::LDA_AB), 0x00, 0x80,    // LDA $8000
+        op(Op::STA_ABSX), 0x00, 0x03,  // STA $0300,X
+        op(Op::JMP), 0x00, 0x20,       // JMP $2000
+    };
+    // A hot loop that never touches the window
+    static constexpr byte COUNTER[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x00, 0x04,  // STX $0400
+        op(Op::JMP), 0x00, 0x30,      // JMP $3000
+    };
+
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        BankedMemory banked(mem, 1024 * 1024, BankedMemory::WINDOW_4K);
+        banked.add_window(0x8000);
+        banked.map_registers(0xDF00);
+        for (u32 bank = 0; bank < banked.bank_count(); ++bank) {
+            banked.bank(bank)[0] = static_cast<byte>(bank ^ 0x5A);
+        }
+        mem.load(0x2000, CODE, sizeof(CODE));
+        mem.load(0x3000, COUNTER, sizeof(COUNTER));
+
+        cpu.engine = engine;
+        cpu.PC = 0x2000;
+        StopReason reason;
+        cpu.run(20'000, mem, reason);
+        cpu.PC = 0x3000;
+        cpu.run(20'000, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        for (u32 x = 1; x < 0x100; ++x) {
+            if (mem[0x0300 + x] != static_cast<byte>(x ^ 0x5A)) {
+                throw testing::TestFailedException("Each iteration should read the bank it just selected");
+            }
+        }
+        if (banked.selected(0) == 0 || mem.peek(0x8000) != static_cast<byte>(banked.selected(0) ^ 0x5A)) {
+            throw testing::TestFailedException("Register stores should leave the last bank selected");
+        }
+        // The window stays mapped, yet loops outside it still run as native code
+        if (engine == Engine::Jit && Jit::supported() && mem.blocks().lookup(0x3000)->native == nullptr) {
+            throw testing::TestFailedException("Loop outside the window should be translated");
+        }
+    }
+}
+
+int banking_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Bank Switching");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Select Maps The Bank", [&]() { inline_bank_select_test(cpu, mem); });
+    test_suite.register_test("Bank-Select Registers", [&]() { inline_bank_register_test(cpu, mem); });
+    test_suite.register_test("Code In Banks Is Invalidated", [&]() { inline_bank_code_test(cpu, mem); });
+    test_suite.register_test("Registers Without A Bus", [&]() { inline_bank_direct_registers_test(cpu, mem); });
+    test_suite.register_test("Bad Windows Are Rejected", [&]() { inline_bank_window_checks_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,269 @@
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "block_cache.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+void inline_block_cache_self_modifying_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    cpu.engine = Engine::Block;
+
+    // JSR $2000
+    mem[0xFFFC] = op(Op::JSR);
+    mem[0xFFFD] = 0x00;
+    mem[0xFFFE] = 0x20;
+
+    // The STA rewrites the operand of the LDX that follows it in the same block
+    const byte program[] = {
+        op(Op::LDA_IM),  0x99,        // LDA #$99
+        op(Op::STA_ABS), 0x06, 0x20,  // STA $2006
+        op(Op::LDX_IM),  0x11,        // LDX #$11 (patched to #$99)
+        op(Op::RTS),                  // RTS
+    };
+    for (size_t i = 0; i < sizeof(program); ++i) {
+        mem[0x2000 + i] = program[i];
+    }
+
+    StopReason reason;
+    cpu.run(100, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+
+    std::printf("%s>> X = 0x%02X after patching its own operand%s\n", CYAN, cpu.X, RESET);
+
+    if (reason != StopReason::Returned) {
+        throw testing::TestFailedException("Program did not return");
+    }
+    if (cpu.X != 0x99) {
+        throw testing::TestFailedException("Stale predecoded operand was used after a store to the block");
+    }
+}
+
+void inline_block_cache_external_write_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    cpu.engine = Engine::Block;
+
+    // LDA #$01 ; JMP $2000
+    mem[0x2000] = op(Op::LDA_IM);
+    mem[0x2001] = 0x01;
+    mem[0x2002] = op(Op::JMP);
+    mem[0x2003] = 0x00;
+    mem[0x2004] = 0x20;
+
+    StopReason reason;
+    cpu.PC = 0x2000;
+    cpu.run(30, mem, reason);
+    size_t cached = mem.blocks().size();
+
+    // Patch the loop from outside the CPU, like a debugger or loader would
+    mem[0x2001] = 0x02;
+    cpu.PC = 0x2000;
+    cpu.run(30, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+
+    std::printf("%s>> %zu block(s) cached, A = 0x%02X after the patch%s\n", CYAN, cached, cpu.A, RESET);
+
+    if (cached != 1) {
+        throw testing::TestFailedException("Loop should be cached as a single block");
+    }
+    if (cpu.A != 0x02) {
+        throw testing::TestFailedException("Write through Mem::operator[] did not invalidate the block");
+    }
+}
+
+void inline_block_cache_reset_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    cpu.engine = Engine::Block;
+
+    mem[0x2000] = op(Op::NOP);
+    mem[0x2001] = op(Op::JMP);
+    mem[0x2002] = 0x00;
+    mem[0x2003] = 0x20;
+
+    StopReason reason;
+    cpu.PC = 0x2000;
+    cpu.run(20, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+
+    // Resetting the memory must drop every block
+    cpu.reset(mem);
+    if (mem.blocks().size() != 0) {
+        throw testing::TestFailedException("Block cache survived a memory reset");
+    }
+}
+
+// Loads `program` and starts at `start`
+static void load_program(Cpu& cpu, Mem& mem, const ProgramImage& program, word start) {
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, program);
+    cpu.PC = start;
+}
+
+// Runs `program` on the table and block engines for every budget up to `max_cycles`
+// and checks that they stop on the same instruction with the same state
+static void compare_budgets(Cpu& cpu, Mem& mem, const ProgramImage& program, word start,
+                            i32 max_cycles, std::initializer_list<word> watched) {
+    for (i32 budget = 1; budget <= max_cycles; ++budget) {
+        StopReason ref_reason;
+        load_program(cpu, mem, program, start);
+        cpu.engine = Engine::Table;
+        i32 ref_cycles = cpu.run(budget, mem, ref_reason);
+        word ref_pc = cpu.PC;
+        byte ref_regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.FLAGS};
+        std::vector<byte> ref_mem;
+        for (word addr : watched) {
+            ref_mem.push_back(mem[addr]);
+        }
+
+        StopReason reason;
+        load_program(cpu, mem, program, start);
+        cpu.engine = Engine::Block;
+        i32 cycles_used = cpu.run(budget, mem, reason);
+        byte regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.FLAGS};
+        std::vector<byte> block_mem;
+        for (word addr : watched) {
+            block_mem.push_back(mem[addr]);
+        }
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (cycles_used != ref_cycles || reason != ref_reason || cpu.PC != ref_pc) {
+            std::printf("%s>> Budget %d: table %d cycles PC 0x%04X, block %d cycles PC 0x%04X%s\n", RED, budget,
+                        ref_cycles, ref_pc, cycles_used, cpu.PC, RESET);
+            throw testing::TestFailedException("Fused block stopped on a different instruction");
+        }
+        if (std::memcmp(regs, ref_regs, sizeof(regs)) != 0 || block_mem != ref_mem) {
+            throw testing::TestFailedException("Fused block produced a different state");
+        }
+    }
+}
+
+void inline_block_cache_fused_loop_test(Cpu& cpu, Mem& mem) {
+    auto program = demo_programs::get_counter_program();
+    compare_budgets(cpu, mem, program, 0x8000, 80, {0x0200});
+
+    // INX ; STX $0200 ; JMP $8005 runs as one superinstruction
+    load_program(cpu, mem, program, 0x8000);
+    Block* loop = mem.blocks().lookup(0x8005);
+
+    std::printf("%s>> Loop body: %zu ops, %zu after fusion, %u cycles%s\n", CYAN, loop->ops.size(),
+                loop->fused.size(), loop->fused_cycles, RESET);
+
+    if (loop->fused.size() != 1 || loop->fused[0].length != 3 || loop->fused_cycles != loop->cycles) {
+        throw testing::TestFailedException("Counter loop body was not fused into one superinstruction");
+    }
+}
+
+void inline_block_cache_fused_pairs_test(Cpu& cpu, Mem& mem) {
+    static constexpr byte CODE[] = {
+        op(Op::LDA_IM), 0x11,         // LDA #$11
+        op(Op::STA_ABS), 0x00, 0x30,  // STA $3000
+        op(Op::LDX_IM), 0x22,         // LDX #$22
+        op(Op::STX_ABS), 0x01, 0x30,  // STX $3001
+        op(Op::LDY_IM), 0x33,         // LDY #$33
+        op(Op::STY_ABS), 0x02, 0x30,  // STY $3002
+        op(Op::PHA),                  // PHA
+        op(Op::LDA_AB), 0x01, 0x30,   // LDA $3001
+        op(Op::PLA),                  // PLA
+        op(Op::RTS),                  // RTS
+    };
+    static constexpr byte RETURN_ADDRESS[] = {0xFF, 0x3F};  // For the RTS ($3FFF + 1)
+    static constexpr byte SPIN[] = {op(Op::JMP), 0x00, 0x40};
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x2000, CODE}, {0x01FE, RETURN_ADDRESS}, {0x4000, SPIN}};
+    constexpr ProgramImage program(SEGMENTS);
+
+    // SP points below the planted return address
+    auto run = [&](Engine engine, i32 budget, StopReason& reason) {
+        load_program(cpu, mem, program, 0x2000);
+        cpu.SP = 0xFD;
+        cpu.engine = engine;
+        return cpu.run(budget, mem, reason);
+    };
+
+    for (i32 budget = 1; budget <= 50; ++budget) {
+        StopReason ref_reason;
+        i32 ref_cycles = run(Engine::Table, budget, ref_reason);
+        byte ref_regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, mem[0x3000], mem[0x3001], mem[0x3002]};
+        word ref_pc = cpu.PC;
+
+        StopReason reason;
+        i32 cycles_used = run(Engine::Block, budget, reason);
+        byte regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, mem[0x3000], mem[0x3001], mem[0x3002]};
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (cycles_used != ref_cycles || reason != ref_reason || cpu.PC != ref_pc ||
+            std::memcmp(regs, ref_regs, sizeof(regs)) != 0) {
+            throw testing::TestFailedException("Fused pairs disagree with the table engine");
+        }
+    }
+
+    Block* block = mem.blocks().lookup(0x2000);
+
+    std::printf("%s>> %zu ops, %zu after fusion, A = 0x%02X%s\n", CYAN, block->ops.size(), block->fused.size(), cpu.A,
+                RESET);
+
+    // Three load/store pairs and PHA ; LDA ; PLA, followed by the RTS
+    if (block->fused.size() != 5 || cpu.A != 0x11) {
+        throw testing::TestFailedException("Expected pairs were not fused");
+    }
+}
+
+void inline_block_cache_leaf_call_test(Cpu& cpu, Mem& mem) {
+    static constexpr byte MAIN[] = {
+        op(Op::LDY_IM), 0x05,         // LDY #$05
+        op(Op::JSR), 0x50, 0x20,      // JSR $2050
+        op(Op::STA_ABS), 0x00, 0x30,  // STA $3000
+        op(Op::JMP), 0x00, 0x20,      // JMP $2000
+    };
+    static constexpr byte LEAF[] = {
+        op(Op::LDA_ZP), 0x80,         // LDA $80
+        op(Op::STA_ABS), 0x01, 0x30,  // STA $3001
+        op(Op::RTS),                  // RTS
+    };
+    static constexpr byte VALUE[] = {0x42};
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x2000, MAIN}, {0x2050, LEAF}, {0x0080, VALUE}};
+    constexpr ProgramImage program(SEGMENTS);
+    compare_budgets(cpu, mem, program, 0x2000, 120, {0x3000, 0x3001, 0x01FE, 0x01FF});
+
+    load_program(cpu, mem, program, 0x2000);
+    Block* block = mem.blocks().lookup(0x2000);
+    if (block->fused.size() != 2 || block->fused[1].length != 4) {
+        throw testing::TestFailedException("JSR into the leaf subroutine was not fused");
+    }
+
+    // A store into the leaf must drop the caller as well
+    mem[0x2051] = 0x81;
+    if (block->valid) {
+        throw testing::TestFailedException("Caller block survived a store into its inlined leaf");
+    }
+}
+
+int block_cache_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Block Cache");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Self-Modifying Code Invalidates Block",
+                             [&]() { inline_block_cache_self_modifying_test(cpu, mem); });
+    test_suite.register_test("External Write Invalidates Block",
+                             [&]() { inline_block_cache_external_write_test(cpu, mem); });
+    test_suite.register_test("Reset Clears Block Cache", [&]() { inline_block_cache_reset_test(cpu, mem); });
+    test_suite.register_test("Fused Loop Keeps Cycle Totals", [&]() { inline_block_cache_fused_loop_test(cpu, mem); });
+    test_suite.register_test("Fused Pairs Keep Cycle Totals", [&]() { inline_block_cache_fused_pairs_test(cpu, mem); });
+    test_suite.register_test("Leaf Subroutine Is Inlined", [&]() { inline_block_cache_leaf_call_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,260 @@
+#include <vector>
+
+#include "bus.h"
+#include "cpu.h"
+#include "dispatch.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Records the pins at the end of every phase 2, i.e. one entry per bus cycle
+class BusTrace : public BusObserver {
+   public:
+    void half_cycle(Cpu& cpu) override {
+        if (cpu.PHI2O) {
+            cycles.push_back({static_cast<word>(cpu.addr_bus.ADDR), static_cast<byte>(cpu.data_bus.DATA), !cpu.RWB,
+                              static_cast<bool>(cpu.PIN_7)});
+        }
+        half_cycles++;
+    }
+
+    std::vector<BusCycle> cycles;
+    u32 half_cycles = 0;
+};
+
+// Runs the single instruction at $2000 on the pins engine and returns its bus trace
+static BusTrace trace_one(Cpu& cpu, Mem& mem, std::initializer_list<byte> code, byte x = 0, byte y = 0) {
+    cpu.reset(mem);
+    word addr = 0x2000;
+    for (byte b : code) {
+        mem[addr++] = b;
+    }
+    cpu.PC = 0x2000;
+    cpu.X = x;
+    cpu.Y = y;
+    cpu.A = 0x5A;
+
+    BusTrace trace;
+    cpu.engine = Engine::Pins;
+    cpu.bus_observer = &trace;
+    StopReason reason;
+    cpu.run(1, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    cpu.bus_observer = nullptr;
+    return trace;
+}
+
+static void expect_cycle(const BusTrace& trace, size_t i, word addr, bool write, const char* what) {
+    if (i >= trace.cycles.size() || trace.cycles[i].addr != addr || trace.cycles[i].write != write) {
+        std::printf("%s>> Cycle %zu: expected %s $%04X%s\n", RED, i, write ? "write" : "read", addr, RESET);
+        throw testing::TestFailedException(what);
+    }
+}
+
+void inline_bus_cycle_count_test(Cpu& cpu, Mem& mem) {
+    u32 checked = 0;
+    for (u32 opcode = 0; opcode < 256; ++opcode) {
+        const dispatch::OpEntry& entry = dispatch::table[opcode];
+        if (entry.handler == instructions::TRAP) {
+            continue;
+        }
+
+        // Operands point at $0240 or $40, with index registers that cross a page
+        for (byte index : {byte{0x00}, byte{0xF0}}) {
+            BusTrace trace = trace_one(cpu, mem, {static_cast<byte>(opcode), 0x40, 0x02}, index, index);
+            if (trace.cycles.size() != cpu.cycle_count || trace.half_cycles != 2 * cpu.cycle_count) {
+                std::printf("%s>> %s: %zu bus cycles for %llu charged cycles%s\n", RED,
+                            opcodes::from_byte(static_cast<byte>(opcode)).c_str(), trace.cycles.size(),
+                            static_cast<unsigned long long>(cpu.cycle_count), RESET);
+                throw testing::TestFailedException("Bus cycles do not match the charged cycles");
+            }
+            if (!trace.cycles[0].sync || trace.cycles[0].addr != 0x2000) {
+                throw testing::TestFailedException("First cycle should be the opcode fetch with SYNC");
+            }
+            for (size_t i = 1; i < trace.cycles.size(); ++i) {
+                if (trace.cycles[i].sync) {
+                    throw testing::TestFailedException("SYNC should only be set on the opcode fetch");
+                }
+            }
+        }
+        checked++;
+    }
+
+    std::printf("%s>> %u opcodes drive one bus cycle per charged cycle%s\n", CYAN, checked, RESET);
+}
+
+void inline_bus_indexed_read_test(Cpu& cpu, Mem& mem) {
+    // LDA $1FF0,X with X = $12 reads its own high operand byte at $2002,
+    // after an extra cycle at $1F02 that fixes up the high byte
+    BusTrace trace = trace_one(cpu, mem, {op(Op::LDA_ABSX), 0xF0, 0x1F}, 0x12);
+    if (trace.cycles.size() != 5) {
+        throw testing::TestFailedException("Page-crossing LDA abs,X should take 5 bus cycles");
+    }
+    expect_cycle(trace, 0, 0x2000, false, "Opcode fetch");
+    expect_cycle(trace, 1, 0x2001, false, "Low address byte fetch");
+    expect_cycle(trace, 2, 0x2002, false, "High address byte fetch");
+    expect_cycle(trace, 3, 0x1F02, false, "Read of the uncorrected address");
+    expect_cycle(trace, 4, 0x2002, false, "Read of the effective address");
+    if (trace.cycles[4].data != 0x1F || cpu.A != 0x1F) {
+        throw testing::TestFailedException("Data bus should carry the loaded byte");
+    }
+
+    // LDA ($40),Y staying on the page: no fix-up cycle
+    trace = trace_one(cpu, mem, {op(Op::LDA_INY), 0x40}, 0, 0x05);
+    if (trace.cycles.size() != 5) {
+        throw testing::TestFailedException("LDA (ind),Y without a page crossing should take 5 bus cycles");
+    }
+    expect_cycle(trace, 2, 0x0040, false, "Pointer low byte read");
+    expect_cycle(trace, 3, 0x0041, false, "Pointer high byte read");
+
+    std::printf("%s>> LDA $1FF0,X with a page crossing read $1F02, then $2002%s\n", CYAN, RESET);
+}
+
+void inline_bus_write_test(Cpu& cpu, Mem& mem) {
+    // STA $3000: the last cycle drives A with RWB low
+    BusTrace trace = trace_one(cpu, mem, {op(Op::STA_ABS), 0x00, 0x30});
+    expect_cycle(trace, 3, 0x3000, true, "STA abs should write in its fourth cycle");
+    if (trace.cycles[3].data != 0x5A) {
+        throw testing::TestFailedException("Data bus should carry the stored byte");
+    }
+
+    // JSR $2100 pushes the return address $2002, high byte first
+    trace = trace_one(cpu, mem, {op(Op::JSR), 0x00, 0x21});
+    expect_cycle(trace, 3, 0x01FF, true, "JSR should push PCH to $01FF");
+    expect_cycle(trace, 4, 0x01FE, true, "JSR should push PCL to $01FE");
+    expect_cycle(trace, 5, 0x2002, false, "JSR should fetch the target's high byte last");
+    if (trace.cycles[3].data != 0x20 || trace.cycles[4].data != 0x02) {
+        throw testing::TestFailedException("JSR pushed the wrong return address");
+    }
+
+    std::printf("%s>> STA and JSR drive RWB low with the written bytes%s\n", CYAN, RESET);
+}
+
+void inline_fast_engine_pins_test(Cpu& cpu, Mem& mem) {
+    // The fast engines never touch the pins
+    for (Engine engine : {Engine::Table, Engine::Threaded, Engine::Block, Engine::Jit}) {
+        cpu.reset(mem);
+        mem[0x2000] = op(Op::STA_ABS);
+        mem[0x2001] = 0x00;
+        mem[0x2002] = 0x30;
+        cpu.PC = 0x2000;
+        cpu.PINS = 0;
+        cpu.engine = engine;
+
+        StopReason reason;
+        cpu.run(4, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (cpu.PINS != 0) {
+            throw testing::TestFailedException("Fast engine changed the pins");
+        }
+    }
+}
+
+// An I/O page that records the cycle and the pins each access sees
+class CyclePort : public IoHandler {
+   public:
+    explicit CyclePort(const Cpu& cpu) : cpu(cpu) {}
+    byte read(word) override {
+        read_cycle = cpu.cycle_count;
+        return 0xC3;
+    }
+    void write(word, byte value) override {
+        write_cycle = cpu.cycle_count;
+        written = value;
+        write_rwb = cpu.RWB;
+    }
+
+    const Cpu& cpu;
+    u64 read_cycle = 0;
+    u64 write_cycle = 0;
+    byte written = 0;
+    bool write_rwb = true;
+};
+
+// Drives its own byte onto the data bus whenever $3000 is read
+class DataDriver : public BusObserver {
+   public:
+    void half_cycle(Cpu& cpu) override {
+        if (cpu.PHI2O && cpu.RWB && cpu.addr_bus.ADDR == 0x3000) {
+            cpu.data_bus.DATA = 0x99;
+        }
+        if (cpu.PHI2O && cpu.addr_bus.ADDR == 0x2004) {
+            x_at_sta = cpu.X;  // Operand fetch of the STA after INX
+        }
+    }
+
+    byte x_at_sta = 0;
+};
+
+void inline_bus_stepped_access_test(Cpu& cpu, Mem& mem) {
+    // LDA $D000 ; STA $D001: the port is read on cycle 4 and written on cycle 8
+    cpu.reset(mem);
+    CyclePort port(cpu);
+    mem.map_io(0xD0, 1, port);
+    const byte io[] = {
+        op(Op::LDA_AB), 0x00, 0xD0,   // LDA $D000
+        op(Op::STA_ABS), 0x01, 0xD0,  // STA $D001
+    };
+    mem.load(0x2000, io, sizeof(io));
+    cpu.PC = 0x2000;
+    cpu.engine = Engine::Pins;
+    StopReason reason;
+    cpu.run(8, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    mem.unmap(0xD0, 1);
+
+    if (port.read_cycle != 4 || port.write_cycle != 8 || port.written != 0xC3 || port.write_rwb) {
+        throw testing::TestFailedException("I/O accesses should happen on their own bus cycle");
+    }
+
+    // An observer can drive the data bus, and sees registers as they change
+    cpu.reset(mem);
+    DataDriver driver;
+    const byte code[] = {
+        op(Op::LDA_AB), 0x00, 0x30,   // LDA $3000
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x00, 0x31,  // STX $3100
+    };
+    mem.load(0x2000, code, sizeof(code));
+    cpu.PC = 0x2000;
+    cpu.engine = Engine::Pins;
+    cpu.bus_observer = &driver;
+    cpu.run(10, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    cpu.bus_observer = nullptr;
+
+    if (cpu.A != 0x99 || mem.peek(0x3000) != 0x00) {
+        throw testing::TestFailedException("CPU should latch the byte the observer drove");
+    }
+    if (driver.x_at_sta != 1 || mem.peek(0x3100) != 1) {
+        throw testing::TestFailedException("Observer should see INX done before the STX operand fetch");
+    }
+
+    std::printf("%s>> Port read on cycle %llu, written on cycle %llu%s\n", CYAN,
+                static_cast<unsigned long long>(port.read_cycle), static_cast<unsigned long long>(port.write_cycle),
+                RESET);
+}
+
+int bus_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Pin-Level Bus Engine");
+
+    test_suite.print_header();
+
+    test_suite.register_test("One Bus Cycle Per Charged Cycle", [&]() { inline_bus_cycle_count_test(cpu, mem); });
+    test_suite.register_test("Indexed Reads Fix Up The High Byte", [&]() { inline_bus_indexed_read_test(cpu, mem); });
+    test_suite.register_test("Writes Drive RWB Low", [&]() { inline_bus_write_test(cpu, mem); });
+    test_suite.register_test("Accesses Happen On Their Cycle", [&]() { inline_bus_stepped_access_test(cpu, mem); });
+    test_suite.register_test("Fast Engines Leave The Pins Alone", [&]() { inline_fast_engine_pins_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,166 @@
+#include "cpu.h"
+#include "dispatch.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Runs the single instruction at $2000 and returns the cycles it took
+static u64 run_one(Cpu& cpu, Mem& mem, Engine engine, std::initializer_list<byte> code, byte x = 0, byte y = 0) {
+    cpu.reset(mem);
+    word addr = 0x2000;
+    for (byte b : code) {
+        mem[addr++] = b;
+    }
+    cpu.PC = 0x2000;
+    cpu.X = x;
+    cpu.Y = y;
+    cpu.engine = engine;
+
+    StopReason reason;
+    u64 used = cpu.run(1, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    return used;
+}
+
+void inline_base_cycles_test(Cpu& cpu, Mem& mem) {
+    // NMOS 6502 timings; absolute operands point at $0200, zero-page ones at $40
+    struct Expected {
+        Op opcode;
+        u64 cycles;
+    };
+    const Expected expected[] = {
+        {Op::LDA_IM, 2},  {Op::LDA_ZP, 3},  {Op::LDA_ZPX, 4},  {Op::LDA_AB, 4},  {Op::LDA_ABSX, 4},
+        {Op::LDA_ABSY, 4}, {Op::LDA_INX, 6}, {Op::LDA_INY, 5},  {Op::LDX_IM, 2},  {Op::LDX_ZP, 3},
+        {Op::LDX_ZPY, 4}, {Op::LDX_AB, 4},  {Op::LDX_ABSY, 4}, {Op::LDY_IM, 2},  {Op::LDY_ZP, 3},
+        {Op::LDY_ZPX, 4}, {Op::LDY_AB, 4},  {Op::LDY_ABSX, 4}, {Op::STA_ZP, 3},  {Op::STA_ZPX, 4},
+        {Op::STA_ABS, 4}, {Op::STA_ABSX, 5}, {Op::STA_ABSY, 5}, {Op::STA_INX, 6}, {Op::STA_INY, 6},
+        {Op::STX_ZP, 3},  {Op::STX_ZPY, 4}, {Op::STX_ABS, 4},  {Op::STY_ZP, 3},  {Op::STY_ZPX, 4},
+        {Op::STY_ABS, 4}, {Op::JSR, 6},     {Op::RTS, 6},      {Op::JMP, 3},     {Op::JMPI, 5},
+        {Op::NOP, 2},     {Op::PHA, 3},     {Op::PHP, 3},      {Op::PLA, 4},     {Op::PLP, 4},
+        {Op::TSX, 2},     {Op::TXS, 2},     {Op::INX, 2},
+    };
+
+    for (const Expected& e : expected) {
+        if (dispatch::table[op(e.opcode)].cycles != e.cycles) {
+            std::printf("%s>> %s: table has %d cycles, expected %llu%s\n", RED,
+                        opcodes::from_byte(op(e.opcode)).c_str(), dispatch::table[op(e.opcode)].cycles,
+                        static_cast<unsigned long long>(e.cycles), RESET);
+            throw testing::TestFailedException("Opcode table has the wrong base cycles");
+        }
+        for (Engine engine : ENGINES) {
+            u64 used = run_one(cpu, mem, engine, {op(e.opcode), 0x40, 0x02});
+            if (used != e.cycles) {
+                std::printf("%s>> %s took %llu cycles on engine %d%s\n", RED, opcodes::from_byte(op(e.opcode)).c_str(),
+                            static_cast<unsigned long long>(used), static_cast<int>(engine), RESET);
+                throw testing::TestFailedException("Instruction was not charged its base cycles");
+            }
+        }
+    }
+
+    std::printf("%s>> %zu opcodes charged their base cycles on every engine%s\n", CYAN, std::size(expected), RESET);
+}
+
+void inline_page_cross_penalty_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        // Absolute indexed reads: $20F0 + $0F stays on page $20, $20F0 + $10 crosses
+        u64 lda_x_same = run_one(cpu, mem, engine, {op(Op::LDA_ABSX), 0xF0, 0x20}, 0x0F);
+        u64 lda_x_cross = run_one(cpu, mem, engine, {op(Op::LDA_ABSX), 0xF0, 0x20}, 0x10);
+        u64 lda_y_cross = run_one(cpu, mem, engine, {op(Op::LDA_ABSY), 0xFF, 0x20}, 0, 0x01);
+        u64 ldx_y_cross = run_one(cpu, mem, engine, {op(Op::LDX_ABSY), 0x80, 0x20}, 0, 0x80);
+        u64 ldy_x_cross = run_one(cpu, mem, engine, {op(Op::LDY_ABSX), 0x81, 0x20}, 0x7F);
+
+        // Stores always take the extra cycle, crossing or not
+        u64 sta_x_cross = run_one(cpu, mem, engine, {op(Op::STA_ABSX), 0xF0, 0x30}, 0x10);
+
+        // (ind),Y with the pointer at $40 -> $21FE
+        u64 lda_iny_cross = 0;
+        u64 lda_iny_same = 0;
+        for (byte y : {byte{0x01}, byte{0x02}}) {
+            cpu.reset(mem);
+            mem[0x40] = 0xFE;
+            mem[0x41] = 0x21;
+            mem[0x2000] = op(Op::LDA_INY);
+            mem[0x2001] = 0x40;
+            cpu.PC = 0x2000;
+            cpu.Y = y;
+            cpu.engine = engine;
+            StopReason reason;
+            (y == 0x01 ? lda_iny_same : lda_iny_cross) = cpu.run(1, mem, reason);
+            cpu.engine = DEFAULT_ENGINE;
+        }
+
+        if (lda_x_same != 4 || lda_x_cross != 5 || lda_y_cross != 5 || ldx_y_cross != 5 || ldy_x_cross != 5) {
+            throw testing::TestFailedException("Absolute indexed reads should take one more cycle across a page");
+        }
+        if (lda_iny_same != 5 || lda_iny_cross != 6) {
+            throw testing::TestFailedException("LDA (ind),Y should take one more cycle across a page");
+        }
+        if (sta_x_cross != 5) {
+            throw testing::TestFailedException("STA abs,X has no page-crossing penalty");
+        }
+    }
+
+    std::printf("%s>> Page-crossing reads take one extra cycle on every engine%s\n", CYAN, RESET);
+}
+
+void inline_64bit_cycle_counter_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        // INX ; JMP $2000 forever, starting just below 2^32 cycles
+        cpu.reset(mem);
+        mem[0x2000] = op(Op::INX);
+        mem[0x2001] = op(Op::JMP);
+        mem[0x2002] = 0x00;
+        mem[0x2003] = 0x20;
+        cpu.PC = 0x2000;
+        cpu.engine = engine;
+        cpu.cycle_count = 0xFFFFFFF0ULL;
+
+        StopReason reason;
+        u64 used = cpu.run(1000, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (reason != StopReason::CyclesExhausted || used < 1000 || used > 1004) {
+            throw testing::TestFailedException("Run should stop within one instruction of the deadline");
+        }
+        if (cpu.cycle_count != 0xFFFFFFF0ULL + used) {
+            throw testing::TestFailedException("Cycle counter did not carry past 32 bits");
+        }
+    }
+
+    // A budget beyond 32 bits is accepted as is; the program returns long before it runs out
+    cpu.reset(mem);
+    mem[0x2000] = op(Op::LDA_IM);
+    mem[0x2001] = 0x01;
+    mem[0x2002] = op(Op::RTS);
+    cpu.PC = 0x2000;
+
+    StopReason reason;
+    u64 used = cpu.run(5'000'000'000ULL, mem, reason);
+    std::printf("%s>> %llu cycles for LDA #imm + RTS with a 5000000000 cycle budget%s\n", CYAN,
+                static_cast<unsigned long long>(used), RESET);
+
+    if (reason != StopReason::Returned || used != 8) {
+        throw testing::TestFailedException("Large budget should run the program to its RTS");
+    }
+}
+
+int cycles_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Cycle Accounting");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Base Cycles Match The 6502", [&]() { inline_base_cycles_test(cpu, mem); });
+    test_suite.register_test("Page Crossing Penalties", [&]() { inline_page_cross_penalty_test(cpu, mem); });
+    test_suite.register_test("64-bit Cycle Counter", [&]() { inline_64bit_cycle_counter_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,175 @@
+#include <sstream>
+
+#include "bus.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "devices.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Device that only counts its ticks
+class TickLog : public Device {
+   public:
+    byte read(word offset) override { return static_cast<byte>(offset); }
+    void write(word offset, byte value) override {
+        (void)offset;
+        (void)value;
+    }
+    void tick(u64 cycles) override {
+        calls++;
+        total += cycles;
+    }
+
+    u64 calls = 0;
+    u64 total = 0;
+};
+
+// Loads `code` at $2000 after a reset
+static void load_at_2000(Cpu& cpu, Mem& mem, std::initializer_list<byte> code) {
+    cpu.reset(mem);
+    word addr = 0x2000;
+    for (byte b : code) {
+        mem[addr++] = b;
+    }
+    cpu.PC = 0x2000;
+}
+
+void inline_console_output_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        load_at_2000(cpu, mem, {
+                                   op(Op::LDA_IM), 'H',          // LDA #'H'
+                                   op(Op::STA_ABS), 0x01, 0xF0,  // STA $F001
+                                   op(Op::LDX_IM), 'i',          // LDX #'i'
+                                   op(Op::STX_ABS), 0x01, 0xF0,  // STX $F001
+                                   op(Op::LDY_AB), 0x00, 0xF0,   // LDY $F000 (RAM next to the console)
+                                   op(Op::RTS),                  // RTS
+                               });
+        mem[0xF000] = 0x77;
+
+        std::ostringstream out;
+        devices::ConsoleOutput console(out);
+        Bus bus(cpu, mem);
+        bus.map(console, 0xF001, devices::ConsoleOutput::SIZE);
+        cpu.engine = engine;
+        StopReason reason;
+        bus.run(1000, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (out.str() != "Hi") {
+            throw testing::TestFailedException("Console did not receive the stored characters");
+        }
+        if (cpu.Y != 0x77) {
+            throw testing::TestFailedException("Address next to a device should still be RAM");
+        }
+    }
+
+    std::printf("%s>> STA/STX $F001 printed \"Hi\" on every engine%s\n", CYAN, RESET);
+}
+
+void inline_cycle_counter_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        load_at_2000(cpu, mem, {
+                                   op(Op::STA_ABS), 0x00, 0x02,  // STA $0200 (latches 4 cycles)
+                                   op(Op::LDA_AB), 0x00, 0x02,   // LDA $0200
+                                   op(Op::LDX_AB), 0x01, 0x02,   // LDX $0201
+                                   op(Op::RTS),                  // RTS
+                               });
+
+        devices::CycleCounter counter;
+        Bus bus(cpu, mem);
+        bus.map(counter, devices::CycleCounter::DEFAULT_BASE, devices::CycleCounter::SIZE);
+        cpu.engine = engine;
+        StopReason reason;
+        bus.run(1000, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (cpu.A != 4 || cpu.X != 0) {
+            throw testing::TestFailedException("Counter should read back the cycles latched by STA");
+        }
+        if (counter.cycles() != cpu.cycle_count) {
+            throw testing::TestFailedException("Counter should have been ticked up to the end of the run");
+        }
+    }
+
+    // programs/counter.asm latches the counter on every pass through its loop
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+    cpu.PC = 0x8000;
+    devices::CycleCounter counter;
+    Bus bus(cpu, mem);
+    bus.map(counter, devices::CycleCounter::DEFAULT_BASE, devices::CycleCounter::SIZE);
+    StopReason reason;
+    bus.run(100'000, reason);
+
+    // One pass is INX, STX abs and JMP abs: 9 cycles
+    if (counter.latched() > cpu.cycle_count || counter.latched() + 9 < cpu.cycle_count) {
+        throw testing::TestFailedException("counter.asm should latch the counter on every pass");
+    }
+
+    std::printf("%s>> counter.asm last latched %u of %llu cycles%s\n", CYAN, counter.latched(),
+                static_cast<unsigned long long>(cpu.cycle_count), RESET);
+}
+
+void inline_batched_tick_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+    cpu.PC = 0x8000;
+
+    TickLog log;
+    Bus bus(cpu, mem);
+    bus.map(log, 0xD000, 16);
+    StopReason reason;
+    u64 used = bus.run(100'000, reason);
+
+    if (log.total != used) {
+        throw testing::TestFailedException("Ticks should add up to the cycles that ran");
+    }
+    if (log.calls > 100'000 / Bus::DEFAULT_QUANTUM + 1) {
+        throw testing::TestFailedException("Devices should be ticked once per quantum, not per instruction");
+    }
+
+    std::printf("%s>> %llu cycles ticked in %llu batches%s\n", CYAN, static_cast<unsigned long long>(log.total),
+                static_cast<unsigned long long>(log.calls), RESET);
+}
+
+void inline_device_unmap_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    {
+        TickLog log;
+        Bus bus(cpu, mem);
+        bus.map(log, 0xD010, 0x100);
+        if (mem.page_type(0xD0) != Mem::PageType::Io || mem.page_type(0xD1) != Mem::PageType::Io || mem.flat()) {
+            throw testing::TestFailedException("Device pages should be mapped as I/O");
+        }
+        if (mem.read(0xD010) != 0x00 || mem.read(0xD10F) != 0xFF) {
+            throw testing::TestFailedException("Device should see offsets from its base");
+        }
+    }
+    if (!mem.flat()) {
+        throw testing::TestFailedException("Destroying the bus should map its pages back to RAM");
+    }
+}
+
+int device_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("MMIO Devices");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Console Output", [&]() { inline_console_output_test(cpu, mem); });
+    test_suite.register_test("Cycle Counter Register", [&]() { inline_cycle_counter_test(cpu, mem); });
+    test_suite.register_test("Devices Tick In Batches", [&]() { inline_batched_tick_test(cpu, mem); });
+    test_suite.register_test("Bus Maps And Unmaps Device Pages", [&]() { inline_device_unmap_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,190 @@
+#include "cpu.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Loads a short program that exercises loads, stores, the stack and control flow.
+// It jumps to a subroutine, copies values around and finishes with RTS.
+static void load_engine_program(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+
+    const byte reset_vector[] = {op(Op::JSR), 0x00, 0x20};
+    const byte program[] = {
+        op(Op::LDA_IM),  0x37,        // LDA #$37
+        op(Op::STA_ZP),  0x40,        // STA $40
+        op(Op::LDX_ZP),  0x40,        // LDX $40
+        op(Op::STX_ABS), 0x00, 0x30,  // STX $3000
+        op(Op::LDY_IM),  0x80,        // LDY #$80
+        op(Op::STY_ZPX), 0x10,        // STY $10,X
+        op(Op::PHA),                  // PHA
+        op(Op::LDA_IM),  0x00,        // LDA #$00
+        op(Op::PLA),                  // PLA
+        op(Op::TSX),                  // TSX
+        op(Op::JMP),     0x00, 0x21,  // JMP $2100
+    };
+    const byte tail[] = {
+        op(Op::STA_ABSX), 0x00, 0x31,  // STA $3100,X
+        op(Op::LDA_AB),   0x00, 0x30,  // LDA $3000
+        op(Op::RTS),                   // RTS
+    };
+
+    for (size_t i = 0; i < sizeof(reset_vector); ++i) {
+        mem[0xFFFC + i] = reset_vector[i];
+    }
+    for (size_t i = 0; i < sizeof(program); ++i) {
+        mem[0x2000 + i] = program[i];
+    }
+    for (size_t i = 0; i < sizeof(tail); ++i) {
+        mem[0x2100 + i] = tail[i];
+    }
+}
+
+// Runs the program on `engine` and verifies it matches the table-driven engine
+static void compare_engines(Cpu& cpu, Mem& mem, Engine engine, i32 cycles) {
+    load_engine_program(cpu, mem);
+    cpu.engine = Engine::Table;
+    bool ref_completed = false;
+    i32 ref_cycles = cpu.execute(cycles, mem, &ref_completed, true);
+    word ref_pc = cpu.PC;
+    byte ref_regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.FLAGS};
+    byte ref_stored[] = {mem[0x0040], mem[0x3000], mem[0x0047], mem[0x31FD]};
+
+    load_engine_program(cpu, mem);
+    cpu.engine = engine;
+    bool completed = false;
+    i32 cycles_used = cpu.execute(cycles, mem, &completed, true);
+    byte regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.FLAGS};
+    byte stored[] = {mem[0x0040], mem[0x3000], mem[0x0047], mem[0x31FD]};
+
+    cpu.engine = DEFAULT_ENGINE;
+
+    std::printf("%s>> Table: %d cycles, PC 0x%04X -- Other: %d cycles, PC 0x%04X%s\n", CYAN, ref_cycles, ref_pc,
+                cycles_used, cpu.PC, RESET);
+
+    if (cycles_used != ref_cycles || completed != ref_completed) {
+        throw testing::TestFailedException("Engines disagree on cycles used or completion");
+    }
+    if (cpu.PC != ref_pc) {
+        throw testing::TestFailedException("Engines disagree on the final program counter");
+    }
+    for (size_t i = 0; i < sizeof(regs); ++i) {
+        if (regs[i] != ref_regs[i]) {
+            throw testing::TestFailedException("Engines disagree on register/flag state");
+        }
+    }
+    for (size_t i = 0; i < sizeof(stored); ++i) {
+        if (stored[i] != ref_stored[i]) {
+            throw testing::TestFailedException("Engines disagree on memory contents");
+        }
+    }
+}
+
+void inline_threaded_engine_test(Cpu& cpu, Mem& mem) {
+    // Enough cycles to reach the RTS
+    compare_engines(cpu, mem, Engine::Threaded, 200);
+
+    if (cpu.A != 0x37 || cpu.X != 0xFD || mem[0x31FD] != 0x37) {
+        throw testing::TestFailedException("Threaded engine produced wrong results");
+    }
+}
+
+void inline_threaded_engine_budget_test(Cpu& cpu, Mem& mem) {
+    // Run out of cycles in the middle of the program
+    compare_engines(cpu, mem, Engine::Threaded, 23);
+}
+
+void inline_block_engine_test(Cpu& cpu, Mem& mem) {
+    compare_engines(cpu, mem, Engine::Block, 200);
+
+    if (cpu.A != 0x37 || cpu.X != 0xFD || mem[0x31FD] != 0x37) {
+        throw testing::TestFailedException("Block engine produced wrong results");
+    }
+}
+
+void inline_block_engine_budget_test(Cpu& cpu, Mem& mem) {
+    // Budgets that end inside a block and exactly on a block boundary
+    compare_engines(cpu, mem, Engine::Block, 23);
+    compare_engines(cpu, mem, Engine::Block, 6);
+}
+
+void inline_pins_engine_test(Cpu& cpu, Mem& mem) {
+    compare_engines(cpu, mem, Engine::Pins, 23);
+    compare_engines(cpu, mem, Engine::Pins, 200);
+
+    if (cpu.A != 0x37 || cpu.X != 0xFD || mem[0x31FD] != 0x37) {
+        throw testing::TestFailedException("Pins engine produced wrong results");
+    }
+}
+
+void inline_headless_run_test(Cpu& cpu, Mem& mem) {
+    load_engine_program(cpu, mem);
+
+    // Stop in the middle of the program
+    StopReason reason = StopReason::Returned;
+    i32 cycles_used = cpu.run(10, mem, reason);
+
+    std::printf("%s>> run(10) used %d cycles, PC 0x%04X%s\n", CYAN, cycles_used, cpu.PC, RESET);
+
+    if (reason != StopReason::CyclesExhausted) {
+        throw testing::TestFailedException("run() should stop with CyclesExhausted");
+    }
+
+    // Resume until the RTS
+    cycles_used += cpu.run(1000, mem, reason);
+
+    std::printf("%s>> Resumed run stopped after %d cycles in total%s\n", CYAN, cycles_used, RESET);
+
+    if (reason != StopReason::Returned) {
+        throw testing::TestFailedException("run() should stop with Returned after the RTS");
+    }
+    if (cpu.A != 0x37 || cpu.PC != 0xFFFF) {
+        throw testing::TestFailedException("Resumed run produced wrong results");
+    }
+}
+
+void inline_headless_invalid_opcode_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+
+    mem[0xFFFC] = 0x02;  // Not an implemented opcode
+    mem[0xFFFD] = op(Op::LDA_IM);
+    mem[0xFFFE] = 0x11;
+
+    StopReason reason;
+    i32 cycles_used = cpu.run(3, mem, reason);
+
+    // The trap is recorded and execution carries on with the next byte
+    if (cpu.invalid_opcodes != 1 || cpu.last_invalid_pc != 0xFFFC) {
+        throw testing::TestFailedException("Invalid opcode was not recorded");
+    }
+    if (cycles_used != 3 || cpu.A != 0x11) {
+        throw testing::TestFailedException("Execution should continue after an invalid opcode");
+    }
+}
+
+int engine_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Execution Engines");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Threaded Engine Matches Table Engine", [&]() { inline_threaded_engine_test(cpu, mem); });
+    test_suite.register_test("Threaded Engine Stops On Cycle Budget",
+                             [&]() { inline_threaded_engine_budget_test(cpu, mem); });
+    test_suite.register_test("Block Engine Matches Table Engine", [&]() { inline_block_engine_test(cpu, mem); });
+    test_suite.register_test("Block Engine Stops On Cycle Budget",
+                             [&]() { inline_block_engine_budget_test(cpu, mem); });
+    test_suite.register_test("Pins Engine Matches Table Engine", [&]() { inline_pins_engine_test(cpu, mem); });
+    test_suite.register_test("Headless Run Reports Stop Reason", [&]() { inline_headless_run_test(cpu, mem); });
+    test_suite.register_test("Headless Run Records Invalid Opcodes",
+                             [&]() { inline_headless_invalid_opcode_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
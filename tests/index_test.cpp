@@ -118,19 +118,64 @@ bool run_all_tests(Cpu& cpu, Mem& mem) {
 
     test_suite_sty.print_results();
 
+    testing::TestSuite test_suite_inx("INX Op Code");
+    test_suite_inx.print_header();
+
+    // Register INX tests
+    test_suite_inx.register_test("Inline INX Test", [&]() { inline_inx_test(cpu, mem); });
+    test_suite_inx.register_test("Inline INX (Wrapping) Test", [&]() { inline_inx_wrap_test(cpu, mem); });
+
+    test_suite_inx.print_results();
+
     // Run JMP tests
     jmp_test_suite(cpu, mem);
 
     // Run Stack Operations tests
     stack_operations_test_suite(cpu, mem);
 
+    // Run execution engine tests
+    int engine_failed = engine_test_suite(cpu, mem);
+
+    // Run block cache tests
+    int block_cache_failed = block_cache_test_suite(cpu, mem);
+
+    // Run JIT tests
+    int jit_failed = jit_test_suite(cpu, mem);
+
+    // Run cycle accounting tests
+    int cycles_failed = cycles_test_suite(cpu, mem);
+
+    // Run pin-level bus engine tests
+    int bus_failed = bus_test_suite(cpu, mem);
+
+    // Run memory map tests
+    int memory_map_failed = memory_map_test_suite(cpu, mem);
+
+    // Run MMIO device tests
+    int device_failed = device_test_suite(cpu, mem);
+
+    // Run snapshot tests
+    int snapshot_failed = snapshot_test_suite(cpu, mem);
+
+    // Run bank switching tests
+    int banking_failed = banking_test_suite(cpu, mem);
+
+    // Run shared ROM image tests
+    int rom_image_failed = rom_image_test_suite(cpu, mem);
+
+    // Run program loader tests
+    int loader_failed = loader_test_suite(cpu, mem);
+
     // Return true if all tests passed
     // Since the JMP test suite doesn't return a failed count, we're assuming it's successful
     // if the execution reaches this point (as failed tests throw exceptions)
     int failed_count = test_suite_lda.get_failed_count() + test_suite_jsr_rts.get_failed_count() +
                        test_suite_invalid_opcode.get_failed_count() + test_suite_ldx.get_failed_count() +
                        test_suite_ldy.get_failed_count() + test_suite_sta.get_failed_count() +
-                       test_suite_stx.get_failed_count() + test_suite_sty.get_failed_count();
+                       test_suite_stx.get_failed_count() + test_suite_sty.get_failed_count() + test_suite_inx.get_failed_count() +
+                       engine_failed + block_cache_failed + jit_failed + cycles_failed +
+                       bus_failed + memory_map_failed + device_failed + snapshot_failed +
+                       banking_failed + rom_image_failed + loader_failed;
 
     return failed_count == 0;
 }
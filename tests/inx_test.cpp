@@ -0,0 +1,51 @@
+#include "cpu.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+void inline_inx_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+
+    cpu.set(Register::X, 0x7F);
+    mem[0xFFFC] = op(Op::INX);
+
+    bool program_completed = false;
+    i32 cycles_used = cpu.execute(2, mem, &program_completed, true);
+
+    std::printf("%s>> X Register after INX: 0x%02X in %d cycles%s\n", CYAN, cpu.X, cycles_used, RESET);
+
+    if (cpu.X != 0x80) {
+        throw testing::TestFailedException("INX test failed: X should be incremented by 1");
+    }
+    if (cycles_used != 2) {
+        throw testing::TestFailedException("INX test failed: INX takes 2 cycles");
+    }
+    if (!cpu.FLAGS_N || cpu.FLAGS_Z) {
+        throw testing::TestFailedException("INX test failed: Negative flag should be set, Zero flag clear");
+    }
+}
+
+void inline_inx_wrap_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+
+    cpu.set(Register::X, 0xFF);
+    mem[0xFFFC] = op(Op::INX);
+
+    bool program_completed = false;
+    cpu.execute(2, mem, &program_completed, true);
+
+    std::printf("%s>> X Register after INX (With wrapping): 0x%02X%s\n", CYAN, cpu.X, RESET);
+
+    if (cpu.X != 0x00) {
+        throw testing::TestFailedException("INX test failed: X should wrap from 0xFF to 0x00");
+    }
+    if (!cpu.FLAGS_Z || cpu.FLAGS_N) {
+        throw testing::TestFailedException("INX test failed: Zero flag should be set, Negative flag clear");
+    }
+}
+
+}  // namespace testing
@@ -0,0 +1,299 @@
+#include <cstring>
+#include <vector>
+
+#include "block_cache.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "jit.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Final state of one run
+struct RunResult {
+    i32 cycles;
+    StopReason reason;
+    word pc;
+    byte regs[5];
+    std::vector<byte> memory;
+};
+
+static RunResult run_program(Cpu& cpu, Mem& mem, const ProgramImage& program, word start, Engine engine, i32 budget,
+                             int runs = 1) {
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, program);
+    cpu.PC = start;
+    cpu.engine = engine;
+
+    RunResult result{0, StopReason::CyclesExhausted, 0, {}, {}};
+    for (int i = 0; i < runs; ++i) {
+        result.cycles += cpu.run(budget, mem, result.reason);
+    }
+    cpu.engine = DEFAULT_ENGINE;
+
+    result.pc = cpu.PC;
+    byte regs[] = {cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.FLAGS};
+    std::memcpy(result.regs, regs, sizeof(regs));
+    result.memory.assign(mem.data, mem.data + Mem::MAX_MEM);
+    return result;
+}
+
+// Checks that the JIT engine ends in exactly the same state as the table engine
+static void compare_with_table(Cpu& cpu, Mem& mem, const ProgramImage& program, word start, i32 budget, int runs = 1) {
+    RunResult ref = run_program(cpu, mem, program, start, Engine::Table, budget, runs);
+    RunResult jit = run_program(cpu, mem, program, start, Engine::Jit, budget, runs);
+
+    if (jit.cycles != ref.cycles || jit.reason != ref.reason || jit.pc != ref.pc) {
+        std::printf("%s>> Budget %d: table %d cycles PC 0x%04X, jit %d cycles PC 0x%04X%s\n", RED, budget, ref.cycles,
+                    ref.pc, jit.cycles, jit.pc, RESET);
+        throw testing::TestFailedException("JIT stopped on a different instruction than the table engine");
+    }
+    if (std::memcmp(jit.regs, ref.regs, sizeof(ref.regs)) != 0) {
+        std::printf("%s>> Budget %d: A/X/Y/SP/P table %02X %02X %02X %02X %02X, jit %02X %02X %02X %02X %02X%s\n",
+                    RED, budget, ref.regs[0], ref.regs[1], ref.regs[2], ref.regs[3], ref.regs[4], jit.regs[0],
+                    jit.regs[1], jit.regs[2], jit.regs[3], jit.regs[4], RESET);
+        throw testing::TestFailedException("JIT produced different registers or flags");
+    }
+    if (jit.memory != ref.memory) {
+        throw testing::TestFailedException("JIT produced different memory contents");
+    }
+}
+
+// True when the block at `pc` was translated to native code
+static bool is_native(Mem& mem, word pc) {
+    return mem.blocks().lookup(pc)->native != nullptr;
+}
+
+void inline_jit_counter_loop_test(Cpu& cpu, Mem& mem) {
+    ProgramImage program = demo_programs::get_counter_program();
+
+    for (i32 budget = 1; budget <= 400; ++budget) {
+        compare_with_table(cpu, mem, program, 0xFFFC, budget);
+    }
+    compare_with_table(cpu, mem, program, 0xFFFC, 1'000'003);
+
+    std::printf("%s>> X = 0x%02X, $0200 = 0x%02X after 1000003 cycles, %zu bytes of native code%s\n", CYAN, cpu.X,
+                mem[0x0200], mem.blocks().jit().code_size(), RESET);
+
+    if (Jit::supported() && !is_native(mem, 0x8005)) {
+        throw testing::TestFailedException("Hot counter loop was not translated");
+    }
+}
+
+void inline_jit_addressing_modes_test(Cpu& cpu, Mem& mem) {
+    static constexpr byte CODE[] = {
+        op(Op::LDX_IM), 0x02,  // LDX #$02
+        op(Op::LDY_IM), 0x03,  // LDY #$03
+        // loop ($3004)
+        op(Op::LDA_ZPX), 0x20,        // LDA $20,X
+        op(Op::STA_ABSY), 0x00, 0x03,  // STA $0300,Y
+        op(Op::LDA_INX), 0x40,        // LDA ($40,X)
+        op(Op::STA_INY), 0x44,        // STA ($44),Y
+        op(Op::LDA_ABSX), 0xF0, 0x04,  // LDA $04F0,X
+        op(Op::STA_ZPX), 0x60,        // STA $60,X
+        op(Op::LDY_ZPX), 0x60,        // LDY $60,X
+        op(Op::STY_ZPX), 0x70,        // STY $70,X
+        op(Op::LDX_ZPY), 0x30,        // LDX $30,Y
+        op(Op::STX_ZPY), 0x80,        // STX $80,Y
+        op(Op::LDA_INY), 0x46,        // LDA ($46),Y
+        op(Op::STA_INX), 0x48,        // STA ($48,X)
+        op(Op::PHP),                  // PHP
+        op(Op::LDA_IM), 0x00,         // LDA #$00
+        op(Op::PLP),                  // PLP
+        op(Op::PHA),                  // PHA
+        op(Op::TSX),                  // TSX
+        op(Op::PLA),                  // PLA
+        op(Op::TXS),                  // TXS
+        op(Op::LDY_AB), 0x51, 0x00,    // LDY $0051
+        op(Op::LDX_ABSY), 0x2D, 0x00,  // LDX $002D,Y
+        op(Op::INX),                  // INX
+        op(Op::STX_ZP), 0x52,         // STX $52
+        op(Op::LDY_ABSX), 0x00, 0x05,  // LDY $0500,X
+        op(Op::LDY_ZP), 0x50,         // LDY $50
+        op(Op::NOP),                  // NOP
+        op(Op::JMP), 0x04, 0x30,      // JMP $3004
+    };
+    static constexpr byte DATA_20[] = {0x80, 0x81, 0x82, 0x83, 0x84, 0x00, 0xFF, 0x7F};
+    static constexpr byte DATA_30[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    static constexpr byte POINTERS[] = {0xFF, 0x00, 0x00, 0x04, 0x00, 0x05, 0x10, 0x06, 0x00, 0x07, 0xFE};
+    static constexpr byte DATA_50[] = {0x03, 0x00};
+    static constexpr byte DATA_4F0[] = {0x11, 0x22, 0x33, 0x44, 0x00, 0x90};
+    static constexpr ProgramImage::Segment SEGMENTS[] = {
+        {0x3000, CODE}, {0x0020, DATA_20}, {0x0030, DATA_30}, {0x0040, POINTERS}, {0x0050, DATA_50}, {0x04F0, DATA_4F0},
+    };
+    constexpr ProgramImage program(SEGMENTS);
+
+    // Cold budgets stay in the interpreter; from about 1500 cycles on the loop runs natively
+    for (i32 budget = 1; budget <= 600; budget += 3) {
+        compare_with_table(cpu, mem, program, 0x3000, budget);
+    }
+    for (i32 budget = 1500; budget <= 4000; budget += 11) {
+        compare_with_table(cpu, mem, program, 0x3000, budget);
+    }
+    compare_with_table(cpu, mem, program, 0x3000, 200'000);
+
+    std::printf("%s>> A = 0x%02X, X = 0x%02X, Y = 0x%02X, SP = 0x%02X after 200000 cycles%s\n", CYAN, cpu.A, cpu.X,
+                cpu.Y, cpu.SP, RESET);
+
+#ifndef EMULATOR_STACK_CHECKS  // Stack instructions are not translated with stack checks
+    if (Jit::supported() && !is_native(mem, 0x3004)) {
+        throw testing::TestFailedException("Hot addressing mode loop was not translated");
+    }
+#endif
+}
+
+void inline_jit_code_page_store_test(Cpu& cpu, Mem& mem) {
+    // The loop patches the operand of its own LDY and stores data next to its code,
+    // so every store leaves the native code and goes through invalidation
+    static constexpr byte CODE[] = {
+        op(Op::LDY_IM), 0x00,         // LDY #$00 (patched)
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x01, 0x20,  // STX $2001
+        op(Op::STY_ABS), 0xF0, 0x20,  // STY $20F0
+        op(Op::JMP), 0x00, 0x20,      // JMP $2000
+    };
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x2000, CODE}};
+    constexpr ProgramImage program(SEGMENTS);
+
+    for (i32 budget = 1; budget <= 300; ++budget) {
+        compare_with_table(cpu, mem, program, 0x2000, budget);
+    }
+    compare_with_table(cpu, mem, program, 0x2000, 50'000);
+
+    std::printf("%s>> X = 0x%02X, Y = 0x%02X, $20F0 = 0x%02X%s\n", CYAN, cpu.X, cpu.Y, mem[0x20F0], RESET);
+
+    if (cpu.Y != static_cast<byte>(cpu.X - 1) && cpu.Y != cpu.X) {
+        throw testing::TestFailedException("Patched LDY operand was not picked up");
+    }
+}
+
+void inline_jit_subroutine_test(Cpu& cpu, Mem& mem) {
+    // Every run stops at the RTS, so the blocks only get hot across runs
+    static constexpr byte MAIN[] = {
+        op(Op::JSR), 0x00, 0x21,  // JSR $2100
+        op(Op::JMP), 0x00, 0x20,  // JMP $2000
+    };
+    static constexpr byte SUBROUTINE[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x00, 0x40,  // STX $4000
+        op(Op::RTS),                  // RTS
+    };
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x2000, MAIN}, {0x2100, SUBROUTINE}};
+    constexpr ProgramImage program(SEGMENTS);
+
+    for (i32 budget = 1; budget <= 40; ++budget) {
+        compare_with_table(cpu, mem, program, 0x2000, budget, 40);
+    }
+
+    std::printf("%s>> X = 0x%02X, SP = 0x%02X after 40 runs%s\n", CYAN, cpu.X, cpu.SP, RESET);
+
+#ifndef EMULATOR_STACK_CHECKS  // Stack instructions are not translated with stack checks
+    if (Jit::supported() && !is_native(mem, 0x2100)) {
+        throw testing::TestFailedException("Hot subroutine was not translated");
+    }
+#endif
+}
+
+void inline_jit_page_cross_test(Cpu& cpu, Mem& mem) {
+    // X and Y keep growing, so the indexed reads cross a page on some iterations only
+    static constexpr byte CODE[] = {
+        op(Op::LDA_ABSX), 0xF8, 0x20,  // LDA $20F8,X
+        op(Op::LDA_INY), 0x40,         // LDA ($40),Y
+        op(Op::LDY_ABSX), 0x80, 0x21,  // LDY $2180,X
+        op(Op::INX),                   // INX
+        op(Op::JMP), 0x00, 0x20,       // JMP $2000
+    };
+    static constexpr byte POINTER[] = {0xF0, 0x22};
+    std::vector<byte> table;
+    for (u32 i = 0; i < 0x100; ++i) {
+        table.push_back(static_cast<byte>(i * 3));
+    }
+    const ProgramImage::Segment segments[] = {{0x2000, CODE}, {0x0040, POINTER}, {0x2180, table}};
+    ProgramImage program(segments);
+
+    for (i32 budget = 1; budget <= 300; budget += 2) {
+        compare_with_table(cpu, mem, program, 0x2000, budget);
+    }
+    for (i32 budget = 1500; budget <= 3000; budget += 7) {
+        compare_with_table(cpu, mem, program, 0x2000, budget);
+    }
+    compare_with_table(cpu, mem, program, 0x2000, 100'003);
+
+    std::printf("%s>> X = 0x%02X, Y = 0x%02X after 100003 cycles%s\n", CYAN, cpu.X, cpu.Y, RESET);
+
+    if (Jit::supported() && !is_native(mem, 0x2000)) {
+        throw testing::TestFailedException("Hot page crossing loop was not translated");
+    }
+}
+
+void inline_jit_arena_refill_test(Cpu& cpu, Mem& mem) {
+    // LDY #n, 29 stores and a JMP back fill one 32-op block. Patching the LDY
+    // operand invalidates it, and the new block is translated again once it is hot.
+    std::vector<byte> code = {op(Op::LDY_IM), 0x00};
+    for (byte i = 0; i < 29; ++i) {
+        code.insert(code.end(), {op(Op::STX_ABS), i, 0x30});
+    }
+    code.insert(code.end(), {op(Op::INX), op(Op::JMP), 0x00, 0x20});
+    const ProgramImage::Segment segments[] = {{0x2000, code}};
+
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, ProgramImage(segments));
+    cpu.PC = 0x2000;
+    cpu.engine = Engine::Jit;
+
+    // Patch until the arena has been refilled at least once, then check the last block still runs natively
+    u32 refills = 0;
+    u32 round = 0;
+    StopReason reason;
+    for (; round < 50'000 && refills < 2; ++round) {
+        mem[0x2001] = static_cast<byte>(round);
+        size_t before = mem.blocks().jit().code_size();
+        cpu.PC = 0x2000;
+        cpu.run(2'500, mem, reason);
+        if (mem.blocks().jit().code_size() < before) {
+            refills++;
+        }
+    }
+    cpu.engine = DEFAULT_ENGINE;
+
+    std::printf("%s>> %u patches, %u arena refills, %zu bytes of native code%s\n", CYAN, round, refills,
+                mem.blocks().jit().code_size(), RESET);
+
+    if (cpu.Y != static_cast<byte>(round - 1) || mem[0x301C] != static_cast<byte>(cpu.X - 1)) {
+        throw testing::TestFailedException("Patched block produced wrong results");
+    }
+    if (Jit::supported() && (refills < 2 || !is_native(mem, 0x2000))) {
+        throw testing::TestFailedException("Blocks were not translated again after the arena filled up");
+    }
+}
+
+int jit_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("JIT Engine");
+
+    test_suite.print_header();
+
+    std::printf("%s>> Recompiler %s%s\n", CYAN, Jit::supported() ? "enabled" : "not built, testing the fallback",
+                RESET);
+
+    test_suite.register_test("Counter Loop Matches Table Engine", [&]() { inline_jit_counter_loop_test(cpu, mem); });
+    test_suite.register_test("Addressing Modes Match Table Engine",
+                             [&]() { inline_jit_addressing_modes_test(cpu, mem); });
+    test_suite.register_test("Stores To Code Pages Leave Native Code",
+                             [&]() { inline_jit_code_page_store_test(cpu, mem); });
+    test_suite.register_test("Subroutines Match Table Engine", [&]() { inline_jit_subroutine_test(cpu, mem); });
+    test_suite.register_test("Page Crossing Penalties Match Table Engine",
+                             [&]() { inline_jit_page_cross_test(cpu, mem); });
+    test_suite.register_test("Full Arena Is Refilled", [&]() { inline_jit_arena_refill_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
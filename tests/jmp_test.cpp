@@ -20,7 +20,7 @@ void inline_jmp_absolute_test(Cpu& cpu, Mem& mem) {
     mem[0x2001] = 0x42;            // Test value
 
     bool program_completed = false;
-    i32 cycles_used = cpu.execute(6, mem, &program_completed, true);
+    i32 cycles_used = cpu.execute(5, mem, &program_completed, true);  // JMP abs (3) + LDA #imm (2)
 
     // Print cycles used and completion status
     std::printf("%sExecution %scompleted in %d cycles%s\n", CYAN, program_completed ? "successfully " : "in",
@@ -0,0 +1,543 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "banked_memory.h"
+#include "block_cache.h"
+#include "bundle.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "jit.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Writes `bytes` to `path`, replacing the file
+static void write_file(const char* path, const std::vector<byte>& bytes) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        throw testing::TestFailedException("Could not create the test file");
+    }
+    std::fwrite(bytes.data(), 1, bytes.size(), file);
+    std::fclose(file);
+}
+
+void inline_binary_file_test(Cpu& cpu, Mem& mem) {
+    const char* path = "loader_test.bin";
+    const std::vector<byte> program = {
+        op(Op::LDA_AB), 0x08, 0x30,   // LDA $3008
+        op(Op::STA_ABS), 0x00, 0x40,  // STA $4000
+        op(Op::INX),                  // INX
+        op(Op::RTS),                  // RTS
+        0x42,                         // $3008: data
+    };
+
+    // The second load replaces code the block cache has already decoded
+    cpu.reset(mem);
+    for (byte data : {byte{0x42}, byte{0x43}}) {
+        std::vector<byte> image = program;
+        image.back() = data;
+        write_file(path, image);
+
+        if (!binary_reader::read_from_binary_file(cpu, mem, path, 0x3000)) {
+            std::remove(path);
+            throw testing::TestFailedException("Binary file should load at $3000");
+        }
+        cpu.PC = 0x3000;
+        cpu.engine = Engine::Block;
+        StopReason reason;
+        cpu.run(100, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (mem[0x4000] != data) {
+            std::remove(path);
+            throw testing::TestFailedException("Program from the file did not run");
+        }
+    }
+
+    // Images that do not fit are rejected without touching memory
+    cpu.reset(mem);
+    bool past_end = binary_reader::read_from_binary_file(cpu, mem, path, Mem::MAX_MEM - 4);
+    bool past_space = binary_reader::read_from_binary_file(cpu, mem, path, Mem::MAX_MEM + 1);
+    std::remove(path);
+    if (past_end || past_space || mem[Mem::MAX_MEM - 4] != 0x00) {
+        throw testing::TestFailedException("Images past the end of memory should be rejected");
+    }
+    if (binary_reader::read_from_binary_file(cpu, mem, "does_not_exist.bin", 0x3000)) {
+        throw testing::TestFailedException("Missing file should not load");
+    }
+
+    std::printf("%s>> Loaded %zu bytes at $3000 twice, replacing decoded code%s\n", CYAN, program.size(), RESET);
+}
+
+void inline_banked_file_test(Cpu& cpu, Mem& mem) {
+    const char* path = "loader_test_banked.bin";
+
+    // Three and a half 4 KiB banks, each starting with its own number
+    std::vector<byte> image(3 * BankedMemory::WINDOW_4K + 0x800);
+    for (size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<byte>(i % BankedMemory::WINDOW_4K == 0 ? i / BankedMemory::WINDOW_4K : i);
+    }
+    write_file(path, image);
+
+    cpu.reset(mem);
+    BankedMemory banked(mem, 8 * BankedMemory::WINDOW_4K, BankedMemory::WINDOW_4K);
+    byte window = banked.add_window(0x9000);
+    bool loaded = binary_reader::read_from_binary_file(banked, path, 2);
+    bool too_far = binary_reader::read_from_binary_file(banked, path, 5);
+    std::remove(path);
+
+    if (!loaded || too_far) {
+        throw testing::TestFailedException("Image should load from bank 2 and not fit from bank 5");
+    }
+    for (u32 bank = 0; bank < 4; ++bank) {
+        banked.select(window, 2 + bank);
+        if (mem.read(0x9000) != bank || mem.read(0x9001) != 0x01) {
+            throw testing::TestFailedException("Each bank should hold its slice of the image");
+        }
+    }
+    if (mem.read(0x97FF) != 0xFF || mem.read(0x9800) != 0x00) {
+        throw testing::TestFailedException("Last bank should hold the partial tail and nothing more");
+    }
+}
+
+void inline_banked_file_selected_test(Cpu& cpu, Mem& mem) {
+    const char* path = "loader_test_selected.bin";
+
+    // LDA #value ; STA $0200 ; RTS, run from a window until the engines have cached it
+    auto program = [](byte value) {
+        return std::vector<byte>{op(Op::LDA_IM), value, op(Op::STA_ABS), 0x00, 0x02, op(Op::RTS)};
+    };
+
+    for (Engine engine : {Engine::Block, Engine::Jit}) {
+        cpu.reset(mem);
+        BankedMemory banked(mem, 4 * BankedMemory::WINDOW_4K, BankedMemory::WINDOW_4K);
+        byte window = banked.add_window(0x9000);
+        banked.select(window, 1);
+        std::vector<byte> first = program(0x11);
+        banked.load(1, first.data(), static_cast<u32>(first.size()));
+
+        cpu.engine = engine;
+        for (u32 run = 0; run < 2 * Jit::HOT_THRESHOLD; ++run) {
+            cpu.PC = 0x9000;
+            StopReason reason;
+            cpu.run(100, mem, reason);
+        }
+
+        // Reload the bank the window shows
+        mem.track_writes(true);
+        u32 generation = mem.write_generation(0x90);
+        write_file(path, program(0x22));
+        bool loaded = binary_reader::read_from_binary_file(banked, path, 1);
+        std::remove(path);
+
+        cpu.PC = 0x9000;
+        StopReason reason;
+        cpu.run(100, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+        bool recorded = mem.dirty(0x90) && mem.write_generation(0x90) != generation;
+        mem.track_writes(false);
+
+        if (!loaded || mem[0x0200] != 0x22) {
+            throw testing::TestFailedException("Code cached from a selected bank should be dropped on load");
+        }
+        if (!recorded) {
+            throw testing::TestFailedException("Loading a selected bank should record the store");
+        }
+    }
+}
+
+// Runs the loaded program from the PC its start record set
+static void run_loaded(Cpu& cpu, Mem& mem) {
+    StopReason reason;
+    cpu.run(100, mem, reason);
+}
+
+void inline_intel_hex_test(Cpu& cpu, Mem& mem) {
+    const char* path = "loader_test.hex";
+    const std::string hex =
+        ":06300000A9428D004060B2\r\n"  // LDA #$42 ; STA $4000 ; RTS at $3000
+        ":020000020C00F0\r\n"          // Segment $0C00
+        "\r\n"
+        ":02001000DEAD63\r\n"          // $DE $AD at $C010
+        ":020000040000FA\r\n"          // Linear base 0
+        ":0400000500003000C7\r\n"      // Start at $3000
+        ":00000001FF\r\n"              // End of file
+        "not a record\r\n";
+    write_file(path, std::vector<byte>(hex.begin(), hex.end()));
+
+    cpu.reset(mem);
+    binary_reader::LoadResult result = binary_reader::read_from_intel_hex(cpu, mem, path);
+    std::remove(path);
+    if (!result.ok() || cpu.PC != 0x3000 || mem[0xC010] != 0xDE || mem[0xC011] != 0xAD) {
+        throw testing::TestFailedException("Intel HEX file should load its data and start address");
+    }
+    run_loaded(cpu, mem);
+    if (mem[0x4000] != 0x42) {
+        throw testing::TestFailedException("Program from the Intel HEX file did not run");
+    }
+
+    struct BadFile {
+        const char* text;
+        binary_reader::LoadError error;
+        u32 line;
+    };
+    const BadFile bad_files[] = {
+        {":06300000A9428D004060B2\n\n:02001000DEAD64\n", binary_reader::LoadError::Checksum, 3},
+        {":06300000A9428D004060B2\n:020000040001F9\n:02001000DEAD63\n", binary_reader::LoadError::Range, 3},
+        {"06300000A9428D004060B2\n", binary_reader::LoadError::Syntax, 1},
+        {":07300000A9428D004060B2\n", binary_reader::LoadError::Syntax, 1},
+        {":0630000GA9428D004060B2\n", binary_reader::LoadError::Syntax, 1},
+    };
+    for (const BadFile& bad : bad_files) {
+        result = binary_reader::read_from_intel_hex(cpu, mem, bad.text, std::strlen(bad.text));
+        if (result.error != bad.error || result.line != bad.line) {
+            std::printf("%s>> Error %d on line %u%s\n", RED, static_cast<int>(result.error), result.line, RESET);
+            throw testing::TestFailedException("Bad Intel HEX record should be reported with its line");
+        }
+    }
+    if (binary_reader::read_from_intel_hex(cpu, mem, "does_not_exist.hex").error != binary_reader::LoadError::File) {
+        throw testing::TestFailedException("Missing file should be reported");
+    }
+}
+
+void inline_srec_test(Cpu& cpu, Mem& mem) {
+    const std::string srec =
+        "S00600004844521B\n"        // Header "HDR"
+        "S1093000A9428D004060AE\n"  // LDA #$42 ; STA $4000 ; RTS at $3000
+        "S20600C010DEAD9E\n"        // $DE $AD at $C010
+        "S5030002FA\n"              // Two data records
+        "S9033000CC\n";             // Start at $3000
+
+    cpu.reset(mem);
+    binary_reader::LoadResult result = binary_reader::read_from_srec(cpu, mem, srec.data(), srec.size());
+    if (!result.ok() || cpu.PC != 0x3000 || mem[0xC010] != 0xDE || mem[0xC011] != 0xAD) {
+        throw testing::TestFailedException("S-records should load their data and start address");
+    }
+    run_loaded(cpu, mem);
+    if (mem[0x4000] != 0x42) {
+        throw testing::TestFailedException("Program from the S-records did not run");
+    }
+
+    const char* bad_checksum = "S00600004844521B\r\nS1093000A9428D004060AF\r\n";
+    result = binary_reader::read_from_srec(cpu, mem, bad_checksum, std::strlen(bad_checksum));
+    if (result.error != binary_reader::LoadError::Checksum || result.line != 2) {
+        throw testing::TestFailedException("Bad S-record checksum should be reported on line 2");
+    }
+    const char* past_end = "S3060001000001F7\n";
+    result = binary_reader::read_from_srec(cpu, mem, past_end, std::strlen(past_end));
+    if (result.error != binary_reader::LoadError::Range || result.line != 1) {
+        throw testing::TestFailedException("S3 record past 64 KiB should be out of range");
+    }
+    const char* s4 = "S4030002FA\n";
+    result = binary_reader::read_from_srec(cpu, mem, s4, std::strlen(s4));
+    if (result.error != binary_reader::LoadError::Syntax) {
+        throw testing::TestFailedException("S4 records should be rejected");
+    }
+}
+
+void inline_prg_test(Cpu& cpu, Mem& mem) {
+    const char* path = "loader_test.prg";
+    write_file(path, {0x00, 0x30, op(Op::LDA_IM), 0x42, op(Op::STA_ABS), 0x00, 0x40, op(Op::RTS)});
+
+    cpu.reset(mem);
+    word load_address = 0;
+    bool loaded = binary_reader::read_from_prg(cpu, mem, path, &load_address);
+    std::remove(path);
+    if (!loaded || load_address != 0x3000 || mem[0x3000] != op(Op::LDA_IM) || mem[0x3005] != op(Op::RTS)) {
+        throw testing::TestFailedException("PRG should load after its two-byte address header");
+    }
+    cpu.PC = load_address;
+    run_loaded(cpu, mem);
+    if (mem[0x4000] != 0x42) {
+        throw testing::TestFailedException("Program from the PRG file did not run");
+    }
+
+    const byte header_only[] = {0x00, 0x30};
+    const byte past_end[] = {0xFF, 0xFF, 0x01, 0x02};
+    mem[0xFFFF] = 0x00;
+    if (binary_reader::read_from_prg(cpu, mem, header_only, sizeof(header_only)) ||
+        binary_reader::read_from_prg(cpu, mem, past_end, sizeof(past_end)) || mem[0xFFFF] != 0x00 ||
+        binary_reader::read_from_prg(cpu, mem, "does_not_exist.prg")) {
+        throw testing::TestFailedException("Short, oversized and missing PRG files should be rejected");
+    }
+}
+
+// o65 header with 16-bit fields and no options
+static std::vector<byte> o65_header(word mode, word text, word text_size, word data, word data_size, word bss,
+                                    word bss_size) {
+    std::vector<byte> object = {0x01, 0x00, 'o', '6', '5', 0x00};
+    for (word value : {mode, text, text_size, data, data_size, bss, bss_size, word{0}, word{0}, word{0}}) {
+        object.push_back(static_cast<byte>(value));
+        object.push_back(static_cast<byte>(value >> 8));
+    }
+    object.push_back(0x00);  // End of options
+    return object;
+}
+
+static void append(std::vector<byte>& object, std::initializer_list<byte> bytes) {
+    object.insert(object.end(), bytes);
+}
+
+void inline_o65_test(Cpu& cpu, Mem& mem) {
+    // Library, assembled at $1000 with data at $2000: get: LDA value ; RTS
+    std::vector<byte> library = o65_header(0x0200, 0x1000, 4, 0x2000, 1, 0x2001, 2);
+    append(library, {op(Op::LDA_AB), 0x00, 0x20, op(Op::RTS)});  // Text
+    append(library, {0x42});                                       // Data: value
+    append(library, {0x00, 0x00});                                 // No imports
+    append(library, {0x02, 0x83, 0x00});                           // Text relocation: LDA operand, in data
+    append(library, {0x00});                                       // No data relocation
+    append(library, {0x01, 0x00, 'g', 'e', 't', 0x00, 0x02, 0x00, 0x10});
+
+    // Program, also assembled at $1000: JSR get ; STA result ; LDA #>result ; LDX #<result ; RTS
+    std::vector<byte> program = o65_header(0x0000, 0x1000, 11, 0x2000, 1, 0x2001, 0);
+    append(program, {op(Op::JSR), 0x00, 0x00, op(Op::STA_ABS), 0x00, 0x20, op(Op::LDA_IM), 0x20, op(Op::LDX_IM), 0x00,
+                     op(Op::RTS)});
+    append(program, {0x00});                              // Data: result
+    append(program, {0x01, 0x00, 'g', 'e', 't', 0x00});  // Imports: get
+    append(program, {0x02, 0x80, 0x00, 0x00,             // JSR operand: import 0
+                     0x03, 0x83,                         // STA operand: data
+                     0x03, 0x43, 0x00,                   // High byte of result, low byte $00
+                     0x02, 0x23,                         // Low byte of result
+                     0x00});
+    append(program, {0x00});  // No data relocation
+    append(program, {0x01, 0x00, 'm', 'a', 'i', 'n', 0x00, 0x02, 0x00, 0x10});
+
+    const char* path = "loader_test.o65";
+    write_file(path, library);
+    cpu.reset(mem);
+    mem[0x3005] = 0xFF;
+    mem[0x3006] = 0xFF;
+    binary_reader::O65Module lib = binary_reader::read_from_o65(cpu, mem, path, {0x3000});
+    std::remove(path);
+    if (!lib.ok() || lib.data != 0x3004 || lib.bss != 0x3005 || lib.end() != 0x3007 || mem[0x3001] != 0x04 ||
+        mem[0x3002] != 0x30 || mem[0x3005] != 0x00 || mem[0x3006] != 0x00 || lib.exports["get"] != 0x3000) {
+        throw testing::TestFailedException("o65 library should be relocated to $3000 with a cleared bss");
+    }
+
+    binary_reader::O65Module main =
+        binary_reader::read_from_o65(cpu, mem, program.data(), program.size(), {lib.end()}, lib.exports);
+    if (!main.ok() || main.text != 0x3007 || main.data != 0x3012 || main.exports["main"] != 0x3007 ||
+        mem[0x3008] != 0x00 || mem[0x3009] != 0x30) {
+        throw testing::TestFailedException("o65 program should be placed after the library and linked to it");
+    }
+    cpu.PC = 0x3007;
+    run_loaded(cpu, mem);  // Stops at the library's RTS
+    run_loaded(cpu, mem);
+    if (mem[0x3012] != 0x42 || cpu.A != 0x30 || cpu.X != 0x12) {
+        std::printf("%s>> result $%02X, A=$%02X, X=$%02X%s\n", RED, mem[0x3012], cpu.A, cpu.X, RESET);
+        throw testing::TestFailedException("Linked o65 modules did not run");
+    }
+
+    // Nothing is stored when a load fails
+    mem[0x5000] = 0xEE;
+    std::vector<byte> truncated(program.begin(), program.end() - 4);
+    std::vector<byte> bad_entry = program;
+    bad_entry[bad_entry.size() - 14] = 0x0A;  // Step from the LDX operand past the end of the text
+    if (binary_reader::read_from_o65(cpu, mem, program.data(), program.size(), {0x5000}).error !=
+            binary_reader::LoadError::Unresolved ||
+        binary_reader::read_from_o65(cpu, mem, truncated.data(), truncated.size(), {0x5000}, lib.exports).error !=
+            binary_reader::LoadError::Syntax ||
+        binary_reader::read_from_o65(cpu, mem, bad_entry.data(), bad_entry.size(), {0x5000}, lib.exports).error !=
+            binary_reader::LoadError::Syntax ||
+        binary_reader::read_from_o65(cpu, mem, program.data(), program.size(), {0xFFF8}, lib.exports).error !=
+            binary_reader::LoadError::Range ||
+        mem[0x5000] != 0xEE) {
+        throw testing::TestFailedException("Bad o65 objects should be rejected without touching memory");
+    }
+}
+
+void inline_program_image_test(Cpu& cpu, Mem& mem) {
+    static constexpr byte CODE[] = {op(Op::LDA_IM), 0x42, op(Op::STA_ABS), 0x00, 0x40, op(Op::RTS)};
+    static constexpr byte TABLE[] = {0x01, 0x02, 0x03, 0x04};  // Crosses into page $31
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x3000, CODE}, {0x30FE, TABLE}};
+    static constexpr ProgramImage IMAGE(SEGMENTS);
+    static_assert(IMAGE.size() == 2 && IMAGE.byte_count() == 10, "Images are built at compile time");
+
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, IMAGE);
+    if (mem[0x3000] != op(Op::LDA_IM) || mem[0x30FF] != 0x02 || mem[0x3101] != 0x04) {
+        throw testing::TestFailedException("Every segment should be stored at its address");
+    }
+    cpu.PC = 0x3000;
+    run_loaded(cpu, mem);
+    if (mem[0x4000] != 0x42) {
+        throw testing::TestFailedException("Program from the image did not run");
+    }
+
+    // Demo programs are views of static tables, not rebuilt per call
+    ProgramImage first = demo_programs::get_counter_program();
+    ProgramImage second = demo_programs::get_counter_program();
+    if (first.begin() != second.begin() || first.begin()->bytes.data() != second.begin()->bytes.data()) {
+        throw testing::TestFailedException("Demo program should be the same static image on every call");
+    }
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, first);
+    if (mem[0x8000] != op(Op::LDX_IM) || mem[0xFFFC] != op(Op::JMP) || mem[0xFFFD] != 0x00 || mem[0xFFFE] != 0x80) {
+        throw testing::TestFailedException("Counter program image did not load");
+    }
+}
+
+void inline_bundle_test(Cpu& cpu, Mem& mem) {
+    // Training run on the block engine collects the blocks of the counter loop
+    const ProgramImage program = demo_programs::get_counter_program();
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, program);
+    cpu.PC = 0xFFFC;
+    cpu.engine = Engine::Block;
+    StopReason reason;
+    cpu.run(1000, mem, reason);
+    const byte trained = mem[0x0200];
+    const size_t trained_blocks = mem.blocks().size();
+
+    const char* path = "loader_test.bundle";
+    const binary_reader::Symbols symbols = {{"start", 0x8000}, {"loop", 0x8005}};
+    if (!bundle::write(path, program, 0xFFFC, symbols, &mem.blocks())) {
+        cpu.engine = DEFAULT_ENGINE;
+        throw testing::TestFailedException("Could not write the bundle");
+    }
+
+    Bundle warm(path);
+    std::remove(path);
+    u32 loop = 0;
+    if (!warm.ok() || !warm.verify() || warm.entry() != 0xFFFC || warm.segments().size() != program.size() ||
+        !warm.find_symbol("loop", loop) || loop != 0x8005 || warm.find_symbol("missing", loop)) {
+        cpu.engine = DEFAULT_ENGINE;
+        throw testing::TestFailedException("Bundle should map back with its entry point and symbols");
+    }
+    if (warm.block_count() != trained_blocks) {
+        cpu.engine = DEFAULT_ENGINE;
+        throw testing::TestFailedException("Bundle should carry the trained blocks");
+    }
+
+    // A fresh start decodes every recorded block before the first instruction runs
+    cpu.reset(mem);
+    warm.load(cpu, mem);
+    warm.warm(mem);
+    size_t warmed = mem.blocks().size();
+    cpu.run(1000, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+
+    std::printf("%s>> %zu blocks warmed, %zu after the run, $0200 = 0x%02X%s\n", CYAN, warmed, mem.blocks().size(),
+                mem[0x0200], RESET);
+
+    if (warmed != trained_blocks || mem.blocks().size() != trained_blocks || mem[0x0200] != trained) {
+        throw testing::TestFailedException("Warm start should decode nothing new and run the same program");
+    }
+
+    // Damage shows up in the hash; broken structure is refused outright
+    std::vector<byte> bytes = bundle::build(program, 0xFFFC, symbols);
+    Bundle cold(RomImage::from_bytes(bytes.data(), bytes.size()));
+    if (!cold.ok() || !cold.verify() || cold.block_count() != 0 || cold.hash() == warm.hash()) {
+        throw testing::TestFailedException("Bundle without a cache should have no predecode metadata");
+    }
+    // The entry point passes the bounds checks either way; only the hash notices it changed
+    bytes[offsetof(bundle::Header, entry)] ^= 0x04;
+    Bundle redirected(RomImage::from_bytes(bytes.data(), bytes.size()));
+    bytes[offsetof(bundle::Header, entry)] ^= 0x04;
+    bytes[sizeof(bundle::Header)] ^= 0xFF;
+    Bundle damaged(RomImage::from_bytes(bytes.data(), bytes.size()));
+    Bundle truncated(RomImage::from_bytes(bytes.data(), bytes.size() - 8));
+    bytes[0] = 'X';
+    Bundle foreign(RomImage::from_bytes(bytes.data(), bytes.size()));
+    if (!redirected.ok() || redirected.verify() || !damaged.ok() || damaged.verify() || truncated.ok() ||
+        foreign.ok() || Bundle("does_not_exist.bundle").ok()) {
+        throw testing::TestFailedException("Damaged, truncated and foreign bundles should be caught");
+    }
+}
+
+void inline_bundle_records_test(Cpu& cpu, Mem& mem) {
+    // LDX #0 ; INX ; JSR leaf, with leaf: STX $0200 ; RTS. The RTS ends the run.
+    static constexpr byte MAIN[] = {
+        op(Op::LDX_IM), 0x00,     // LDX #$00
+        op(Op::INX),              // INX
+        op(Op::JSR), 0x00, 0x31,  // JSR $3100
+    };
+    static constexpr byte LEAF[] = {
+        op(Op::STX_ABS), 0x00, 0x02,  // STX $0200
+        op(Op::RTS),                  // RTS
+    };
+    static constexpr ProgramImage::Segment SEGMENTS[] = {{0x3000, MAIN}, {0x3100, LEAF}};
+    const ProgramImage program(SEGMENTS);
+
+    // Layout of a block: ops, superinstructions, inlined leaf and cycles
+    auto layout = [](const Block& block) {
+        return std::vector<u32>{block.start,
+                                static_cast<u32>(block.ops.size()),
+                                static_cast<u32>(block.fused.size()),
+                                static_cast<u32>(block.leaf.size()),
+                                block.cycles,
+                                block.fused_cycles,
+                                block.penalties,
+                                block.fused_penalties,
+                                block.ops.back().operand};
+    };
+    auto layouts = [&](const BlockCache& cache) {
+        std::vector<std::vector<u32>> all;
+        cache.for_each([&](const Block& block) { all.push_back(layout(block)); });
+        std::sort(all.begin(), all.end());
+        return all;
+    };
+
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, program);
+    cpu.PC = 0x3000;
+    cpu.engine = Engine::Block;
+    StopReason reason;
+    cpu.run(1000, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    const std::vector<std::vector<u32>> trained = layouts(mem.blocks());
+    std::vector<byte> bytes = bundle::build(program, 0x3000, {}, &mem.blocks());
+    Bundle bundle(RomImage::from_bytes(bytes.data(), bytes.size()));
+
+    // Warmed into empty memory: the blocks can only come from the records
+    cpu.reset(mem);
+    bundle.warm(mem);
+    if (!bundle.ok() || layouts(mem.blocks()) != trained || mem.peek(0x3002) != 0x00) {
+        throw testing::TestFailedException("Warm should rebuild the trained blocks from their records alone");
+    }
+    const Block* start = mem.blocks().lookup(0x3000);
+    if (start->leaf.size() != 3 || start->leaf[1].opcode != op(Op::STX_ABS) || start->fused.back().length != 3) {
+        throw testing::TestFailedException("Restored block should inline its leaf subroutine again");
+    }
+
+    // A record that claims more ops than the table holds is refused
+    auto* record = reinterpret_cast<bundle::BlockRecord*>(
+        bytes.data() + reinterpret_cast<const bundle::Header*>(bytes.data())->blocks);
+    record->op_count = 0xFFFF;
+    if (Bundle(RomImage::from_bytes(bytes.data(), bytes.size())).ok()) {
+        throw testing::TestFailedException("Block records past the op table should be refused");
+    }
+}
+
+int loader_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Program Loaders");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Binary File Into Memory", [&]() { inline_binary_file_test(cpu, mem); });
+    test_suite.register_test("Binary File Into Banks", [&]() { inline_banked_file_test(cpu, mem); });
+    test_suite.register_test("Binary File Into A Selected Bank", [&]() { inline_banked_file_selected_test(cpu, mem); });
+    test_suite.register_test("Intel HEX Records", [&]() { inline_intel_hex_test(cpu, mem); });
+    test_suite.register_test("Motorola S-Records", [&]() { inline_srec_test(cpu, mem); });
+    test_suite.register_test("Commodore PRG", [&]() { inline_prg_test(cpu, mem); });
+    test_suite.register_test("Relocatable o65 Modules", [&]() { inline_o65_test(cpu, mem); });
+    test_suite.register_test("Static Program Image", [&]() { inline_program_image_test(cpu, mem); });
+    test_suite.register_test("Prebuilt Bundle Warm Start", [&]() { inline_bundle_test(cpu, mem); });
+    test_suite.register_test("Bundle Records Rebuild Blocks", [&]() { inline_bundle_records_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
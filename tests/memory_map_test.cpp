@@ -0,0 +1,379 @@
+#include <vector>
+
+#include "access_counters.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// I/O page that counts its accesses and remembers the last write
+class TestIo : public IoHandler {
+   public:
+    byte read(word addr) override {
+        reads++;
+        return static_cast<byte>(addr);
+    }
+    void write(word addr, byte value) override {
+        writes++;
+        last_addr = addr;
+        last_value = value;
+    }
+
+    u32 reads = 0;
+    u32 writes = 0;
+    word last_addr = 0;
+    byte last_value = 0;
+};
+
+// Loads `code` at $2000 and runs it to its RTS
+static void run_at_2000(Cpu& cpu, Mem& mem, Engine engine, std::initializer_list<byte> code) {
+    cpu.reset(mem);
+    word addr = 0x2000;
+    for (byte b : code) {
+        mem[addr++] = b;
+    }
+    cpu.PC = 0x2000;
+    cpu.engine = engine;
+    StopReason reason;
+    cpu.run(1000, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+}
+
+void inline_memory_map_rom_test(Cpu& cpu, Mem& mem) {
+    static const byte rom[Mem::PAGE_SIZE] = {0x42, 0x43};
+
+    for (Engine engine : ENGINES) {
+        mem.map_rom(0x90, 1, rom);
+        run_at_2000(cpu, mem, engine,
+                    {
+                        op(Op::LDA_AB), 0x00, 0x90,   // LDA $9000
+                        op(Op::STA_ABS), 0x01, 0x90,  // STA $9001
+                        op(Op::LDX_AB), 0x01, 0x90,   // LDX $9001
+                        op(Op::RTS),                  // RTS
+                    });
+        mem.unmap_all();
+
+        if (cpu.A != 0x42 || cpu.X != 0x43 || rom[1] != 0x43) {
+            throw testing::TestFailedException("ROM should be readable and ignore writes");
+        }
+    }
+
+    std::printf("%s>> LDA $9000 = 0x%02X, STA $9001 dropped%s\n", CYAN, cpu.A, RESET);
+}
+
+void inline_memory_map_io_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        TestIo io;
+        mem.map_io(0xD0, 1, io);
+        run_at_2000(cpu, mem, engine,
+                    {
+                        op(Op::LDA_IM), 0x99,         // LDA #$99
+                        op(Op::STA_ABS), 0x10, 0xD0,  // STA $D010
+                        op(Op::LDY_AB), 0x20, 0xD0,   // LDY $D020
+                        op(Op::RTS),                  // RTS
+                    });
+        mem.unmap_all();
+
+        if (io.writes != 1 || io.last_addr != 0xD010 || io.last_value != 0x99) {
+            throw testing::TestFailedException("Store to an I/O page should reach its handler");
+        }
+        if (io.reads != 1 || cpu.Y != 0x20) {
+            throw testing::TestFailedException("Load from an I/O page should come from its handler");
+        }
+        if (mem[0xD010] != 0x00) {
+            throw testing::TestFailedException("I/O store should not touch the RAM under the page");
+        }
+    }
+
+    std::printf("%s>> STA $D010 and LDY $D020 went to the I/O handler on every engine%s\n", CYAN, RESET);
+}
+
+void inline_memory_map_ram_test(Cpu& cpu, Mem& mem) {
+    // Two pages of host RAM at $4000-$41FF
+    std::vector<byte> ram(2 * Mem::PAGE_SIZE);
+    ram[0x1FF] = 0x5C;
+
+    for (Engine engine : ENGINES) {
+        mem.map_ram(0x40, 2, ram.data());
+        run_at_2000(cpu, mem, engine,
+                    {
+                        op(Op::LDA_AB), 0xFF, 0x41,   // LDA $41FF
+                        op(Op::STA_ABS), 0x00, 0x40,  // STA $4000
+                        op(Op::RTS),                  // RTS
+                    });
+        bool flat = mem.flat();
+        mem.unmap_all();
+
+        if (ram[0] != 0x5C || mem[0x4000] != 0x00 || flat || !mem.flat()) {
+            throw testing::TestFailedException("Remapped RAM should be read and written in host memory");
+        }
+        ram[0] = 0;
+    }
+}
+
+void inline_memory_map_code_page_test(Cpu& cpu, Mem& mem) {
+    // Self-modifying code still works when its page is mapped to host RAM
+    std::vector<byte> ram(Mem::PAGE_SIZE);
+    const byte code[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x05, 0x30,  // STX $3005 (patches the operand of the LDY below)
+        op(Op::LDY_IM), 0x00,         // LDY #$00
+        op(Op::RTS),                  // RTS
+    };
+    for (size_t i = 0; i < sizeof(code); ++i) {
+        ram[i] = code[i];
+    }
+
+    for (Engine engine : {Engine::Block, Engine::Jit}) {
+        cpu.reset(mem);
+        mem.map_ram(0x30, 1, ram.data());
+        cpu.engine = engine;
+        for (int run = 0; run < 20; ++run) {
+            cpu.PC = 0x3000;
+            StopReason reason;
+            cpu.run(100, mem, reason);
+        }
+        cpu.engine = DEFAULT_ENGINE;
+        mem.unmap_all();
+
+        if (cpu.X != 20 || cpu.Y != 20) {
+            throw testing::TestFailedException("Patched operand in mapped RAM was not picked up");
+        }
+        ram[5] = 0x00;
+    }
+}
+
+void inline_dirty_page_test(Cpu& cpu, Mem& mem) {
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        const byte code[] = {
+            op(Op::LDX_IM), 0x07,         // LDX #$07
+            op(Op::STA_ABS), 0x10, 0x30,  // STA $3010
+            op(Op::STX_ABS), 0x11, 0x30,  // STX $3011
+            op(Op::STY_ZP), 0x80,         // STY $80
+            op(Op::PHA),                  // PHA
+            op(Op::JSR), 0x00, 0x21,      // JSR $2100
+        };
+        for (size_t i = 0; i < sizeof(code); ++i) {
+            mem[0x2000 + i] = code[i];
+        }
+        mem[0x2100] = op(Op::RTS);
+
+        u32 generation = mem.write_generation(0x30);
+        mem.track_writes(true);
+        cpu.PC = 0x2000;
+        cpu.engine = engine;
+        StopReason reason;
+        cpu.run(1000, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (mem.dirty_count() != 3 || !mem.dirty(0x00) || !mem.dirty(0x01) || !mem.dirty(0x30)) {
+            throw testing::TestFailedException("Stores should mark exactly their pages dirty");
+        }
+        if (mem.write_generation(0x30) != generation + 1 || mem.dirty(0x20)) {
+            throw testing::TestFailedException("A page should gain one generation per clean-to-dirty transition");
+        }
+
+        mem.clear_dirty();
+        mem.write_word(0x1234, 0x30FF);
+        mem[0x5000] = 0x01;
+        if (mem.dirty_count() != 3 || !mem.dirty(0x30) || !mem.dirty(0x31) || !mem.dirty(0x50) ||
+            mem.write_generation(0x30) != generation + 2) {
+            throw testing::TestFailedException("write_word and operator[] should mark their pages dirty");
+        }
+        mem.track_writes(false);
+    }
+
+    if (!mem.flat()) {
+        throw testing::TestFailedException("Memory should be flat again once tracking is off");
+    }
+
+    // Native code leaves the first store to a clean page to the interpreter
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+    cpu.PC = 0x8000;
+    cpu.engine = Engine::Jit;
+    mem.track_writes(true);
+    StopReason reason;
+    cpu.run(10'000, mem, reason);
+    mem.clear_dirty();
+    cpu.run(10'000, mem, reason);
+    cpu.engine = DEFAULT_ENGINE;
+    bool counter_dirty = mem.dirty(0x02);
+    mem.track_writes(false);
+
+    if (!counter_dirty) {
+        throw testing::TestFailedException("Stores from native code should be tracked");
+    }
+}
+
+void inline_dirty_code_page_test(Cpu& cpu, Mem& mem) {
+    // Stores to a page holding cached code both invalidate it and mark it dirty
+    const byte code[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x05, 0x30,  // STX $3005 (patches the operand of the LDY below)
+        op(Op::LDY_IM), 0x00,         // LDY #$00
+        op(Op::RTS),                  // RTS
+    };
+
+    cpu.reset(mem);
+    for (size_t i = 0; i < sizeof(code); ++i) {
+        mem[0x3000 + i] = code[i];
+    }
+    u32 first_generation = mem.write_generation(0x30);
+    mem.track_writes(true);
+    cpu.engine = Engine::Block;
+    u32 generation = 0;
+    for (int run = 0; run < 5; ++run) {
+        cpu.PC = 0x3000;
+        StopReason reason;
+        cpu.run(100, mem, reason);
+        generation += mem.dirty(0x30);
+        mem.clear_dirty();
+    }
+    cpu.engine = DEFAULT_ENGINE;
+    mem.track_writes(false);
+
+    if (cpu.Y != 5 || generation != 5 || mem.write_generation(0x30) != first_generation + 5) {
+        throw testing::TestFailedException("Stores to a code page should be tracked after every clear");
+    }
+}
+
+void inline_incremental_reset_test(Cpu& cpu, Mem& mem) {
+    // Every engine's stores, including native ones, must be cleared by the next reset
+    for (Mem::ResetMode mode : {Mem::ResetMode::Incremental, Mem::ResetMode::Full}) {
+        mem.set_reset_mode(mode);
+        for (Engine engine : ENGINES) {
+            cpu.reset(mem);
+            binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+            mem[0x9000] = 0x01;
+            cpu.PC = 0x8000;
+            cpu.engine = engine;
+            StopReason reason;
+            cpu.run(10'000, mem, reason);
+            cpu.engine = DEFAULT_ENGINE;
+
+            if (mem[0x0200] == 0x00) {
+                throw testing::TestFailedException("Counter program did not store to $0200");
+            }
+            cpu.reset(mem);
+            for (u32 addr = 0; addr < Mem::MAX_MEM; ++addr) {
+                if (mem.data[addr] != 0x00) {
+                    std::printf("%s>> $%04X = 0x%02X after reset%s\n", RED, addr, mem.data[addr], RESET);
+                    throw testing::TestFailedException("Reset left memory behind");
+                }
+            }
+        }
+    }
+    mem.set_reset_mode(Mem::ResetMode::Incremental);
+}
+
+void inline_access_counters_test(Cpu& cpu, Mem& mem) {
+    using access_counters::Kind;
+
+    // The policy types work in any build; Mem only counts with ACCESS_COUNTERS set
+    access_counters::PageCounters pages;
+    access_counters::AddressCounters addresses;
+    for (u32 addr : {0x3010u, 0x3011u, 0x30FFu}) {
+        pages.read(addr);
+        addresses.read(addr);
+    }
+    if (pages.at(Kind::Read, 0x3000) != 3 || pages.page(Kind::Read, 0x30) != 3 ||
+        addresses.at(Kind::Read, 0x3011) != 1 || addresses.page(Kind::Read, 0x30) != 3 ||
+        addresses.at(Kind::Write, 0x3011) != 0) {
+        throw testing::TestFailedException("Counters should count per slot and sum per page");
+    }
+
+    mem.access_counts.clear();
+    run_at_2000(cpu, mem, Engine::Table,
+                {
+                    op(Op::LDA_AB), 0x10, 0x30,   // LDA $3010
+                    op(Op::STA_ABS), 0x11, 0x30,  // STA $3011
+                    op(Op::RTS),                  // RTS
+                });
+
+    const access_counters::Policy& counts = mem.access_counts;
+    u64 expected = access_counters::Policy::enabled ? 1 : 0;
+    if (counts.page(Kind::Read, 0x30) != expected || counts.page(Kind::Write, 0x30) != expected ||
+        counts.page(Kind::Fetch, 0x20) != 7 * expected || counts.page(Kind::Read, 0x01) != 2 * expected) {
+        throw testing::TestFailedException("Mem should count reads, writes and fetches through its policy");
+    }
+}
+
+void inline_access_counters_engines_test(Cpu& cpu, Mem& mem) {
+    using access_counters::Kind;
+
+    // INX ; LDA $3000 ; STA $3100,X ; PHA ; PLA ; JMP $2000, decoded once and run many times
+    static constexpr byte LOOP[] = {
+        op(Op::INX),                   // INX
+        op(Op::LDA_AB), 0x00, 0x30,    // LDA $3000
+        op(Op::STA_ABSX), 0x00, 0x31,  // STA $3100,X
+        op(Op::PHA),                   // PHA
+        op(Op::PLA),                   // PLA
+        op(Op::JMP), 0x00, 0x20,       // JMP $2000
+    };
+
+    // Counts of every kind on every page, per engine
+    std::vector<u64> reference;
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        mem.load(0x2000, LOOP, sizeof(LOOP));
+        cpu.PC = 0x2000;
+        cpu.engine = engine;
+        mem.access_counts.clear();
+        StopReason reason;
+        cpu.run(10'000, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        std::vector<u64> counts;
+        for (u32 kind = 0; kind < access_counters::KINDS; ++kind) {
+            for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+                counts.push_back(mem.access_counts.page(static_cast<Kind>(kind), static_cast<byte>(page)));
+            }
+        }
+        if (reference.empty()) {
+            reference = counts;
+        } else if (counts != reference) {
+            std::printf("%s>> Engine %d counted %llu fetches on page $20, the table engine %llu%s\n", RED,
+                        static_cast<int>(engine), static_cast<unsigned long long>(counts[2 * Mem::NUM_PAGES + 0x20]),
+                        static_cast<unsigned long long>(reference[2 * Mem::NUM_PAGES + 0x20]), RESET);
+            throw testing::TestFailedException("Every engine should count the same accesses for the same run");
+        }
+    }
+
+    if (access_counters::Policy::enabled && reference[2 * Mem::NUM_PAGES + 0x20] < 1000) {
+        throw testing::TestFailedException("Fetches should be counted on every pass, not once per decode");
+    }
+}
+
+int memory_map_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Memory Map");
+
+    test_suite.print_header();
+
+    test_suite.register_test("ROM Pages Ignore Writes", [&]() { inline_memory_map_rom_test(cpu, mem); });
+    test_suite.register_test("I/O Pages Reach Their Handler", [&]() { inline_memory_map_io_test(cpu, mem); });
+    test_suite.register_test("RAM Pages Map Host Memory", [&]() { inline_memory_map_ram_test(cpu, mem); });
+    test_suite.register_test("Code In Mapped RAM Is Invalidated",
+                             [&]() { inline_memory_map_code_page_test(cpu, mem); });
+    test_suite.register_test("Stores Mark Pages Dirty", [&]() { inline_dirty_page_test(cpu, mem); });
+    test_suite.register_test("Code Pages Are Tracked Too", [&]() { inline_dirty_code_page_test(cpu, mem); });
+    test_suite.register_test("Incremental Reset Clears Written Pages",
+                             [&]() { inline_incremental_reset_test(cpu, mem); });
+    test_suite.register_test("Access Counters Follow The Policy", [&]() { inline_access_counters_test(cpu, mem); });
+    test_suite.register_test("Every Engine Counts The Same Accesses",
+                             [&]() { inline_access_counters_engines_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <memory>
+
+#include "cpu.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "rom_image.h"
+#include "snapshot.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Program at $E000: loads from the ROM, tries to overwrite it, returns
+static const byte ROM_PROGRAM[] = {
+    op(Op::LDA_AB), 0x0E, 0xE0,   // LDA $E00E
+    op(Op::STA_ABS), 0x0E, 0xE0,  // STA $E00E
+    op(Op::INX),                  // INX
+    op(Op::STX_ABS), 0x0F, 0xE0,  // STX $E00F
+    op(Op::LDY_AB), 0x0E, 0xE0,   // LDY $E00E
+    op(Op::RTS),                  // RTS
+    0x42,                         // $E00E: data
+};
+
+void inline_rom_image_shared_test(Cpu& cpu, Mem& mem) {
+    std::shared_ptr<const RomImage> image = RomImage::from_bytes(ROM_PROGRAM, sizeof(ROM_PROGRAM));
+
+    {
+        Snapshot snapshot(cpu, mem);
+        auto children = snapshot.fork(100);
+        for (auto& child : children) {
+            image->map(child->mem, 0xE000);
+            child->cpu.PC = 0xE000;
+            child->run(100);
+        }
+        if (image.use_count() != 101) {
+            throw testing::TestFailedException("Every instance should hold a reference to the one image");
+        }
+        for (auto& child : children) {
+            if (child->cpu.Y != 0x42 || child->mem.peek(0xE00E) != 0x42) {
+                throw testing::TestFailedException("Instances should read the shared image");
+            }
+        }
+    }
+
+    if (image.use_count() != 1 || image->data()[sizeof(ROM_PROGRAM) - 1] != 0x42) {
+        throw testing::TestFailedException("Image should be released by its instances and never written");
+    }
+
+    std::printf("%s>> 100 instances ran one %zu-byte image%s\n", CYAN, image->size(), RESET);
+}
+
+void inline_rom_image_file_test(Cpu& cpu, Mem& mem) {
+    const char* path = "rom_image_test.bin";
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        throw testing::TestFailedException("Could not create the ROM file");
+    }
+    std::fwrite(ROM_PROGRAM, 1, sizeof(ROM_PROGRAM), file);
+    std::fclose(file);
+
+    std::shared_ptr<const RomImage> image = RomImage::from_file(path);
+    std::remove(path);
+    if (image == nullptr || image->size() != sizeof(ROM_PROGRAM) || image->pages() != 1) {
+        throw testing::TestFailedException("ROM file should load as a one-page image");
+    }
+    if (RomImage::from_file("does_not_exist.bin") != nullptr) {
+        throw testing::TestFailedException("Missing file should give no image");
+    }
+
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        image->map(mem, 0xE000);
+        cpu.PC = 0xE000;
+        cpu.engine = engine;
+        StopReason reason;
+        cpu.run(100, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+        mem.unmap_all();
+
+        if (cpu.A != 0x42 || cpu.Y != 0x42 || mem.rom_write_traps != 0) {
+            throw testing::TestFailedException("Program should run from the file image and its stores be dropped");
+        }
+    }
+}
+
+void inline_rom_image_trap_test(Cpu& cpu, Mem& mem) {
+    std::shared_ptr<const RomImage> image = RomImage::from_bytes(ROM_PROGRAM, sizeof(ROM_PROGRAM));
+
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        image->map(mem, 0xE000, Mem::RomWrites::Trap);
+        cpu.PC = 0xE000;
+        cpu.engine = engine;
+        StopReason reason;
+        cpu.run(100, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+        mem.unmap_all();
+
+        if (mem.rom_write_traps != 2 || mem.last_rom_write != 0xE00F || cpu.Y != 0x42) {
+            throw testing::TestFailedException("Both stores into the ROM should be trapped and dropped");
+        }
+    }
+
+    std::printf("%s>> Trapped %u writes, last at $%04X%s\n", CYAN, mem.rom_write_traps, mem.last_rom_write, RESET);
+}
+
+int rom_image_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Shared ROM Images");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Instances Share One Image", [&]() { inline_rom_image_shared_test(cpu, mem); });
+    test_suite.register_test("Image From A File", [&]() { inline_rom_image_file_test(cpu, mem); });
+    test_suite.register_test("Writes Can Be Trapped", [&]() { inline_rom_image_trap_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
@@ -0,0 +1,207 @@
+#include <chrono>
+#include <cstring>
+
+#include "banked_memory.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "snapshot.h"
+#include "test.h"
+#include "test_utils.h"
+
+using namespace colors;
+
+namespace testing {
+
+// Number of pages of `mem` still shared with a snapshot
+static u32 shared_pages(const Mem& mem) {
+    u32 count = 0;
+    for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+        count += mem.page_type(static_cast<byte>(page)) == Mem::PageType::Shared;
+    }
+    return count;
+}
+
+void inline_snapshot_restore_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, demo_programs::get_counter_program());
+    cpu.PC = 0x8000;
+    StopReason reason;
+    cpu.run(1000, mem, reason);
+
+    Snapshot snapshot(cpu, mem);
+    byte x = cpu.X;
+    u64 cycles = cpu.cycle_count;
+
+    cpu.run(1000, mem, reason);
+    mem[0x4000] = 0xAB;
+    snapshot.restore(cpu, mem);
+
+    // peek, since the non-const operator[] would unshare the page
+    if (cpu.X != x || cpu.cycle_count != cycles || cpu.PC != snapshot.pc() || mem.peek(0x0200) != x ||
+        mem.peek(0x4000) != 0x00) {
+        throw testing::TestFailedException("Restore should bring back the registers and memory");
+    }
+    if (shared_pages(mem) != Mem::NUM_PAGES) {
+        throw testing::TestFailedException("Restore should share every page instead of copying it");
+    }
+
+    // Running on from the restored state writes the counter page only
+    cpu.run(1000, mem, reason);
+    if (shared_pages(mem) != Mem::NUM_PAGES - 1 || mem.page_type(0x02) != Mem::PageType::Ram) {
+        throw testing::TestFailedException("Only the written page should be copied");
+    }
+
+    mem.init();
+    if (shared_pages(mem) != 0 || !mem.flat()) {
+        throw testing::TestFailedException("Init should map shared pages back to RAM");
+    }
+}
+
+void inline_snapshot_fork_test(Cpu& cpu, Mem& mem) {
+    // Each child adds its own input byte at $3000 to A and stores the sum at $3100
+    cpu.reset(mem);
+    const byte code[] = {
+        op(Op::LDA_IM), 0x10,         // LDA #$10
+        op(Op::LDX_AB), 0x00, 0x30,   // LDX $3000
+        op(Op::STX_ABS), 0x00, 0x31,  // STX $3100
+        op(Op::RTS),                  // RTS
+    };
+    for (size_t i = 0; i < sizeof(code); ++i) {
+        mem[0x2000 + i] = code[i];
+    }
+    cpu.PC = 0x2000;
+    Snapshot snapshot(cpu, mem);
+
+    constexpr u32 CHILDREN = 256;
+    auto start = std::chrono::steady_clock::now();
+    auto children = snapshot.run_forks(CHILDREN, 100, [](u32 i, Machine& child) {
+        child.mem[0x3000] = static_cast<byte>(i);
+    });
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (u32 i = 0; i < CHILDREN; ++i) {
+        const Machine& child = *children[i];
+        if (child.reason != StopReason::Returned || child.cpu.A != 0x10 || child.mem[0x3100] != i) {
+            throw testing::TestFailedException("Child did not run with its own input");
+        }
+        if (shared_pages(child.mem) != Mem::NUM_PAGES - 2) {
+            throw testing::TestFailedException("Child should only copy the pages it wrote");
+        }
+    }
+    if (mem[0x3000] != 0x00 || mem[0x3100] != 0x00) {
+        throw testing::TestFailedException("Children should not write the parent's memory");
+    }
+
+    std::printf("%s>> Forked and ran %u children in %lld us%s\n", CYAN, CHILDREN,
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()), RESET);
+}
+
+void inline_snapshot_code_page_test(Cpu& cpu, Mem& mem) {
+    // Self-modifying code on a shared page: the first store copies the page
+    // and drops the blocks decoded from it
+    cpu.reset(mem);
+    const byte code[] = {
+        op(Op::INX),                  // INX
+        op(Op::STX_ABS), 0x05, 0x30,  // STX $3005 (patches the operand of the LDY below)
+        op(Op::LDY_IM), 0x00,         // LDY #$00
+        op(Op::RTS),                  // RTS
+    };
+    for (size_t i = 0; i < sizeof(code); ++i) {
+        mem[0x3000 + i] = code[i];
+    }
+    cpu.PC = 0x3000;
+    Snapshot snapshot(cpu, mem);
+
+    for (Engine engine : {Engine::Table, Engine::Block, Engine::Jit}) {
+        auto children = snapshot.fork(1);
+        Machine& child = *children[0];
+        child.cpu.engine = engine;
+        for (int run = 0; run < 3; ++run) {
+            child.cpu.PC = 0x3000;
+            child.run(100);
+        }
+        if (child.cpu.X != 3 || child.cpu.Y != 3) {
+            throw testing::TestFailedException("Patched operand on a shared page was not picked up");
+        }
+    }
+}
+
+void inline_snapshot_bank_window_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    mem[0xA000] = 0x55;  // RAM that the window will cover
+    mem[0x3000] = 0x33;
+    BankedMemory banked(mem, 64 * 1024, BankedMemory::WINDOW_8K);
+    byte window = banked.add_window(0xA000);
+    banked.bank(0)[0] = 0x77;
+    banked.bank(1)[0] = 0x88;
+    Snapshot snapshot(cpu, mem);
+
+    // The window is wiring: restoring keeps it mapped and showing whatever bank is selected now
+    banked.select(window, 1);
+    mem[0x3000] = 0x00;
+    snapshot.restore(cpu, mem);
+    if (mem.peek(0xA000) != 0x88 || mem.page_type(0xA0) != Mem::PageType::Ram || mem.peek(0x3000) != 0x33) {
+        throw testing::TestFailedException("Restore should bring back RAM and leave the bank window mapped");
+    }
+
+    // A fresh machine has no window, so it sees the RAM that was underneath it
+    auto children = snapshot.fork(1);
+    const Mem& child = children[0]->mem;
+    if (child.peek(0xA000) != 0x55 || child.peek(0x3000) != 0x33 || shared_pages(child) != Mem::NUM_PAGES) {
+        throw testing::TestFailedException("Snapshot should hold the RAM under the window, not the bank");
+    }
+}
+
+void inline_cpu_state_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    cpu.PC = 0x1234;
+    cpu.SP = 0xF0;
+    cpu.A = 0x80;
+    cpu.X = 0x01;
+    cpu.Y = 0x02;
+    cpu.FLAGS_C = 1;
+    cpu.set_nz(cpu.A);  // Pending with lazy flags; save() folds it in
+
+    CpuState state = cpu.save();
+    byte raw[sizeof(CpuState)];
+    std::memcpy(raw, &state, sizeof(raw));
+
+    cpu.reset(mem);
+    std::memcpy(&state, raw, sizeof(raw));
+    cpu.load(state);
+
+    if (cpu.PC != 0x1234 || cpu.SP != 0xF0 || cpu.A != 0x80 || cpu.X != 0x01 || cpu.Y != 0x02) {
+        throw testing::TestFailedException("load() should bring back every register");
+    }
+    if (cpu.status() != (Cpu::STATUS_N | 0x01)) {
+        throw testing::TestFailedException("save() should fold pending N/Z into the flags");
+    }
+
+    // The whole Cpu copies like a POD, with its own registers
+    Cpu copy = cpu;
+    copy.A = 0x55;
+    if (cpu.A != 0x80 || copy.X != 0x01) {
+        throw testing::TestFailedException("A copied Cpu should have its own registers");
+    }
+}
+
+int snapshot_test_suite(Cpu& cpu, Mem& mem) {
+    testing::TestSuite test_suite("Snapshots");
+
+    test_suite.print_header();
+
+    test_suite.register_test("Restore Shares Pages", [&]() { inline_snapshot_restore_test(cpu, mem); });
+    test_suite.register_test("Fork And Run Children", [&]() { inline_snapshot_fork_test(cpu, mem); });
+    test_suite.register_test("Code On Shared Pages", [&]() { inline_snapshot_code_page_test(cpu, mem); });
+    test_suite.register_test("Bank Windows Are Wiring", [&]() { inline_snapshot_bank_window_test(cpu, mem); });
+    test_suite.register_test("Register File Saves And Loads", [&]() { inline_cpu_state_test(cpu, mem); });
+
+    test_suite.print_results();
+
+    return test_suite.get_failed_count();
+}
+
+}  // namespace testing
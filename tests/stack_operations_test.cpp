@@ -93,6 +93,37 @@ void inline_php_test(Cpu& cpu, Mem& mem) {
     }
 }
 
+void inline_php_after_load_test(Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    cpu.PC = 0x2000;
+
+    // PHP has to see the N and Z results of the loads right before it
+    mem[0x2000] = op(Op::LDA_IM);  // LDA #$80
+    mem[0x2001] = 0x80;
+    mem[0x2002] = op(Op::PHP);     // PHP
+    mem[0x2003] = op(Op::LDA_IM);  // LDA #$00
+    mem[0x2004] = 0x00;
+    mem[0x2005] = op(Op::PHP);     // PHP
+
+    bool program_completed = false;
+    cpu.execute(12, mem, &program_completed, true);
+
+    byte first = mem[0x01FF];
+    byte second = mem[0x01FE];
+    std::printf("%s>> Pushed status 0x%02X after LDA #$80, 0x%02X after LDA #$00%s\n", CYAN, first, second, RESET);
+
+    // N is bit 7 and Z is bit 1 of the pushed byte
+    if ((first & 0x82) != 0x80) {
+        throw testing::TestFailedException("PHP after LDA #$80 should push N=1, Z=0");
+    }
+    if ((second & 0x82) != 0x02) {
+        throw testing::TestFailedException("PHP after LDA #$00 should push N=0, Z=1");
+    }
+    if (!cpu.FLAGS_Z || cpu.FLAGS_N) {
+        throw testing::TestFailedException("Flags after the run should reflect the last load");
+    }
+}
+
 void inline_pla_test(Cpu& cpu, Mem& mem) {
     cpu.reset(mem);
 
@@ -329,6 +360,52 @@ void inline_txs_test(Cpu& cpu, Mem& mem) {
     }
 }
 
+void inline_stack_wrap_test(Cpu& cpu, Mem& mem) {
+    // SP wraps within page $01 and a zero page pointer at $FF takes its high byte from $00
+    const byte code[] = {
+        op(Op::LDX_IM), 0x00,   // LDX #$00
+        op(Op::TXS),            // TXS
+        op(Op::LDA_IM), 0x77,   // LDA #$77
+        op(Op::PHA),            // PHA (to $0100; SP wraps to $FF)
+        op(Op::LDA_IM), 0x00,   // LDA #$00
+        op(Op::PLA),            // PLA (SP wraps back to $00)
+        op(Op::STA_ZP), 0x30,   // STA $30
+        op(Op::LDY_IM), 0x00,   // LDY #$00
+        op(Op::LDA_INY), 0xFF,  // LDA ($FF),Y
+        op(Op::RTS),            // RTS
+    };
+
+    for (Engine engine : ENGINES) {
+        cpu.reset(mem);
+        for (size_t i = 0; i < sizeof(code); ++i) {
+            mem[0x2000 + i] = code[i];
+        }
+        mem[0x00FF] = 0x34;
+        mem[0x0000] = 0x12;
+        mem[0x1234] = 0x5E;
+        cpu.PC = 0x2000;
+        cpu.engine = engine;
+        StopReason reason;
+        cpu.run(1000, mem, reason);
+        cpu.engine = DEFAULT_ENGINE;
+
+        if (mem[0x0100] != 0x77 || mem[0x0200] != 0x00 || mem[0x30] != 0x77) {
+            throw testing::TestFailedException("Pushes and pulls should wrap within the stack page");
+        }
+        if (cpu.A != 0x5E) {
+            throw testing::TestFailedException("LDA ($FF),Y should read the pointer's high byte from $00");
+        }
+#ifdef EMULATOR_STACK_CHECKS
+        if (cpu.stack_overflows != 1 || cpu.stack_underflows != 1 || cpu.last_stack_fault.overflow ||
+            cpu.last_stack_fault.cycle == 0) {
+            throw testing::TestFailedException("Stack checks should record one overflow and one underflow");
+        }
+#endif
+    }
+
+    std::printf("%s>> PHA at SP $00 stored to $0100, LDA ($FF),Y read $1234%s\n", CYAN, RESET);
+}
+
 // Test suite function for stack operations
 void stack_operations_test_suite(Cpu& cpu, Mem& mem) {
     testing::TestSuite test_suite("Stack Operations");
@@ -338,10 +415,13 @@ void stack_operations_test_suite(Cpu& cpu, Mem& mem) {
     // Register and run individual tests
     test_suite.register_test("Push Accumulator (PHA)", [&]() { inline_pha_test(cpu, mem); });
     test_suite.register_test("Push Processor Status (PHP)", [&]() { inline_php_test(cpu, mem); });
+    test_suite.register_test("PHP After Load Pushes Current N/Z",
+                             [&]() { inline_php_after_load_test(cpu, mem); });
     test_suite.register_test("Pull Accumulator (PLA)", [&]() { inline_pla_test(cpu, mem); });
     test_suite.register_test("Pull Processor Status (PLP)", [&]() { inline_plp_test(cpu, mem); });
     test_suite.register_test("Transfer Stack Pointer to X (TSX)", [&]() { inline_tsx_test(cpu, mem); });
     test_suite.register_test("Transfer X to Stack Pointer (TXS)", [&]() { inline_txs_test(cpu, mem); });
+    test_suite.register_test("Stack And Zero Page Wrap Around", [&]() { inline_stack_wrap_test(cpu, mem); });
 
     // Print the results
     test_suite.print_results();
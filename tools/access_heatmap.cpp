@@ -0,0 +1,209 @@
+// Memory access heatmap.
+//
+// Runs a workload on the table engine and shows where its reads, writes and
+// instruction fetches went, as a 16x16 grid of pages or as CSV. Data hot spots
+// outside the zero page are listed as candidates for moving into it: an access
+// in zero page form is a cycle cheaper than the absolute form.
+//
+// Needs a build configured with -DACCESS_COUNTERS=page or address (and
+// -DENABLE_TOOLS=ON); per-address counters also rank single variables.
+//
+// Usage: emulator_access_heatmap [workload] [--csv] [top_n]
+//        workload is one of: counter (default), demo, lda, ldx, ldy
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "access_counters.h"
+#include "colors.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "reader.h"
+#include "types.h"
+
+using namespace colors;
+
+namespace {
+
+// Cycle budget for one workload; endless loops stop here
+constexpr u64 WORKLOAD_CYCLES = 1'000'000;
+
+// Bytes covered by one counter
+constexpr u32 SLOT_SIZE = 0x10000 / std::max<u32>(access_counters::Policy::SLOTS, 1);
+
+// Heat levels from cold to hot
+constexpr char SHADES[] = " .:-=+*#%@";
+constexpr int LEVELS = sizeof(SHADES) - 1;
+
+struct Workload {
+    const char* name;
+    ProgramImage (*program)();
+    word start;
+};
+
+const Workload WORKLOADS[] = {
+    {"counter", demo_programs::get_counter_program, 0xFFFC},
+    {"demo", demo_programs::get_instruction_demo, 0xFFFC},
+    {"lda", demo_programs::get_lda_demo, 0xFFFC},
+    {"ldx", demo_programs::get_ldx_demo, 0xFFFC},
+    {"ldy", demo_programs::get_ldy_demo, 0xFFFC},
+};
+
+struct Slot {
+    u32 start;
+    u64 reads;
+    u64 writes;
+};
+
+// Runs `workload` until its RTS or the cycle budget, counting from a clean slate
+void run(const Workload& workload, Cpu& cpu, Mem& mem) {
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, workload.program());
+    cpu.PC = workload.start;
+    cpu.engine = Engine::Table;
+
+    mem.access_counts.clear();
+    StopReason reason;
+    cpu.run(WORKLOAD_CYCLES, mem, reason);
+}
+
+// Logarithmic, so that a page with a handful of accesses still shows up next to a hot loop
+char shade(u64 count, u64 max) {
+    if (count == 0) {
+        return SHADES[0];
+    }
+    double level = std::log(static_cast<double>(count)) / std::log(static_cast<double>(max) + 1.0);
+    return SHADES[1 + std::min(LEVELS - 2, static_cast<int>(level * (LEVELS - 1)))];
+}
+
+// One cell per page, rows of 16 pages
+void print_grid(const char* title, const std::function<u64(byte)>& count) {
+    u64 max = 0;
+    for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+        max = std::max(max, count(static_cast<byte>(page)));
+    }
+
+    std::printf("%s%s%s (hottest page: %llu)\n", BOLD, title, RESET, static_cast<unsigned long long>(max));
+    std::printf("         0 1 2 3 4 5 6 7 8 9 A B C D E F\n");
+    for (u32 row = 0; row < 16; ++row) {
+        std::printf("  $%Xxxx  ", row);
+        for (u32 col = 0; col < 16; ++col) {
+            std::printf("%c ", shade(count(static_cast<byte>(row * 16 + col)), max));
+        }
+        std::printf("\n");
+    }
+    std::printf("\n");
+}
+
+void print_csv(const Mem& mem) {
+    std::printf("start,size,reads,writes,fetches\n");
+    for (u32 addr = 0; addr < Mem::MAX_MEM; addr += SLOT_SIZE) {
+        u64 reads = mem.access_counts.at(access_counters::Kind::Read, addr);
+        u64 writes = mem.access_counts.at(access_counters::Kind::Write, addr);
+        u64 fetches = mem.access_counts.at(access_counters::Kind::Fetch, addr);
+        if (reads + writes + fetches != 0) {
+            std::printf("0x%04X,%u,%llu,%llu,%llu\n", addr, SLOT_SIZE, static_cast<unsigned long long>(reads),
+                        static_cast<unsigned long long>(writes), static_cast<unsigned long long>(fetches));
+        }
+    }
+}
+
+void print_text(const Mem& mem, const std::string& name, size_t top_n) {
+    const access_counters::Policy& counts = mem.access_counts;
+    u64 totals[access_counters::KINDS] = {};
+    for (u32 page = 0; page < Mem::NUM_PAGES; ++page) {
+        for (u32 kind = 0; kind < access_counters::KINDS; ++kind) {
+            totals[kind] += counts.page(static_cast<access_counters::Kind>(kind), static_cast<byte>(page));
+        }
+    }
+
+    std::printf("\n%s%s===== Memory Access Heatmap: %s =====%s\n\n", YELLOW, BOLD, name.c_str(), RESET);
+    std::printf("%llu reads, %llu writes, %llu fetches, counted per %s\n", static_cast<unsigned long long>(totals[0]),
+                static_cast<unsigned long long>(totals[1]), static_cast<unsigned long long>(totals[2]),
+                SLOT_SIZE == 1 ? "address" : "page");
+    std::printf("Scale, cold to hot: '%s'\n\n", SHADES);
+
+    print_grid("Data reads and writes", [&](byte page) {
+        return counts.page(access_counters::Kind::Read, page) + counts.page(access_counters::Kind::Write, page);
+    });
+    print_grid("Instruction fetches", [&](byte page) { return counts.page(access_counters::Kind::Fetch, page); });
+
+    // Everything above the stack page could move into the zero page
+    std::vector<Slot> slots;
+    for (u32 addr = 2 * Mem::PAGE_SIZE; addr < Mem::MAX_MEM; addr += SLOT_SIZE) {
+        Slot slot{addr, counts.at(access_counters::Kind::Read, addr), counts.at(access_counters::Kind::Write, addr)};
+        if (slot.reads + slot.writes != 0) {
+            slots.push_back(slot);
+        }
+    }
+    std::sort(slots.begin(), slots.end(),
+              [](const Slot& a, const Slot& b) { return a.reads + a.writes > b.reads + b.writes; });
+
+    std::printf("%sZero page candidates%s (up to one cycle saved per access)\n", BOLD, RESET);
+    if (slots.empty()) {
+        std::printf("  No data accesses outside pages $00 and $01\n");
+    }
+    for (size_t i = 0; i < slots.size() && i < top_n; ++i) {
+        const Slot& slot = slots[i];
+        if (SLOT_SIZE == 1) {
+            std::printf("  %s$%04X%s", CYAN, slot.start, RESET);
+        } else {
+            std::printf("  %s$%04X-$%04X%s", CYAN, slot.start, slot.start + SLOT_SIZE - 1, RESET);
+        }
+        std::printf("  %10llu reads  %10llu writes\n", static_cast<unsigned long long>(slot.reads),
+                    static_cast<unsigned long long>(slot.writes));
+    }
+    std::printf("\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string selected = "counter";
+    bool csv = false;
+    size_t top_n = 10;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--csv") {
+            csv = true;
+        } else if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0]))) {
+            top_n = std::strtoul(arg.c_str(), nullptr, 10);
+        } else {
+            selected = arg;
+        }
+    }
+
+    if (!access_counters::Policy::enabled) {
+        std::fprintf(stderr, "This build counts no memory accesses; configure it with -DACCESS_COUNTERS=page\n");
+        return 1;
+    }
+
+    const Workload* workload = nullptr;
+    for (const Workload& w : WORKLOADS) {
+        if (selected == w.name) {
+            workload = &w;
+        }
+    }
+    if (!workload) {
+        std::fprintf(stderr, "Unknown workload '%s' (counter, demo, lda, ldx, ldy)\n", selected.c_str());
+        return 1;
+    }
+
+    Cpu cpu;
+    static Mem mem;
+    run(*workload, cpu, mem);
+
+    if (csv) {
+        print_csv(mem);
+    } else {
+        print_text(mem, selected, top_n);
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Opcode-pair frequency statistics.
+//
+// Runs a workload on the table engine, counts every pair of consecutively
+// executed opcodes and prints the most frequent ones. The superinstructions
+// in src/block_cache.cpp were picked from this output.
+//
+// Usage: emulator_opcode_pairs [workload] [top_n]
+//        workload is one of: counter (default), demo, lda, ldx, ldy, all
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "block_cache.h"
+#include "colors.h"
+#include "cpu.h"
+#include "demo_programs.h"
+#include "memory.h"
+#include "op_codes.h"
+#include "reader.h"
+#include "types.h"
+
+using namespace colors;
+
+namespace {
+
+// Cycle budget for one workload; endless loops stop here
+constexpr u64 WORKLOAD_CYCLES = 1'000'000;
+
+struct Workload {
+    const char* name;
+    ProgramImage (*program)();
+    word start;
+};
+
+const Workload WORKLOADS[] = {
+    {"counter", demo_programs::get_counter_program, 0xFFFC},
+    {"demo", demo_programs::get_instruction_demo, 0xFFFC},
+    {"lda", demo_programs::get_lda_demo, 0xFFFC},
+    {"ldx", demo_programs::get_ldx_demo, 0xFFFC},
+    {"ldy", demo_programs::get_ldy_demo, 0xFFFC},
+};
+
+struct PairCount {
+    byte first;
+    byte second;
+    u64 count;
+};
+
+// Adds the opcode pairs executed by `workload` to `counts`
+u64 count_pairs(const Workload& workload, std::vector<u64>& counts) {
+    Cpu cpu;
+    static Mem mem;
+
+    cpu.reset(mem);
+    binary_reader::read_from_array(cpu, mem, workload.program());
+    cpu.PC = workload.start;
+
+    u64 executed = 0;
+    int previous = -1;
+    while (cpu.cycle_count < WORKLOAD_CYCLES) {
+        byte opcode = mem[cpu.PC];
+        if (previous >= 0) {
+            counts[(previous << 8) | opcode]++;
+        }
+        previous = opcode;
+        executed++;
+
+        // RTS ends the program, as in Cpu::run
+        if (cpu.step(mem)) {
+            break;
+        }
+    }
+    return executed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string selected = argc > 1 ? argv[1] : "counter";
+    size_t top_n = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+
+    std::vector<u64> counts(256 * 256, 0);
+    u64 executed = 0;
+    bool found = false;
+    for (const Workload& workload : WORKLOADS) {
+        if (selected == "all" || selected == workload.name) {
+            executed += count_pairs(workload, counts);
+            found = true;
+        }
+    }
+    if (!found) {
+        std::fprintf(stderr, "Unknown workload '%s' (counter, demo, lda, ldx, ldy, all)\n", selected.c_str());
+        return 1;
+    }
+
+    std::vector<PairCount> pairs;
+    u64 total = 0;
+    for (u32 i = 0; i < counts.size(); ++i) {
+        if (counts[i] != 0) {
+            pairs.push_back({static_cast<byte>(i >> 8), static_cast<byte>(i & 0xFF), counts[i]});
+            total += counts[i];
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const PairCount& a, const PairCount& b) { return a.count > b.count; });
+
+    std::printf("\n%s%s===== Opcode Pairs: %s =====%s\n\n", YELLOW, BOLD, selected.c_str(), RESET);
+    std::printf("%llu instructions, %llu pairs, %zu distinct\n\n", static_cast<unsigned long long>(executed),
+                static_cast<unsigned long long>(total), pairs.size());
+
+    for (size_t i = 0; i < pairs.size() && i < top_n; ++i) {
+        const PairCount& p = pairs[i];
+        double share = total > 0 ? 100.0 * static_cast<double>(p.count) / static_cast<double>(total) : 0.0;
+        bool fused = BlockCache::fuses(p.first, p.second);
+        std::printf("%s%-10s -> %-10s%s %12llu  %6.2f%%  %s%s%s\n", CYAN, opcodes::from_byte(p.first).c_str(),
+                    opcodes::from_byte(p.second).c_str(), RESET, static_cast<unsigned long long>(p.count), share,
+                    GREEN, fused ? "fused" : "", RESET);
+    }
+
+    return 0;
+}